@@ -0,0 +1,97 @@
+"""
+Reading the CNF archives written by regExEncoding -a, and the per-cell inference workload run on
+each formula, shared by phaseTransition.py and layoutBenchmark.py.
+"""
+
+from pysat.formula import CNF # You need to download this (see readMe)
+from pysat.solvers import Glucose42 # You need to download this (see readMe)
+from time import time
+import mmap
+import struct
+
+def openArchive(path):
+    """
+    Map a CNF archive into memory and read its index (see encoding/archive.h for the layout).
+    Returns the mapping and a dictionary from (density, board) to the formula's (offset, length).
+    """
+    with open(path,'rb') as f:
+        m = mmap.mmap(f.fileno(), 0, access = mmap.ACCESS_READ)
+    indexOffset, count, magic = struct.unpack_from('<QQ4s', m, len(m) - 20)
+    if m[:4] != b'NGAR' or magic != b'NGAX':
+        raise ValueError(f'{path} is not a CNF archive')
+    index = {}
+    for density, board, offset, length in struct.iter_unpack('<iiQQ', m[indexOffset:indexOffset + 24*count]):
+        index[(density, board)] = (offset, length)
+    return m, index
+
+def decodeBinary(data):
+    """
+    The clauses of a binary CNF formula (written by regExEncoding -b, see encoding/bincnf.h for the
+    format): after the magic and version come the variable and clause counts, then each clause as
+    its length and its literals, all as varints. Each literal is the zigzag coded difference from
+    the variable before it, shifted left once with the low bit set if it is negative.
+    """
+    if data[:4] != b'NGBC' or struct.unpack_from('<I', data, 4)[0] != 1:
+        raise ValueError('not a binary CNF formula')
+    position = 8
+    def varint():
+        nonlocal position
+        value = shift = 0
+        while True:
+            byte = data[position]
+            position += 1
+            value |= (byte & 0x7f) << shift
+            if byte < 0x80:
+                return value
+            shift += 7
+    varint() # The variable count, which CNF works out for itself
+    clauses = []
+    previous = 0
+    for _ in range(varint()):
+        clause = []
+        for _ in range(varint()):
+            code = varint()
+            zigzag = code >> 1
+            previous += (zigzag >> 1) ^ -(zigzag & 1)
+            clause.append(-previous if code & 1 else previous)
+        clauses.append(clause)
+    return clauses
+
+def parseFormula(data):
+    """
+    The formula held in data, as DIMACS text or in the binary format.
+    """
+    if data[:4] == b'NGBC':
+        return CNF(from_clauses=decodeBinary(data))
+    return CNF(from_string=bytes(data).decode())
+
+def readFormula(archive, key):
+    """
+    The formula for key, a (density, board) pair, of an archive opened with openArchive (either
+    format, as regExEncoding -a writes with or without -b).
+    """
+    m, index = archive
+    offset, length = index[key]
+    return parseFormula(m[offset:offset + length])
+
+def readFile(path):
+    """
+    The formula in the file at path, a .cnf or a .cnfb file.
+    """
+    with open(path,'rb') as f:
+        return parseFormula(f.read())
+
+def inference(formula, n):
+    """
+    The inference workload of phaseTransition.py on the formula of an n by n board: for each cell,
+    determine whether an inference is possible by assuming the cell is empty and testing the board
+    for consistency under that assumption. Only the solves are timed.
+    Returns the seconds taken, the number of cells inferred, and the solver's propagations.
+    """
+    with Glucose42(bootstrap_with = formula) as s:
+        t1 = time()
+        inferred = 0
+        for i in range(1,n*n+1):
+            if not s.solve(assumptions = [-i]):
+                inferred += 1
+        return time() - t1, inferred, s.accum_stats()['propagations']
@@ -0,0 +1,158 @@
+#include <stdlib.h>
+
+/*
+The routines of dnfToCNF.c, for kernelBenchmark.c. dnfToCNF.c is a program rather than a library,
+so it is compiled here whole, with its main and the two functions that share a name with
+nonogram.c's renamed.
+*/
+#define main dnfToCNF_main
+#define printDescription dnfPrintDescription
+#define randomFilled dnfRandomFilled
+#include "../encoding/dnfToCNF.c"
+#undef main
+
+#include "dnfKernels.h"
+
+int dnf_size(void){
+    return N ;
+}
+
+// The description of the line of board starting at first, stepping by step, as dnfToCNF.c's node list (its head's val is 0 if it is empty)
+static node * lineDescription(const int * board, int first, int step){
+    node * head = calloc(1,sizeof(node)) ;
+    node * tail = NULL ;
+    int run = 0 ;
+    for (int k = 0 ; k <= N ; k++){
+        if (k < N && board[first + k*step] == 1){
+            run += 1 ;
+        } else if (run > 0){
+            node * p = tail == NULL ? head : calloc(1,sizeof(node)) ;
+            p->val = run ;
+            if (tail != NULL){
+                tail->next = p ;
+            }
+            tail = p ;
+            head->tail = p ;
+            head->len += 1 ;
+            run = 0 ;
+        }
+    }
+    return head ;
+}
+
+static void freeDescription(node * d){
+    while (d != NULL){
+        node * next = d->next ;
+        free(d) ;
+        d = next ;
+    }
+}
+
+void dnf_build(const int * board, kernelTotals * totals){
+    DNFtreeNode * root = newDNFtree() ; // Not freed (dnfToCNF.c has nothing to free its trees with)
+    for (int line = 0 ; line < 2*N ; line++){
+        node * d = line < N ? lineDescription(board,line*N,1) : lineDescription(board,line - N,N) ;
+        if (d->val != 0 && !inDNFtree(d,N,root)){
+            const long allocations = bench_allocations() ;
+            const uint64_t start = bench_now() ;
+            DNFnode * fillings = build(d,N,root) ;
+            totals->nanoseconds += bench_now() - start ;
+            totals->allocations += bench_allocations() - allocations ;
+            totals->ops += 1 ;
+            for (DNFnode * t = fillings ; t != NULL ; t = t->next){
+                totals->bytes += N*sizeof(int) ;
+            }
+            insert(d,N,fillings,root) ;
+        }
+        freeDescription(d) ; // The tree keeps the fillings, not the description
+    }
+    return ;
+}
+
+/*
+The row then column descriptions of board, and the CNF tree holding the formula of each, built the
+way dnfToCNF.c's main builds them for the first board of its sweep (its DNF tree, scaled, then
+DNFtoCNF for each description). Like dnf_build, the trees are not freed.
+*/
+static CNFtreeNode * lineFormulae(const int * board, node * descriptions[2*N]){
+    DNFtreeNode * DNFDP = newDNFtree() ;
+    CNFtreeNode * CNFDP = malloc(sizeof(CNFtreeNode)) ;
+    CNFDP->cnf = emptyLineCNF() ;
+    CNFDP->children = malloc(N*sizeof(CNFtreeNode *)) ;
+    for (int i = 0 ; i < N ; i++){CNFDP->children[i] = NULL ;}
+    for (int line = 0 ; line < 2*N ; line++){
+        descriptions[line] = line < N ? lineDescription(board,line*N,1) : lineDescription(board,line - N,N) ;
+        node * d = descriptions[line] ;
+        if (d->val != 0 && !inDNFtree(d,N,DNFDP)){
+            insert(d,N,build(d,N,DNFDP),DNFDP) ;
+        }
+    }
+    scaleFullLength(DNFDP) ;
+    for (int line = 0 ; line < 2*N ; line++){
+        node * d = descriptions[line] ;
+        if (d->val != 0 && !inCNFtree(d,CNFDP)){
+            insertCNF(d,DNFtoCNF(retrieve(d,N,DNFDP)),CNFDP) ;
+        }
+    }
+    return CNFDP ;
+}
+
+// The line formulae of the board in dnfToCNF.c's order (rows then columns) copied into one N*N formula
+static CNFnode * boardFormula(node * descriptions[2*N], CNFtreeNode * root, kernelTotals * totals){
+    CNFnode * formula = NULL ;
+    for (int line = 0 ; line < 2*N ; line++){
+        const long allocations = bench_allocations() ;
+        const uint64_t start = bench_now() ;
+        CNFnode * portion = line < N ? copyCNFscaled(descriptions[line],root,line,'r')
+                                     : copyCNFscaled(descriptions[line],root,line - N,'c') ;
+        if (totals != NULL){
+            totals->nanoseconds += bench_now() - start ;
+            totals->allocations += bench_allocations() - allocations ;
+            totals->ops += 1 ;
+            for (CNFnode * c = portion ; c != NULL ; c = c->next){
+                totals->bytes += N*N*sizeof(int) ;
+            }
+        }
+        formula = mergeCNF(formula,portion) ;
+    }
+    return formula ;
+}
+
+static void freeFormula(CNFnode * formula){
+    while (formula != NULL){
+        CNFnode * next = formula->next ;
+        free(formula->clause) ;
+        free(formula) ;
+        formula = next ;
+    }
+}
+
+void dnf_copy(const int * board, kernelTotals * totals){
+    node * descriptions[2*N] ;
+    CNFtreeNode * root = lineFormulae(board,descriptions) ;
+    freeFormula(boardFormula(descriptions,root,totals)) ;
+    for (int line = 0 ; line < 2*N ; line++){
+        freeDescription(descriptions[line]) ;
+    }
+    return ;
+}
+
+void dnf_subsumption(const int * board, kernelTotals * totals){
+    node * descriptions[2*N] ;
+    CNFtreeNode * root = lineFormulae(board,descriptions) ;
+    CNFnode * formula = boardFormula(descriptions,root,NULL) ;
+    const long allocations = bench_allocations() ;
+    const uint64_t start = bench_now() ;
+    formula = subsumption(formula,N*N) ;
+    totals->nanoseconds += bench_now() - start ;
+    totals->allocations += bench_allocations() - allocations ;
+    totals->ops += 1 ;
+    for (CNFnode * c = formula ; c != NULL ; c = c->next){
+        totals->bytes += N*N*sizeof(int) ;
+    }
+    freeFormula(formula) ;
+    for (int line = 0 ; line < 2*N ; line++){
+        freeDescription(descriptions[line]) ;
+    }
+    return ;
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <stdint.h>
+
+/*
+What kernelBenchmark.c measures of a kernel: the calls made (ops), the nanoseconds they took in
+all, the bytes of output they produced, and the heap allocations they made (or -1 when the
+benchmark is built without counting them).
+*/
+typedef struct kernelTotals {
+    long ops ;
+    uint64_t nanoseconds ;
+    uint64_t bytes ;
+    long allocations ;
+} kernelTotals ;
+
+/*
+bench_now: void -> uint64_t
+bench_now() = the monotonic clock in nanoseconds
+
+bench_allocations: void -> long
+bench_allocations() = the heap allocations made so far, or -1 if they are not counted
+
+Both are defined in kernelBenchmark.c.
+*/
+uint64_t bench_now(void) ;
+long bench_allocations(void) ;
+
+/*
+dnf_size: void -> int
+dnf_size() = N, the board size dnfToCNF.c is compiled for (its routines only work on N*N boards)
+
+dnf_build: int * x kernelTotals * -> void
+dnf_build(B,t) adds to t the calls of dnfToCNF.c's build for the row and column descriptions of
+the N*N int board B, starting from a DNF tree holding only the base cases, as dnfToCNF.c does for
+the first board of its sweep. A description already in the tree (from an earlier line of B) is not
+built again, as in dnfToCNF.c. Each call's bytes are the terms of the fillings it returns.
+
+dnf_copy: int * x kernelTotals * -> void
+dnf_copy(B,t) adds to t the calls of dnfToCNF.c's copyCNFscaled for the 2N lines of the N*N int
+board B, rows then columns, each copying its line's CNF formula into the board's variables as
+dnfToCNF.c's main does. The formulae are built untimed beforehand (with build and DNFtoCNF, from
+trees holding only the base cases). Each call's bytes are the clauses it copies, N*N ints each.
+
+dnf_subsumption: int * x kernelTotals * -> void
+dnf_subsumption(B,t) adds to t one call of dnfToCNF.c's subsumption on the formula of the N*N int
+board B, made untimed as for dnf_copy: the first of the two subsumptions of dnfToCNF.c's main. Its
+bytes are the clauses left.
+*/
+int dnf_size(void) ;
+void dnf_build(const int * board, kernelTotals * totals) ;
+void dnf_copy(const int * board, kernelTotals * totals) ;
+void dnf_subsumption(const int * board, kernelTotals * totals) ;
@@ -0,0 +1,286 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <unistd.h>
+
+// gcc -O2 -I../encoding -o formatCheck formatCheck.c ../encoding/nonogram.c ../encoding/sink.c ../encoding/arena.c ../encoding/linecache.c ../encoding/linesolve.c ../encoding/eliminate.c ../encoding/layout.c ../encoding/cardinality.c ../encoding/stream.c ../encoding/archive.c ../encoding/bincnf.c ../encoding/stats.c ../encoding/trace.c ../encoding/mtwister.c -lm
+
+#include "nonogram.h"
+#include "linecache.h"
+#include "linesolve.h"
+#include "cardinality.h"
+#include "stream.h"
+#include "archive.h"
+#include "bincnf.h"
+
+#define DEFAULT_SIZE 40 // regExEncoding's board size when none is given with -n
+#define SEED 32 // regExEncoding's sweep seed, so the boards are the ones its multithreaded sweep writes
+#define SCRATCH_SIZE (1 << 16) // Initial size of the arena, which grows to fit the largest board
+#define CACHE_LITERALS (1 << 22) // Template literals the line cache holds before it is emptied
+#define MAX_REPORTED 20 // The mismatches printed in full (every one is counted)
+
+/*
+A round trip check of the CNF archives regExEncoding writes with -a (see archive.h) and of the
+binary formulae it writes with -b (see bincnf.h). Each archive given is opened with archive_open,
+and every entry of its index is looked up again by its (density, board) pair with archive_find,
+which has to give back the same bytes the index points at. The formula found is then compared
+with the same board encoded here: the board of regExEncoding's multithreaded sweep at that
+density index and board (the same seeds), streamed with stream_board, which writes the same
+formula as the in-memory encoder whenever the counts fit in an int. A text formula has to be the
+same bytes. A binary one has to be the same bytes as the binary sink writes, and decoded with
+bincnf_read and written back out as DIMACS text, the same bytes as the text of the board, so a
+fault in the varints or the literal differences shows up as a mismatch. The index has to be
+sorted with no pair twice, and a pair the archive does not hold (density 0) must not be found.
+
+The formula files of a sweep written without -a can be given too, named as regExEncoding names
+them ("density board.cnf" or .cnfb, with the density counted from 1). A .cnfb file is read with
+bincnf_load and checked against the text of its board in the same way.
+
+The size and the encoding options must be the ones the sweep was written with: -n, and -p, -e,
+-l, -s, -c and -C, which mean the same as for regExEncoding. A single stream sweep (no -t) or a
+coupled sweep (-u) has other boards, so every one of its formulae mismatches. Per-density archives
+('density%d.ngar') are checked by giving all of them. The program prints the first MAX_REPORTED
+mismatches and exits with 1 if there are any.
+*/
+
+static long mismatches = 0 ;
+
+/*
+mismatch: const char * x int x int x const char * -> void
+mismatch(path,d,b,what) counts a mismatch of what in the formula of (d, b) in the archive or file at path,
+printing it if it is one of the first MAX_REPORTED
+*/
+void mismatch(const char * path, int density, int board, const char * what) ;
+
+/*
+encodeBoard: const uint64_t * x int x bool x int x LineCache * x ClauseSink * x Arena * -> void
+encodeBoard(B,N,s,c,cache,out,a) writes the formula of the bit packed N*N board B into out the
+way regExEncoding -S does, presolved if s and with the cardinality constraints c
+*/
+void encodeBoard(const uint64_t * board, int N, bool presolve, int cardinality, LineCache * cache, ClauseSink * out, Arena * scratch) ;
+
+/*
+checkDecoded: const char * x int x int x BinaryCnf * x ClauseSink * x ClauseSink * -> void
+checkDecoded(path,d,b,cnf,text,decoded) writes the clauses of the decoded binary formula cnf of (d, b)
+as DIMACS text into the in-memory sink decoded, and counts a mismatch if they are not the bytes of
+the text formula of the board in text
+*/
+void checkDecoded(const char * path, int density, int board, const BinaryCnf * cnf, ClauseSink * text, ClauseSink * decoded) ;
+
+/*
+readFile: const char * x size_t * -> char *
+readFile(path,n) = the contents of the file at path (malloc'd), setting *n to their size, or NULL if it
+cannot be read
+*/
+char * readFile(const char * path, size_t * size) ;
+
+int main(int argc, char ** argv){
+    int N = DEFAULT_SIZE ;
+    bool pruned = false ;
+    bool eliminate = false ;
+    bool positional = false ;
+    bool presolve = false ;
+    int cardinality = 0 ;
+    int opt ;
+    while ((opt = getopt(argc,argv,"n:pelscC")) != -1){
+        switch (opt){
+            case 'n':
+                N = atoi(optarg) ;
+                break ;
+            case 'p':
+                pruned = true ;
+                break ;
+            case 'e':
+                eliminate = true ;
+                break ;
+            case 'l':
+                positional = true ;
+                break ;
+            case 's':
+                presolve = true ;
+                break ;
+            case 'c':
+                cardinality |= CARDINALITY_LINES ;
+                break ;
+            case 'C':
+                cardinality |= CARDINALITY_BOARD ;
+                break ;
+            default:
+                fprintf(stderr,"usage: %s [-n size] [-p] [-e] [-l] [-s] [-c] [-C] archive.ngar | formula.cnf | formula.cnfb...\n",argv[0]) ;
+                return 1 ;
+        }
+    }
+    if (N < 1 || optind == argc){
+        fprintf(stderr,"Give the board size and at least one archive or formula\n") ;
+        return 1 ;
+    }
+    lineEncoding layout = *(eliminate ? (pruned ? &prunedEliminatedEncoding : &eliminatedEncoding)
+                                      : (pruned ? &prunedEncoding : &automatonEncoding)) ;
+    layout.positional = positional ;
+
+    // regExEncoding's densities, accumulated the same way so the boards match
+    float densities[64] ;
+    int densityTotal = 0 ;
+    for (float d = 0.03 ; d < 1.0; d = d + 0.03){
+        densities[densityTotal] = d ;
+        densityTotal += 1 ;
+    }
+
+    Arena * scratch = arena_new(SCRATCH_SIZE) ;
+    LineCache * cache = linecache_new(&layout,CACHE_LITERALS) ;
+    ClauseSink * expected = sink_dimacs(NULL) ;
+    ClauseSink * expectedBinary = sink_bincnf(NULL) ;
+    ClauseSink * decoded = sink_dimacs(NULL) ;
+    uint64_t * board = malloc((size_t) N*boardWords(N)*sizeof(uint64_t)) ;
+    size_t checked = 0 ;
+    for (int a = optind ; a < argc ; a++){
+        const char * path = argv[a] ;
+        const size_t pathLength = strlen(path) ;
+        if (pathLength < 5 || strcmp(path + pathLength - 5,".ngar") != 0){
+            // A formula file, named by its density and board
+            const char * name = strrchr(path,'/') != NULL ? strrchr(path,'/') + 1 : path ;
+            int density, b ;
+            if (sscanf(name,"%d %d.",&density,&b) != 2 || density < 1 || density > densityTotal || b < 0){
+                fprintf(stderr,"%s is not named as regExEncoding names a formula\n",path) ;
+                return 1 ;
+            }
+            MTRand seed = seedRand(boardSeed(SEED,density - 1,b)) ;
+            fillBoard(board,N,densities[density - 1],&seed) ;
+            sink_reset(expected) ;
+            encodeBoard(board,N,presolve,cardinality,cache,expected,scratch) ;
+            if (pathLength > 5 && strcmp(path + pathLength - 5,".cnfb") == 0){
+                BinaryCnf * cnf = bincnf_load(path) ;
+                if (cnf == NULL){
+                    mismatch(path,density,b,"bincnf_load cannot read it") ;
+                } else {
+                    checkDecoded(path,density,b,cnf,expected,decoded) ;
+                    bincnf_free(cnf) ;
+                }
+            } else {
+                size_t size ;
+                char * formula = readFile(path,&size) ;
+                if (formula == NULL || size != sink_size(expected) || memcmp(formula,sink_data(expected),size) != 0){
+                    mismatch(path,density,b,"the formula differs from the board encoded again") ;
+                }
+                free(formula) ;
+            }
+            checked += 1 ;
+            continue ;
+        }
+        ArchiveReader * archive = archive_open(path) ;
+        if (archive == NULL){
+            fprintf(stderr,"%s is not a CNF archive\n",path) ;
+            return 1 ;
+        }
+        size_t length ;
+        if (archive_find(archive,0,0,&length) != NULL){
+            mismatch(path,0,0,"a pair the sweep never writes is found") ;
+        }
+        for (size_t i = 0 ; i < archive_count(archive) ; i++){
+            const ArchiveEntry * e = archive_entry(archive,i) ;
+            if (i > 0){
+                const ArchiveEntry * before = archive_entry(archive,i - 1) ;
+                if (before->density > e->density || (before->density == e->density && before->board >= e->board)){
+                    mismatch(path,e->density,e->board,"the index is out of order") ;
+                }
+            }
+            const char * formula = archive_find(archive,e->density,e->board,&length) ;
+            if (formula == NULL || length != e->length){
+                mismatch(path,e->density,e->board,"archive_find does not give back the indexed formula") ;
+                continue ;
+            }
+            if (e->density < 1 || e->density > densityTotal || e->board < 0){
+                mismatch(path,e->density,e->board,"no such board in the sweep") ;
+                continue ;
+            }
+            MTRand seed = seedRand(boardSeed(SEED,e->density - 1,e->board)) ; // Archives count densities from 1, as the file names do
+            fillBoard(board,N,densities[e->density - 1],&seed) ;
+            sink_reset(expected) ;
+            encodeBoard(board,N,presolve,cardinality,cache,expected,scratch) ;
+            if (length >= 4 && memcmp(formula,BINCNF_MAGIC,4) == 0){
+                sink_reset(expectedBinary) ;
+                encodeBoard(board,N,presolve,cardinality,cache,expectedBinary,scratch) ;
+                if (length != sink_size(expectedBinary) || memcmp(formula,sink_data(expectedBinary),length) != 0){
+                    mismatch(path,e->density,e->board,"the binary formula differs from the board encoded again") ;
+                }
+                BinaryCnf * cnf = bincnf_read(formula,length) ;
+                if (cnf == NULL){
+                    mismatch(path,e->density,e->board,"bincnf_read cannot decode it") ;
+                } else {
+                    checkDecoded(path,e->density,e->board,cnf,expected,decoded) ;
+                    bincnf_free(cnf) ;
+                }
+            } else if (length != sink_size(expected) || memcmp(formula,sink_data(expected),length) != 0){
+                mismatch(path,e->density,e->board,"the formula differs from the board encoded again") ;
+            }
+            checked += 1 ;
+        }
+        archive_close(archive) ;
+    }
+    printf("%zu formulae checked, %ld mismatches\n",checked,mismatches) ;
+    free(board) ;
+    sink_free(expected) ;
+    sink_free(expectedBinary) ;
+    sink_free(decoded) ;
+    linecache_free(cache) ;
+    arena_free(scratch) ;
+    return mismatches > 0 ;
+}
+
+void mismatch(const char * path, int density, int board, const char * what){
+    if (mismatches < MAX_REPORTED){
+        printf("%s, density %d board %d: %s\n",path,density,board,what) ;
+    }
+    mismatches += 1 ;
+    return ;
+}
+
+void encodeBoard(const uint64_t * board, int N, bool presolve, int cardinality, LineCache * cache, ClauseSink * out, Arena * scratch){
+    arena_reset(scratch) ;
+    description * rows = descriptionsFromBits(board,N,scratch) ;
+    uint64_t * columns = arena_alloc(scratch,N*boardWords(N)*sizeof(uint64_t)) ;
+    description * columnDescriptions = descriptionsFromBits(transposeBits(board,columns,N),N,scratch) ;
+    signed char * cells = NULL ;
+    if (presolve){
+        cells = arena_alloc(scratch,(size_t) N*N) ;
+        memset(cells,CELL_UNKNOWN,(size_t) N*N) ;
+        if (linesolve_board(rows,columnDescriptions,N,N,cells,scratch) < 0){
+            memset(cells,CELL_UNKNOWN,(size_t) N*N) ;
+        }
+    }
+    int64_t clauses ;
+    stream_board(rows,columnDescriptions,N,N,cells,cardinality,cache,out,&clauses,scratch) ;
+    return ;
+}
+
+void checkDecoded(const char * path, int density, int board, const BinaryCnf * cnf, ClauseSink * text, ClauseSink * decoded){
+    sink_reset(decoded) ;
+    sink_header(decoded,bincnf_vars(cnf),bincnf_clauses(cnf)) ;
+    for (int i = 0 ; i < bincnf_clauses(cnf) ; i++){
+        int len ;
+        const int * clause = bincnf_clause(cnf,i,&len) ;
+        sink_clause(decoded,clause,len) ;
+    }
+    if (sink_size(decoded) != sink_size(text) || memcmp(sink_data(decoded),sink_data(text),sink_size(text)) != 0){
+        mismatch(path,density,board,"the decoded formula differs from the text of the board") ;
+    }
+    return ;
+}
+
+char * readFile(const char * path, size_t * size){
+    FILE * fp = fopen(path,"rb") ;
+    if (fp == NULL){
+        return NULL ;
+    }
+    fseek(fp,0,SEEK_END) ;
+    *size = ftell(fp) ;
+    rewind(fp) ;
+    char * data = malloc(*size > 0 ? *size : 1) ;
+    if (fread(data,1,*size,fp) != *size){
+        free(data) ;
+        data = NULL ;
+    }
+    fclose(fp) ;
+    return data ;
+}
@@ -0,0 +1,624 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+// gcc -O2 -I../encoding -DCOUNT_ALLOCATIONS -Wl,--wrap=malloc,--wrap=calloc,--wrap=realloc -o kernelBenchmark kernelBenchmark.c dnfKernels.c ../encoding/nonogram.c ../encoding/sink.c ../encoding/arena.c ../encoding/buf.c ../encoding/stats.c ../encoding/trace.c ../encoding/mtwister.c -lm
+
+#include "nonogram.h"
+#include "sink.h"
+#include "arena.h"
+#include "buf.h"
+#include "mtwister.h"
+#include "dnfKernels.h"
+
+#define DEFAULT_BOARDS 2 // The boards at each size and density when none is given with -b
+#define DEFAULT_ROUNDS 3 // The timed passes over the boards when none is given with -r
+#define SEED 32 // regExEncoding's sweep seed, so the boards are the ones its multithreaded sweep writes
+#define SCRATCH_SIZE (1 << 16) // Initial size of each arena, which grows to fit the largest board
+#define BUF_SIZE (1 << 20) // The capacity of the buf_append buffer, which is emptied whenever it is nearly full
+
+/*
+Microbenchmarks of the kernels that encoding a board is made of, for comparing them between
+commits. Every kernel is run on the same boards (fixed seeds) at each board size of SIZES and
+density of DENSITIES, once untimed (so the arenas and caches have grown) and then for -r timed
+rounds, and its time, output bytes and heap allocations are divided by the calls made. The kernels:
+
+    genRand --> one draw of the Mersenne Twister (mtwister.h), N*N for each board
+    transpose, transposeBits --> an int board and a bit packed board transposed (nonogram.h)
+    descriptionsFromBoard, descriptionsFromBits --> the row descriptions of an int and a bit packed
+                                                    board
+    buildNFA --> the automaton of one line's description
+    buildConstraint, buildPrunedConstraint --> the formula of one line from its automaton, into a
+                                               recording sink (so the clauses are not formatted)
+    emptyLine --> the singleton clauses of an empty line
+    buf_append --> one clause formatted as DIMACS text with buf.h's buf_append, a call per literal
+                   (the way clauses were written before the sinks)
+    dimacs --> one clause formatted by the DIMACS sink (sink.h), which replaced buf_append
+    build --> the DNF fillings of one description by dnfToCNF.c's build (see dnfKernels.h), on
+              boards of dnfToCNF.c's size with the densities' share of their cells filled
+    copyCNFscaled --> one line's CNF formula copied into the board's variables by dnfToCNF.c, on
+                      the same boards
+    subsumption --> dnfToCNF.c's removal of the subsumed clauses of a board's formula, on the same
+                    boards
+
+The bytes of a kernel are what it produces: the transposed board, the descriptions or automaton
+(what it takes from its arena), the formula in the recording sink, the text written, or the terms
+of the fillings or clauses. Heap allocations are only counted when the benchmark is built with
+-DCOUNT_ALLOCATIONS and GNU ld's --wrap for malloc, calloc and realloc (see the compile line), and
+are -1 otherwise. The kernels that use an arena only go to the heap while it grows, so they are 0
+once the untimed pass is done and the arena is reset to a single block of the size it needed.
+*/
+
+static const int SIZES[] = {10, 25, 40, 60, 100} ;
+static const float DENSITIES[] = {0.1, 0.3, 0.5, 0.7, 0.9} ;
+#define SIZE_COUNT ((int) (sizeof(SIZES)/sizeof(SIZES[0])))
+#define DENSITY_COUNT ((int) (sizeof(DENSITIES)/sizeof(DENSITIES[0])))
+
+/*
+The boards of one (size, density) point and what the kernels take as input. Each field:
+
+    size --> the size of the boards
+    count --> the number of boards
+    bits --> the bit packed boards, one after another
+    ints --> the same boards as int boards
+    descriptions --> the row descriptions then the column descriptions of each board (2*size each)
+    automata --> the automaton of each description (NULL for an empty one)
+    stringVars --> the variables of a line's cells (1 to size)
+    keep --> the arena holding the descriptions and automata
+    scratch --> the arena the kernels allocate from, released after every call
+    record --> the recording sink the line kernels write to, kept between passes so the buffer the
+               untimed pass grew is there for the timed ones
+*/
+typedef struct point {
+    int size ;
+    int count ;
+    uint64_t * bits ;
+    int * ints ;
+    description * descriptions ;
+    nfa ** automata ;
+    int * stringVars ;
+    Arena * keep ;
+    Arena * scratch ;
+    ClauseSink * record ;
+} point ;
+
+/*
+newPoint: int x int x int x int -> point *
+newPoint(N,b,di,count) = P, the count boards of size N at the density of index di, drawn from the
+same per-board streams as regExEncoding's multithreaded sweep, with their descriptions and automata
+
+freePoint: point * -> void
+*/
+point * newPoint(int N, int densityIndex, int count) ;
+void freePoint(point * p) ;
+
+/*
+Each kernel function runs its kernel over every board (or line, or clause) of p once, adding to
+totals only if timed is true. Kernels that need an arena allocate from p->scratch and release it.
+*/
+void benchGenRand(point * p, kernelTotals * totals, bool timed) ;
+void benchTranspose(point * p, kernelTotals * totals, bool timed) ;
+void benchTransposeBits(point * p, kernelTotals * totals, bool timed) ;
+void benchDescriptionsFromBoard(point * p, kernelTotals * totals, bool timed) ;
+void benchDescriptionsFromBits(point * p, kernelTotals * totals, bool timed) ;
+void benchBuildNFA(point * p, kernelTotals * totals, bool timed) ;
+void benchBuildConstraint(point * p, kernelTotals * totals, bool timed) ;
+void benchBuildPrunedConstraint(point * p, kernelTotals * totals, bool timed) ;
+void benchEmptyLine(point * p, kernelTotals * totals, bool timed) ;
+void benchBufAppend(point * p, kernelTotals * totals, bool timed) ;
+void benchDimacs(point * p, kernelTotals * totals, bool timed) ;
+void benchBuild(point * p, kernelTotals * totals, bool timed) ;
+void benchCopyCNFscaled(point * p, kernelTotals * totals, bool timed) ;
+void benchSubsumption(point * p, kernelTotals * totals, bool timed) ;
+
+/*
+report: FILE * x const char * x int x float x kernelTotals * -> void
+report(fp,kernel,N,d,t) writes the CSV row of kernel at size N and density d from its totals t, and prints it
+*/
+void report(FILE * fp, const char * kernel, int N, float d, const kernelTotals * t) ;
+
+typedef struct kernel {
+    const char * name ;
+    void (*run)(point * p, kernelTotals * totals, bool timed) ;
+} kernel ;
+
+static const kernel KERNELS[] = {
+    {"genRand", benchGenRand},
+    {"transpose", benchTranspose},
+    {"transposeBits", benchTransposeBits},
+    {"descriptionsFromBoard", benchDescriptionsFromBoard},
+    {"descriptionsFromBits", benchDescriptionsFromBits},
+    {"buildNFA", benchBuildNFA},
+    {"buildConstraint", benchBuildConstraint},
+    {"buildPrunedConstraint", benchBuildPrunedConstraint},
+    {"emptyLine", benchEmptyLine},
+    {"buf_append", benchBufAppend},
+    {"dimacs", benchDimacs},
+} ;
+#define KERNEL_COUNT ((int) (sizeof(KERNELS)/sizeof(KERNELS[0])))
+
+// The kernels of dnfToCNF.c, which only run on boards of its size
+static const kernel DNF_KERNELS[] = {
+    {"build", benchBuild},
+    {"copyCNFscaled", benchCopyCNFscaled},
+    {"subsumption", benchSubsumption},
+} ;
+#define DNF_KERNEL_COUNT ((int) (sizeof(DNF_KERNELS)/sizeof(DNF_KERNELS[0])))
+
+#ifdef COUNT_ALLOCATIONS
+// Every malloc, calloc and realloc of the program goes through these, with the linker's --wrap
+static long allocations = 0 ;
+void * __real_malloc(size_t size) ;
+void * __real_calloc(size_t count, size_t size) ;
+void * __real_realloc(void * pointer, size_t size) ;
+
+void * __wrap_malloc(size_t size){
+    allocations += 1 ;
+    return __real_malloc(size) ;
+}
+
+void * __wrap_calloc(size_t count, size_t size){
+    allocations += 1 ;
+    return __real_calloc(count,size) ;
+}
+
+void * __wrap_realloc(void * pointer, size_t size){
+    allocations += 1 ;
+    return __real_realloc(pointer,size) ;
+}
+
+long bench_allocations(void){
+    return allocations ;
+}
+#else
+long bench_allocations(void){
+    return -1 ;
+}
+#endif
+
+uint64_t bench_now(void){
+    struct timespec t ;
+    clock_gettime(CLOCK_MONOTONIC,&t) ;
+    return (uint64_t) t.tv_sec*1000000000u + t.tv_nsec ;
+}
+
+int main(int argc, char ** argv){
+    int boards = DEFAULT_BOARDS ;
+    int rounds = DEFAULT_ROUNDS ;
+    const char * output = "kernelBenchmark.csv" ;
+    int option ;
+    while ((option = getopt(argc,argv,"b:r:o:")) != -1){
+        switch (option){
+            case 'b':
+                boards = atoi(optarg) ;
+                break ;
+            case 'r':
+                rounds = atoi(optarg) ;
+                break ;
+            case 'o':
+                output = optarg ;
+                break ;
+            default:
+                fprintf(stderr,"usage: %s [-b boards] [-r rounds] [-o output.csv]\n",argv[0]) ;
+                return 1 ;
+        }
+    }
+    if (boards < 1 || rounds < 1){
+        fprintf(stderr,"The boards and rounds must be positive\n") ;
+        return 1 ;
+    }
+    FILE * fp = fopen(output,"w") ;
+    if (fp == NULL){
+        perror(output) ;
+        return 1 ;
+    }
+    fprintf(fp,"kernel,size,density,ops,nsPerOp,bytesPerOp,allocationsPerOp\n") ;
+    printf("%-22s %5s %7s %10s %12s %12s %12s\n","kernel","size","density","ops","ns/op","bytes/op","allocs/op") ;
+
+    for (int s = 0 ; s < SIZE_COUNT ; s++){
+        for (int di = 0 ; di < DENSITY_COUNT ; di++){
+            point * p = newPoint(SIZES[s],di,boards) ;
+            for (int k = 0 ; k < KERNEL_COUNT ; k++){
+                kernelTotals totals = {0,0,0,0} ;
+                KERNELS[k].run(p,&totals,false) ;
+                arena_reset(p->scratch) ; // Its blocks become one of the size the untimed pass needed, which the timed passes then fit in
+                for (int r = 0 ; r < rounds ; r++){
+                    KERNELS[k].run(p,&totals,true) ;
+                }
+                report(fp,KERNELS[k].name,SIZES[s],DENSITIES[di],&totals) ;
+            }
+            freePoint(p) ;
+        }
+    }
+
+    // dnfToCNF.c only encodes boards of its own size, so its kernels get one point per density
+    for (int di = 0 ; di < DENSITY_COUNT ; di++){
+        point * p = newPoint(dnf_size(),di,boards) ;
+        for (int k = 0 ; k < DNF_KERNEL_COUNT ; k++){
+            kernelTotals totals = {0,0,0,0} ;
+            for (int r = 0 ; r < rounds ; r++){ // Every pass starts from empty trees, so none is left untimed
+                DNF_KERNELS[k].run(p,&totals,true) ;
+            }
+            report(fp,DNF_KERNELS[k].name,dnf_size(),DENSITIES[di],&totals) ;
+        }
+        freePoint(p) ;
+    }
+
+    if (fclose(fp) != 0){
+        perror(output) ;
+        return 1 ;
+    }
+    return 0 ;
+}
+
+point * newPoint(int N, int densityIndex, int count){
+    point * p = malloc(sizeof(point)) ;
+    p->size = N ;
+    p->count = count ;
+    const int words = boardWords(N) ;
+    p->bits = calloc((size_t) count*N*words,sizeof(uint64_t)) ;
+    p->ints = malloc((size_t) count*N*N*sizeof(int)) ;
+    p->keep = arena_new(SCRATCH_SIZE) ;
+    p->scratch = arena_new(SCRATCH_SIZE) ;
+    p->record = sink_record() ;
+    p->descriptions = malloc((size_t) count*2*N*sizeof(description)) ;
+    p->automata = malloc((size_t) count*2*N*sizeof(nfa *)) ;
+    p->stringVars = malloc(N*sizeof(int)) ;
+    for (int j = 0 ; j < N ; j++){
+        p->stringVars[j] = j + 1 ;
+    }
+    uint64_t * transposed = malloc(N*words*sizeof(uint64_t)) ;
+    for (int b = 0 ; b < count ; b++){
+        uint64_t * board = p->bits + (size_t) b*N*words ;
+        MTRand seed = seedRand(boardSeed(SEED,densityIndex,b)) ;
+        fillBoard(board,N,DENSITIES[densityIndex],&seed) ;
+        for (int i = 0 ; i < N ; i++){
+            for (int j = 0 ; j < N ; j++){
+                p->ints[(size_t) b*N*N + i*N + j] = (board[i*words + j/64] >> (j % 64)) & 1 ;
+            }
+        }
+        description * rows = descriptionsFromBits(board,N,p->keep) ;
+        description * columns = descriptionsFromBits(transposeBits(board,transposed,N),N,p->keep) ;
+        for (int i = 0 ; i < N ; i++){
+            p->descriptions[(size_t) b*2*N + i] = rows[i] ;
+            p->descriptions[(size_t) b*2*N + N + i] = columns[i] ;
+        }
+        for (int i = 0 ; i < 2*N ; i++){
+            const description * d = &p->descriptions[(size_t) b*2*N + i] ;
+            p->automata[(size_t) b*2*N + i] = d->length == 0 ? NULL : buildNFA(d,p->keep) ;
+        }
+    }
+    free(transposed) ;
+    return p ;
+}
+
+void freePoint(point * p){
+    arena_free(p->keep) ;
+    arena_free(p->scratch) ;
+    sink_free(p->record) ;
+    free(p->bits) ;
+    free(p->ints) ;
+    free(p->descriptions) ;
+    free(p->automata) ;
+    free(p->stringVars) ;
+    free(p) ;
+    return ;
+}
+
+// The bytes taken from an arena since the mark before (all of them once it moves to a new block, which the reset after the untimed pass avoids)
+static size_t arenaBytes(ArenaMark before, ArenaMark after){
+    return after.block == before.block ? after.used - before.used : after.used ;
+}
+
+// Keeps the compiler from dropping a result that is otherwise unused
+static volatile double sinkhole ;
+
+void benchGenRand(point * p, kernelTotals * totals, bool timed){
+    MTRand seed = seedRand(SEED) ;
+    const long draws = (long) p->count*p->size*p->size ;
+    double sum = 0.0 ;
+    const long allocations = bench_allocations() ;
+    const uint64_t start = bench_now() ;
+    for (long k = 0 ; k < draws ; k++){
+        sum += genRand(&seed) ;
+    }
+    const uint64_t end = bench_now() ;
+    sinkhole = sum ;
+    if (timed){
+        totals->ops += draws ;
+        totals->nanoseconds += end - start ;
+        totals->bytes += draws*sizeof(double) ;
+        totals->allocations += bench_allocations() - allocations ;
+    }
+    return ;
+}
+
+void benchTranspose(point * p, kernelTotals * totals, bool timed){
+    const int N = p->size ;
+    const long allocations = bench_allocations() ;
+    const uint64_t start = bench_now() ;
+    for (int b = 0 ; b < p->count ; b++){
+        transpose(p->ints + (size_t) b*N*N,N) ; // In place, so every other round sees the transposed boards
+    }
+    const uint64_t end = bench_now() ;
+    if (timed){
+        totals->ops += p->count ;
+        totals->nanoseconds += end - start ;
+        totals->bytes += (uint64_t) p->count*N*N*sizeof(int) ;
+        totals->allocations += bench_allocations() - allocations ;
+    }
+    return ;
+}
+
+void benchTransposeBits(point * p, kernelTotals * totals, bool timed){
+    const int N = p->size ;
+    const int words = boardWords(N) ;
+    ArenaMark mark = arena_mark(p->scratch) ;
+    uint64_t * transposed = arena_alloc(p->scratch,N*words*sizeof(uint64_t)) ;
+    const long allocations = bench_allocations() ;
+    const uint64_t start = bench_now() ;
+    for (int b = 0 ; b < p->count ; b++){
+        transposeBits(p->bits + (size_t) b*N*words,transposed,N) ;
+    }
+    const uint64_t end = bench_now() ;
+    arena_release(p->scratch,mark) ;
+    if (timed){
+        totals->ops += p->count ;
+        totals->nanoseconds += end - start ;
+        totals->bytes += (uint64_t) p->count*N*words*sizeof(uint64_t) ;
+        totals->allocations += bench_allocations() - allocations ;
+    }
+    return ;
+}
+
+void benchDescriptionsFromBoard(point * p, kernelTotals * totals, bool timed){
+    const int N = p->size ;
+    uint64_t bytes = 0 ;
+    const long allocations = bench_allocations() ;
+    const uint64_t start = bench_now() ;
+    for (int b = 0 ; b < p->count ; b++){
+        ArenaMark mark = arena_mark(p->scratch) ;
+        descriptionsFromBoard(p->ints + (size_t) b*N*N,N,p->scratch) ;
+        bytes += arenaBytes(mark,arena_mark(p->scratch)) ;
+        arena_release(p->scratch,mark) ;
+    }
+    const uint64_t end = bench_now() ;
+    if (timed){
+        totals->ops += p->count ;
+        totals->nanoseconds += end - start ;
+        totals->bytes += bytes ;
+        totals->allocations += bench_allocations() - allocations ;
+    }
+    return ;
+}
+
+void benchDescriptionsFromBits(point * p, kernelTotals * totals, bool timed){
+    const int N = p->size ;
+    const int words = boardWords(N) ;
+    uint64_t bytes = 0 ;
+    const long allocations = bench_allocations() ;
+    const uint64_t start = bench_now() ;
+    for (int b = 0 ; b < p->count ; b++){
+        ArenaMark mark = arena_mark(p->scratch) ;
+        descriptionsFromBits(p->bits + (size_t) b*N*words,N,p->scratch) ;
+        bytes += arenaBytes(mark,arena_mark(p->scratch)) ;
+        arena_release(p->scratch,mark) ;
+    }
+    const uint64_t end = bench_now() ;
+    if (timed){
+        totals->ops += p->count ;
+        totals->nanoseconds += end - start ;
+        totals->bytes += bytes ;
+        totals->allocations += bench_allocations() - allocations ;
+    }
+    return ;
+}
+
+void benchBuildNFA(point * p, kernelTotals * totals, bool timed){
+    const long lines = (long) p->count*2*p->size ;
+    long ops = 0 ;
+    uint64_t bytes = 0 ;
+    const long allocations = bench_allocations() ;
+    const uint64_t start = bench_now() ;
+    for (long i = 0 ; i < lines ; i++){
+        if (p->descriptions[i].length == 0){
+            continue ;
+        }
+        ArenaMark mark = arena_mark(p->scratch) ;
+        buildNFA(&p->descriptions[i],p->scratch) ;
+        bytes += arenaBytes(mark,arena_mark(p->scratch)) ;
+        arena_release(p->scratch,mark) ;
+        ops += 1 ;
+    }
+    const uint64_t end = bench_now() ;
+    if (timed){
+        totals->ops += ops ;
+        totals->nanoseconds += end - start ;
+        totals->bytes += bytes ;
+        totals->allocations += bench_allocations() - allocations ;
+    }
+    return ;
+}
+
+// The formula of every non-empty line of p written by build into a recording sink, a call at a time
+static void buildLines(point * p, int (*build)(nfa *, int *, int *, const description *, int, ClauseSink *, Arena *), kernelTotals * totals, bool timed){
+    const int N = p->size ;
+    const long lines = (long) p->count*2*N ;
+    ClauseSink * out = p->record ;
+    long ops = 0 ;
+    uint64_t bytes = 0 ;
+    const long allocations = bench_allocations() ;
+    const uint64_t start = bench_now() ;
+    for (long i = 0 ; i < lines ; i++){
+        if (p->automata[i] == NULL){
+            continue ;
+        }
+        sink_reset(out) ;
+        int varIndex = N*N + 1 ;
+        build(p->automata[i],p->stringVars,&varIndex,&p->descriptions[i],N,out,p->scratch) ;
+        bytes += sink_size(out) ;
+        ops += 1 ;
+    }
+    const uint64_t end = bench_now() ;
+    if (timed){
+        totals->ops += ops ;
+        totals->nanoseconds += end - start ;
+        totals->bytes += bytes ;
+        totals->allocations += bench_allocations() - allocations ;
+    }
+    return ;
+}
+
+void benchBuildConstraint(point * p, kernelTotals * totals, bool timed){
+    buildLines(p,buildConstraint,totals,timed) ;
+    return ;
+}
+
+void benchBuildPrunedConstraint(point * p, kernelTotals * totals, bool timed){
+    buildLines(p,buildPrunedConstraint,totals,timed) ;
+    return ;
+}
+
+void benchEmptyLine(point * p, kernelTotals * totals, bool timed){
+    const long lines = (long) p->count*2*p->size ;
+    ClauseSink * out = p->record ;
+    uint64_t bytes = 0 ;
+    const long allocations = bench_allocations() ;
+    const uint64_t start = bench_now() ;
+    for (long i = 0 ; i < lines ; i++){
+        sink_reset(out) ;
+        emptyLine(p->stringVars,p->size,out) ;
+        bytes += sink_size(out) ;
+    }
+    const uint64_t end = bench_now() ;
+    if (timed){
+        totals->ops += lines ;
+        totals->nanoseconds += end - start ;
+        totals->bytes += bytes ;
+        totals->allocations += bench_allocations() - allocations ;
+    }
+    return ;
+}
+
+/*
+formatLines: point * x bool x kernelTotals * x bool -> void
+formatLines(p,useBuf,t,timed) formats the clauses of every non-empty line of p as DIMACS text,
+with buf_append if useBuf and with the DIMACS sink otherwise. Each line's formula is recorded
+(untimed) first, so only the formatting is timed.
+*/
+static void formatLines(point * p, bool useBuf, kernelTotals * totals, bool timed){
+    const int N = p->size ;
+    const long lines = (long) p->count*2*N ;
+    ClauseSink * record = sink_record() ;
+    ClauseSink * text = sink_dimacs(NULL) ;
+    Buf buf = buf_new(BUF_SIZE) ;
+    long ops = 0 ;
+    uint64_t bytes = 0 ;
+    uint64_t nanoseconds = 0 ;
+    const long allocations = bench_allocations() ;
+    long recordAllocations = 0 ;
+    for (long i = 0 ; i < lines ; i++){
+        if (p->automata[i] == NULL){
+            continue ;
+        }
+        const long before = bench_allocations() ;
+        sink_reset(record) ;
+        int varIndex = N*N + 1 ;
+        buildConstraint(p->automata[i],p->stringVars,&varIndex,&p->descriptions[i],N,record,p->scratch) ;
+        const int * packed = (const int *) sink_data(record) ;
+        const size_t size = sink_size(record)/sizeof(int) ;
+        recordAllocations += bench_allocations() - before ;
+
+        const uint64_t start = bench_now() ;
+        if (useBuf){
+            for (size_t k = 0 ; k < size ; k += packed[k] + 1){
+                if (buf_len(buf) + 1024 > buf_cap(buf)){
+                    bytes += buf_len(buf) ;
+                    buf_reset(buf) ;
+                }
+                for (int j = 1 ; j <= packed[k] ; j++){
+                    buf_append(buf,"%d ",packed[k + j]) ;
+                }
+                buf_append(buf,"0\n") ;
+                ops += 1 ;
+            }
+        } else {
+            sink_reset(text) ;
+            sink_clauses(text,packed,size) ;
+            bytes += sink_size(text) ;
+            for (size_t k = 0 ; k < size ; k += packed[k] + 1){
+                ops += 1 ;
+            }
+        }
+        nanoseconds += bench_now() - start ;
+    }
+    bytes += buf_len(buf) ;
+    if (timed){
+        totals->ops += ops ;
+        totals->nanoseconds += nanoseconds ;
+        totals->bytes += bytes ;
+        totals->allocations += bench_allocations() - allocations - recordAllocations ;
+    }
+    free(buf) ;
+    sink_free(text) ;
+    sink_free(record) ;
+    return ;
+}
+
+void benchBufAppend(point * p, kernelTotals * totals, bool timed){
+    formatLines(p,true,totals,timed) ;
+    return ;
+}
+
+void benchDimacs(point * p, kernelTotals * totals, bool timed){
+    formatLines(p,false,totals,timed) ;
+    return ;
+}
+
+// Runs one of dnfKernels.h's kernels over every board of p
+static void dnfPass(point * p, void (*kernel)(const int * board, kernelTotals * totals), kernelTotals * totals, bool timed){
+    const int N = p->size ;
+    kernelTotals pass = {0,0,0,0} ;
+    for (int b = 0 ; b < p->count ; b++){
+        kernel(p->ints + (size_t) b*N*N,&pass) ;
+    }
+    if (timed){
+        totals->ops += pass.ops ;
+        totals->nanoseconds += pass.nanoseconds ;
+        totals->bytes += pass.bytes ;
+        totals->allocations += pass.allocations ;
+    }
+    return ;
+}
+
+void benchBuild(point * p, kernelTotals * totals, bool timed){
+    dnfPass(p,dnf_build,totals,timed) ;
+    return ;
+}
+
+void benchCopyCNFscaled(point * p, kernelTotals * totals, bool timed){
+    dnfPass(p,dnf_copy,totals,timed) ;
+    return ;
+}
+
+void benchSubsumption(point * p, kernelTotals * totals, bool timed){
+    dnfPass(p,dnf_subsumption,totals,timed) ;
+    return ;
+}
+
+void report(FILE * fp, const char * kernel, int N, float d, const kernelTotals * t){
+    const double ops = t->ops > 0 ? t->ops : 1 ;
+    char allocations[32] ;
+    if (bench_allocations() < 0){
+        snprintf(allocations,sizeof(allocations),"NA") ;
+    } else {
+        snprintf(allocations,sizeof(allocations),"%.3f",t->allocations/ops) ;
+    }
+    fprintf(fp,"%s,%d,%.2f,%ld,%.1f,%.1f,%s\n",kernel,N,d,t->ops,t->nanoseconds/ops,t->bytes/ops,allocations) ;
+    printf("%-22s %5d %7.2f %10ld %12.1f %12.1f %12s\n",kernel,N,d,t->ops,t->nanoseconds/ops,t->bytes/ops,allocations) ;
+    fflush(stdout) ;
+    return ;
+}
@@ -0,0 +1,59 @@
+"""
+Compares solver time on the same boards encoded two ways, one archive of each. Both archives of a
+comparison have to come from the multithreaded sweep (any -t), which encodes the same boards
+whatever the options, e.g. for the block variable numbering against the positional layout of
+regExEncoding -l on the 25x25 set
+
+    ./outputName -n 25 -t 8 -a blocks25.ngar
+    ./outputName -n 25 -t 8 -l -a positional25.ngar
+
+or for the formulae without and with the cardinality constraints of -c (or -C)
+
+    ./outputName -n 25 -t 8 -a plain25.ngar
+    ./outputName -n 25 -t 8 -c -a cardinality25.ngar
+
+Each formula gets the inference workload of phaseTransition.py (one solve per cell, assuming it
+empty), timed on its own, and the times are reported by density along with the difference and the
+ratio of the solver's propagations. Both encodings of a board must infer the same cells.
+"""
+
+from tqdm import tqdm
+from cnfArchive import openArchive, readFormula, inference
+
+# Each comparison: (board size, (name, archive), (name, archive))
+comparisons = [
+    (25, ('blocks', 'blocks25.ngar'), ('positional', 'positional25.ngar')),
+    (40, ('blocks', 'blocks40.ngar'), ('positional', 'positional40.ngar')),
+]
+densities = range(1,21) # The density indices to compare (1-indexed, as in the archives)
+boards = 50 # Boards compared at each density
+output = 'layoutBenchmark.csv' # Per board times (None to only print the summary)
+
+rows = []
+for n, (firstName, firstPath), (secondName, secondPath) in comparisons:
+    first, second = openArchive(firstPath), openArchive(secondPath)
+    print(f"{n}x{n}: {firstName} against {secondName}")
+    print(f"{'density':>8} {firstName + ' (s)':>14} {secondName + ' (s)':>14} {'difference':>11} {'propagations':>13}")
+    totalFirst = totalSecond = 0.0
+    for p in densities:
+        sumFirst = sumSecond = 0.0
+        propagations = [0, 0]
+        for b in tqdm(range(boards), leave = False):
+            tFirst, aFirst, pFirst = inference(readFormula(first, (p, b)), n)
+            tSecond, aSecond, pSecond = inference(readFormula(second, (p, b)), n)
+            if aFirst != aSecond: # Both archives encode the same boards, so the same cells must be inferred
+                raise ValueError(f'{n}x{n} board {p} {b} infers {aFirst} cells from {firstPath} but {aSecond} from {secondPath}')
+            rows.append((n, firstName, secondName, p, b, aFirst, tFirst, tSecond, pFirst, pSecond))
+            sumFirst += tFirst
+            sumSecond += tSecond
+            propagations = [propagations[0] + pFirst, propagations[1] + pSecond]
+        totalFirst += sumFirst
+        totalSecond += sumSecond
+        print(f"{p:>8} {sumFirst/boards:>14.4f} {sumSecond/boards:>14.4f} {100*(sumSecond - sumFirst)/sumFirst:>10.1f}% {propagations[1]/propagations[0]:>12.2f}x")
+    print(f"{'all':>8} {totalFirst:>14.2f} {totalSecond:>14.2f} {100*(totalSecond - totalFirst)/totalFirst:>10.1f}%\n")
+
+if output is not None:
+    with open(output,"w") as f:
+        f.write("size,first,second,density,board,alpha,firstTime,secondTime,firstPropagations,secondPropagations\n")
+        for row in rows:
+            f.write(','.join(str(x) for x in row) + '\n')
@@ -2,6 +2,7 @@ from pysat.formula import CNF # You need to download this (see readMe)
 from pysat.solvers import Glucose42 # You need to download this (see readMe)
 from tqdm import tqdm
 from time import time
+from cnfArchive import openArchive, readFormula, readFile, inference
 
 # The filled cell densities
 probs = [
@@ -12,6 +13,10 @@ probs = [
     ]
 boards = 250 # Number of boards at each density
 n = 25 # Dimenstion of each board
+archive = None # Path to a CNF archive written by regExEncoding -a (None reads one file per board)
+
+if archive is not None:
+    archiveData = openArchive(archive)
 
 # These are for bookkeeping
 conflicts = [] # we actually track propagations
@@ -23,20 +28,14 @@ for p in range(1,21): # There are 20 puzzle densities to process, and they are 1
     print(f"Density: {probs[p-1]}")
     for b in tqdm(range(boards)):
         t1 = time()
-        f1 = CNF(from_file=f'/Users/aaronfoote/COURSES/Krizanc-Tutorials/Senior-Spring/General-Inferability/{n}x{n}/{p} {b}.cnf') # change this file path
-        with Glucose42(bootstrap_with = f1) as m:
-            inferred = 0
-            clauses.append(m.nof_clauses()) # Note the number of clauses
-            """
-            For each cell in the board, determine whether an inference is possible by assuming the cell is empty and testing
-            the board for consistency under that assumption.
-            """
-            for i in range(1,n*n+1):
-                if not m.solve(assumptions = [-i]):
-                    inferred += 1 
-            stats = m.accum_stats()
-            conflicts.append(stats['propagations'])
-            alphas.append(inferred)
+        if archive is None:
+            f1 = readFile(f'/Users/aaronfoote/COURSES/Krizanc-Tutorials/Senior-Spring/General-Inferability/{n}x{n}/{p} {b}.cnf') # change this file path (.cnfb for regExEncoding -b)
+        else:
+            f1 = readFormula(archiveData, (p, b))
+        clauses.append(len(f1.clauses)) # Note the number of clauses
+        seconds, inferred, propagations = inference(f1, n) # The per-cell inference loop (see cnfArchive.py)
+        conflicts.append(propagations)
+        alphas.append(inferred)
         averageTimes.append(time() - t1)
 
 # Bookkeep
@@ -0,0 +1,730 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <stdatomic.h>
+
+// gcc -O2 -I../encoding -o pipeline pipeline.c ../encoding/nonogram.c ../encoding/sink.c ../encoding/arena.c ../encoding/linecache.c ../encoding/linesolve.c ../encoding/eliminate.c ../encoding/layout.c ../encoding/cardinality.c ../encoding/stream.c ../encoding/formula.c ../encoding/dnf.c ../encoding/solver.c ../encoding/queue.c ../encoding/stats.c ../encoding/trace.c ../encoding/mtwister.c -lm -lpthread
+
+#include "nonogram.h"
+#include "linecache.h"
+#include "cardinality.h"
+#include "formula.h"
+#include "dnf.h"
+#include "solver.h"
+#include "queue.h"
+#include "trace.h"
+
+#define DEFAULT_SIZE 25 // The size of the board when none is given with -n (phaseTransition.py's)
+#define DEFAULT_BOARDS 250 // The boards at each density when none is given with -b (phaseTransition.py's)
+#define DEFAULT_DEPTH 16 // How many boards each queue holds when none is given with -q
+#define DENSITIES 20 // The densities of the fixed sweep, 0.03 to 0.60 (the first 20 of regExEncoding's sweep, as in phaseTransition.py)
+#define COARSE_SHARE 4 // The adaptive sweep spends 1/COARSE_SHARE of its budget on its coarse pass
+#define MIN_SPACING 0.005 // The narrowest density interval the adaptive sweep splits in two
+#define FIRST_BOARDS 20 // The boards each density gets before the stopping rule of -w is first checked
+#define NEXT_BOARDS 10 // The boards a density gets each round while its intervals are too wide
+#define Z 1.96 // The normal quantile of the 95% confidence intervals
+#define SEED 32 // regExEncoding's sweep seed, so the boards are the ones its multithreaded sweep writes
+#define SCRATCH_SIZE (1 << 16) // Initial size of each arena, which grows to fit the largest board
+#define CACHE_LITERALS (1 << 22) // Template literals each encoder's line cache holds before it is emptied
+#define TRACE_FILE "pipelineTrace.json" // Where a build with -DTRACE writes its timeline (see trace.h)
+
+/*
+The phase transition sweep as one program: boards are generated, encoded and solved by three
+stages of threads running at once, each passing its boards to the next through a bounded queue
+(see queue.h), and only the CSV of results is written. It does in memory what regExEncoding.c
+and phaseTransition.py do through a directory of CNF files: the boards are the ones of
+regExEncoding's multithreaded sweep (every board has its own random stream, see boardSeed), each
+formula is the one it writes with the same options (see formula.h), and each board is solved the
+way phaseTransition.py solves it (see solver.h), with its CSV columns.
+
+When a stage gets ahead, its queue fills up and its threads wait for the stage after it, so no
+more than the queues' worth of boards and formulae are ever in memory. Solving takes by far the
+longest, so most threads should go to it.
+
+The boards are solved in passes, each a list of (density, board) pairs run through the three
+stages. The fixed sweep is one pass over the 20 densities of phaseTransition.py. The adaptive
+sweep (-a budget) starts with a coarse pass over every density of regExEncoding's sweep, then
+spends the rest of its budget a round at a time where the inferred fraction of the filled cells
+(alpha/(N*N*density), as in the R script) changes the most between neighbouring densities: it
+adds a density halfway between the two (unless they are already closer than MIN_SPACING) and
+more boards at both, so the grid and the sample counts fill in around the phase transition and
+the flat ends of the curve keep just their coarse boards.
+
+The sequential sweep (-w width) stops each density of the fixed sweep once it has enough boards
+instead of after a set number: a density starts with FIRST_BOARDS and gets NEXT_BOARDS more each
+round until the 95% confidence interval on its mean inferred fraction is narrower than width and
+the one on its mean clause count is narrower than width times the mean (or it reaches the -b
+boards). The flat ends of the curve have almost no variance and stop at once, so the boards go
+to the densities around the transition. The boards and final interval widths of each density are
+printed and written to a second CSV file.
+*/
+
+typedef struct job job ;
+typedef struct result result ;
+typedef struct point point ;
+typedef struct record record ;
+typedef struct pipeline pipeline ;
+
+/*
+One board on its way through the pipeline. Each field:
+
+    slot --> the record of the board, where its result goes
+    board --> the bit packed board, until it is encoded
+    arena --> where its formula is, until it is solved
+    formula --> its formula
+*/
+struct job {
+    int slot ;
+    uint64_t * board ;
+    Arena * arena ;
+    cnfFormula formula ;
+} ;
+
+/*
+What solving a board found, as phaseTransition.py writes it. Each field:
+
+    alpha --> the number of cells inferred (the formula with the cell assumed empty has no solution)
+    propagations --> the solver's propagations (the conflicts column of phaseTransition.py's CSV)
+    clauses --> the formula's clause count
+    seconds --> the time taken to load the formula and solve for every cell
+*/
+struct result {
+    int alpha ;
+    long propagations ;
+    int clauses ;
+    double seconds ;
+} ;
+
+/*
+A density of the sweep. Its index is the density index its boards are seeded with (see boardSeed),
+so the points of the fixed sweep and the coarse pass have the boards of regExEncoding's sweep. Each
+field:
+
+    density --> the filled cell density
+    boards --> the number of boards given to it so far, which numbers the next one
+    fractionSum, fractionSquares --> the sum of the inferred fractions of its solved boards, and of their squares
+    clauseSum, clauseSquares --> the same for their clause counts
+*/
+struct point {
+    float density ;
+    int boards ;
+    double fractionSum ;
+    double fractionSquares ;
+    double clauseSum ;
+    double clauseSquares ;
+} ;
+
+// A board of a pass: the index of its point, its number there and, once solved, its result
+struct record {
+    int point ;
+    int b ;
+    result r ;
+} ;
+
+/*
+The state shared by the stages. Each field:
+
+    size --> the size of the boards
+    threads --> the threads of each stage (generators, encoders, solvers)
+    depth --> how many boards each queue holds
+    digits --> the decimal places of the densities in the CSV
+    encoding, presolve, cardinality --> how each board is encoded (as regExEncoding's -p, -e, -l, -s, -c and -C, or with -d the DNF encoding of dnf.h)
+    caches, scratch --> the line cache and scratch arena of each encoder, kept from one pass to the next
+    points, pointCount, pointCapacity --> the densities of the sweep
+    records, recordCount, recordCapacity --> every board of the sweep, in the order they were given
+    solvedCount --> the records solved by earlier passes, so the pass runs the ones after them
+    nextBoard --> the next record of the pass for a generator
+    nextEncoder --> the next encoder's index into caches and scratch
+    remaining --> the boards of the pass left to solve at each point
+    generated --> the queue of boards from the generators to the encoders
+    encoded --> the queue of formulae from the encoders to the solvers
+*/
+struct pipeline {
+    int size ;
+    int threads[3] ;
+    int depth ;
+    int digits ;
+    const lineEncoding * encoding ;
+    bool presolve ;
+    int cardinality ;
+    LineCache ** caches ;
+    Arena ** scratch ;
+    point * points ;
+    int pointCount ;
+    int pointCapacity ;
+    record * records ;
+    int recordCount ;
+    int recordCapacity ;
+    int solvedCount ;
+    atomic_int nextBoard ;
+    atomic_int nextEncoder ;
+    atomic_int * remaining ;
+    BoundedQueue * generated ;
+    BoundedQueue * encoded ;
+} ;
+
+/*
+generateWorker, encodeWorker, solveWorker: pipeline * -> NULL
+The threads of the three stages. A generator fills the next board of the pass and queues it, an
+encoder encodes the next queued board into a formula in the board's own arena, and a solver
+solves the next queued formula for every cell and keeps the result. Each stage says it is done
+with its queue once it runs out of boards, which lets the next stage finish.
+*/
+void * generateWorker(void * arg) ;
+void * encodeWorker(void * arg) ;
+void * solveWorker(void * arg) ;
+
+/*
+addPoint: pipeline * x float -> int
+addPoint(p,d) adds the density d to the sweep p. Returns its index.
+
+addBoards: pipeline * x int x int -> void
+addBoards(p,i,count) gives count more boards to the point i of p, to be solved by the next pass.
+
+runPass: pipeline * -> void
+runPass(p) solves every board given since the last pass, with the threads of p.
+*/
+int addPoint(pipeline * p, float d) ;
+void addBoards(pipeline * p, int i, int count) ;
+void runPass(pipeline * p) ;
+
+/*
+adaptiveSweep: pipeline * x int -> void
+adaptiveSweep(p,budget) runs the adaptive sweep described above with budget boards in all.
+*/
+void adaptiveSweep(pipeline * p, int budget) ;
+
+/*
+sequentialSweep: pipeline * x int x double -> void
+sequentialSweep(p,cap,width) runs the sequential sweep described above, with at most cap boards at
+each density and the target interval width.
+*/
+void sequentialSweep(pipeline * p, int cap, double width) ;
+
+/*
+solveBoard: cnfFormula * x int -> result
+solveBoard(f,N) = r, what solving the formula f of an N*N board for every cell finds
+*/
+result solveBoard(const cnfFormula * f, int N) ;
+
+/*
+meanFraction: pipeline * x int -> double
+meanFraction(p,i) = the mean inferred fraction of the boards solved at point i of p
+*/
+double meanFraction(const pipeline * p, int i) ;
+
+/*
+intervalWidth: double x double x int -> double
+intervalWidth(sum,squares,n) = the width of the 95% confidence interval on the mean of n values
+with the given sum and sum of squares
+*/
+double intervalWidth(double sum, double squares, int n) ;
+
+/*
+writeSummary: pipeline * x const char * -> int
+writeSummary(p,path) writes the boards, means and interval widths of each density of p to the
+CSV file at path, and prints them. Returns 0, or 1 if the file could not be written.
+*/
+int writeSummary(pipeline * p, const char * path) ;
+
+/*
+writeResults: pipeline * x const char * -> int
+writeResults(p,path) writes the results of p to the CSV file at path in phaseTransition.py's
+columns, sorted by density and then board. Returns 0, or 1 if the file could not be written.
+*/
+int writeResults(pipeline * p, const char * path) ;
+
+double seconds(void) ;
+
+int main(int argc, char ** argv){
+    int N = DEFAULT_SIZE ;
+    int boards = DEFAULT_BOARDS ;
+    int budget = 0 ;
+    double width = 0.0 ;
+    int depth = DEFAULT_DEPTH ;
+    int threads[3] = {1,1,1} ; // generators, encoders, solvers
+    const char * output = NULL ;
+    bool pruned = false ;
+    bool dnf = false ;
+    bool eliminate = false ;
+    bool positional = false ;
+    bool presolve = false ;
+    int cardinality = 0 ;
+    int opt ;
+    while ((opt = getopt(argc,argv,"n:b:a:w:t:q:o:pdelscC")) != -1){
+        switch (opt){
+            case 'n':
+                N = atoi(optarg) ;
+                break ;
+            case 'b':
+                boards = atoi(optarg) ;
+                break ;
+            case 'a':
+                budget = atoi(optarg) ;
+                if (budget < 1){
+                    fprintf(stderr,"-a takes the number of boards the adaptive sweep solves in all\n") ;
+                    return 1 ;
+                }
+                break ;
+            case 'w':
+                width = atof(optarg) ;
+                if (width <= 0.0){
+                    fprintf(stderr,"-w takes the width the confidence intervals of each density have to get below\n") ;
+                    return 1 ;
+                }
+                break ;
+            case 't':
+                if (sscanf(optarg,"%d,%d,%d",&threads[0],&threads[1],&threads[2]) != 3){
+                    fprintf(stderr,"-t takes the threads of each stage as generators,encoders,solvers (e.g. -t 1,2,8)\n") ;
+                    return 1 ;
+                }
+                break ;
+            case 'q':
+                depth = atoi(optarg) ;
+                break ;
+            case 'o':
+                output = optarg ;
+                break ;
+            case 'p':
+                pruned = true ;
+                break ;
+            case 'd':
+                dnf = true ;
+                break ;
+            case 'e':
+                eliminate = true ;
+                break ;
+            case 'l':
+                positional = true ;
+                break ;
+            case 's':
+                presolve = true ;
+                break ;
+            case 'c':
+                cardinality |= CARDINALITY_LINES ;
+                break ;
+            case 'C':
+                cardinality |= CARDINALITY_BOARD ;
+                break ;
+            default:
+                fprintf(stderr,"usage: %s [-n size] [-b boards] [-a budget | -w width] [-t generators,encoders,solvers] [-q depth] [-o output.csv] [-p | -d] [-e] [-l] [-s] [-c] [-C]\n",argv[0]) ;
+                return 1 ;
+        }
+    }
+    if (budget > 0 && width > 0.0){
+        fprintf(stderr,"-a and -w are different sweeps, give one or the other\n") ;
+        return 1 ;
+    }
+    if (N < 1 || boards < 1 || depth < 1 || threads[0] < 1 || threads[1] < 1 || threads[2] < 1){
+        fprintf(stderr,"The board size, boards, queue depth and threads must all be positive\n") ;
+        return 1 ;
+    }
+    if (dnf && (pruned || eliminate || N > 64)){
+        fprintf(stderr,"-d (the DNF encoding, see dnf.h) has no automaton to prune or transitions to eliminate, and only takes boards of up to 64x64\n") ;
+        return 1 ;
+    }
+    char defaultOutput[64] ;
+    if (output == NULL){
+        snprintf(defaultOutput,sizeof(defaultOutput),budget > 0 ? "adaptiveInference%dx%d.csv" : "filledInference%dx%d.csv",N,N) ; // phaseTransition.py's file name
+        output = defaultOutput ;
+    }
+    lineEncoding layout = *(dnf ? &dnfEncoding
+                            : eliminate ? (pruned ? &prunedEliminatedEncoding : &eliminatedEncoding)
+                                        : (pruned ? &prunedEncoding : &automatonEncoding)) ;
+    layout.positional = positional ;
+
+    pipeline p = {0} ;
+    p.size = N ;
+    memcpy(p.threads,threads,sizeof(threads)) ;
+    p.depth = depth ;
+    p.digits = budget > 0 ? 4 : 2 ; // The adaptive sweep halves the 0.03 steps
+    p.encoding = &layout ;
+    p.presolve = presolve ;
+    p.cardinality = cardinality ;
+    p.caches = malloc(threads[1]*sizeof(LineCache *)) ;
+    p.scratch = malloc(threads[1]*sizeof(Arena *)) ;
+    for (int i = 0 ; i < threads[1] ; i++){
+        p.caches[i] = linecache_new(&layout,CACHE_LITERALS) ;
+        p.scratch[i] = arena_new(SCRATCH_SIZE) ;
+    }
+
+    TRACE_OPEN(TRACE_FILE) ; // Written when the program exits
+    if (budget > 0){
+        adaptiveSweep(&p,budget) ;
+    } else if (width > 0.0){
+        sequentialSweep(&p,boards,width) ;
+    } else {
+        // The same densities as regExEncoding's sweep, accumulated the same way so the boards match
+        float d = 0.03 ;
+        for (int i = 0 ; i < DENSITIES ; i++){
+            addBoards(&p,addPoint(&p,d),boards) ;
+            d = d + 0.03 ;
+        }
+        runPass(&p) ;
+    }
+
+    int status = writeResults(&p,output) ;
+    if (width > 0.0){
+        // Named after the output, so runs with different -o keep their own summaries
+        size_t stem = strlen(output) ;
+        if (stem >= 4 && strcmp(output + stem - 4,".csv") == 0){
+            stem -= 4 ;
+        }
+        char * summary = malloc(stem + sizeof("Summary.csv")) ;
+        memcpy(summary,output,stem) ;
+        strcpy(summary + stem,"Summary.csv") ;
+        status |= writeSummary(&p,summary) ;
+        free(summary) ;
+    }
+    for (int i = 0 ; i < threads[1] ; i++){
+        linecache_free(p.caches[i]) ;
+        arena_free(p.scratch[i]) ;
+    }
+    free(p.caches) ;
+    free(p.scratch) ;
+    free(p.points) ;
+    free(p.records) ;
+    return status ;
+}
+
+int addPoint(pipeline * p, float d){
+    if (p->pointCount == p->pointCapacity){
+        p->pointCapacity = p->pointCapacity ? 2*p->pointCapacity : 64 ;
+        p->points = realloc(p->points,p->pointCapacity*sizeof(point)) ;
+    }
+    point * pt = &p->points[p->pointCount] ;
+    pt->density = d ;
+    pt->boards = 0 ;
+    pt->fractionSum = 0.0 ;
+    pt->fractionSquares = 0.0 ;
+    pt->clauseSum = 0.0 ;
+    pt->clauseSquares = 0.0 ;
+    p->pointCount += 1 ;
+    return p->pointCount - 1 ;
+}
+
+void addBoards(pipeline * p, int i, int count){
+    if (p->recordCount + count > p->recordCapacity){
+        while (p->recordCount + count > p->recordCapacity){
+            p->recordCapacity = p->recordCapacity ? 2*p->recordCapacity : 1024 ;
+        }
+        p->records = realloc(p->records,p->recordCapacity*sizeof(record)) ;
+    }
+    for (int k = 0 ; k < count ; k++){
+        record * r = &p->records[p->recordCount] ;
+        r->point = i ;
+        r->b = p->points[i].boards ;
+        p->points[i].boards += 1 ;
+        p->recordCount += 1 ;
+    }
+    return ;
+}
+
+void runPass(pipeline * p){
+    if (p->solvedCount == p->recordCount){
+        return ;
+    }
+    atomic_store(&p->nextBoard,p->solvedCount) ;
+    atomic_store(&p->nextEncoder,0) ;
+    p->remaining = malloc(p->pointCount*sizeof(atomic_int)) ;
+    for (int i = 0 ; i < p->pointCount ; i++){
+        atomic_init(&p->remaining[i],0) ;
+    }
+    for (int k = p->solvedCount ; k < p->recordCount ; k++){
+        atomic_fetch_add(&p->remaining[p->records[k].point],1) ;
+    }
+    p->generated = queue_new(p->depth,p->threads[0]) ;
+    p->encoded = queue_new(p->depth,p->threads[1]) ;
+
+    void * (*stages[3])(void *) = {generateWorker,encodeWorker,solveWorker} ;
+    pthread_t * workers = malloc((p->threads[0] + p->threads[1] + p->threads[2])*sizeof(pthread_t)) ;
+    int started = 0 ;
+    for (int stage = 0 ; stage < 3 ; stage++){
+        for (int i = 0 ; i < p->threads[stage] ; i++){
+            if (pthread_create(&workers[started],NULL,stages[stage],p) != 0){
+                fprintf(stderr,"Could not start the pipeline's threads\n") ;
+                exit(1) ;
+            }
+            started += 1 ;
+        }
+    }
+    for (int i = 0 ; i < started ; i++){
+        pthread_join(workers[i],NULL) ;
+    }
+    free(workers) ;
+    queue_free(p->generated) ;
+    queue_free(p->encoded) ;
+    free(p->remaining) ;
+
+    for (int k = p->solvedCount ; k < p->recordCount ; k++){
+        const record * r = &p->records[k] ;
+        point * pt = &p->points[r->point] ;
+        const double fraction = r->r.alpha/(p->size*p->size*pt->density) ;
+        pt->fractionSum += fraction ;
+        pt->fractionSquares += fraction*fraction ;
+        pt->clauseSum += r->r.clauses ;
+        pt->clauseSquares += (double) r->r.clauses*r->r.clauses ;
+    }
+    p->solvedCount = p->recordCount ;
+    return ;
+}
+
+void adaptiveSweep(pipeline * p, int budget){
+    // The coarse pass: every density of regExEncoding's sweep, accumulated the same way so the boards match
+    for (float d = 0.03 ; d < 1.0 ; d = d + 0.03){
+        addPoint(p,d) ;
+    }
+    int round = budget / (COARSE_SHARE*p->pointCount) ;
+    if (round < 2){
+        round = 2 ;
+    }
+    for (int i = 0 ; i < p->pointCount ; i++){
+        addBoards(p,i,round) ;
+    }
+    runPass(p) ;
+
+    int * order = NULL ;
+    while (p->recordCount < budget){
+        // The points by density, to find the neighbours whose inferred fractions differ the most
+        order = realloc(order,p->pointCount*sizeof(int)) ;
+        for (int i = 0 ; i < p->pointCount ; i++){
+            int k = i ;
+            while (k > 0 && p->points[order[k-1]].density > p->points[i].density){
+                order[k] = order[k-1] ;
+                k -= 1 ;
+            }
+            order[k] = i ;
+        }
+        int steepest = 0 ;
+        double change = -1.0 ;
+        for (int k = 0 ; k + 1 < p->pointCount ; k++){
+            double c = fabs(meanFraction(p,order[k+1]) - meanFraction(p,order[k])) ;
+            if (c > change){
+                change = c ;
+                steepest = k ;
+            }
+        }
+        int lower = order[steepest] ;
+        int upper = order[steepest+1] ;
+        int left = budget - p->recordCount ;
+        if (p->points[upper].density - p->points[lower].density > MIN_SPACING){
+            int middle = addPoint(p,(p->points[lower].density + p->points[upper].density)/2) ;
+            addBoards(p,middle,left < round ? left : round) ;
+            left = budget - p->recordCount ;
+        }
+        addBoards(p,lower,left < round ? left : round) ;
+        left = budget - p->recordCount ;
+        addBoards(p,upper,left < round ? left : round) ;
+        runPass(p) ;
+        printf("%d of %d boards, steepest between %.4f and %.4f\n",p->recordCount,budget,p->points[lower].density,p->points[upper].density) ;
+    }
+    free(order) ;
+    return ;
+}
+
+void sequentialSweep(pipeline * p, int cap, double width){
+    // The same densities as regExEncoding's sweep, accumulated the same way so the boards match
+    float d = 0.03 ;
+    for (int i = 0 ; i < DENSITIES ; i++){
+        addBoards(p,addPoint(p,d),FIRST_BOARDS < cap ? FIRST_BOARDS : cap) ;
+        d = d + 0.03 ;
+    }
+    runPass(p) ;
+    while (true){
+        int open = 0 ;
+        for (int i = 0 ; i < p->pointCount ; i++){
+            const point * pt = &p->points[i] ;
+            if (pt->boards >= cap){
+                continue ;
+            }
+            bool fractionWide = intervalWidth(pt->fractionSum,pt->fractionSquares,pt->boards) >= width ;
+            bool clausesWide = intervalWidth(pt->clauseSum,pt->clauseSquares,pt->boards) >= width*pt->clauseSum/pt->boards ;
+            if (fractionWide || clausesWide){
+                addBoards(p,i,cap - pt->boards < NEXT_BOARDS ? cap - pt->boards : NEXT_BOARDS) ;
+                open += 1 ;
+            }
+        }
+        if (open == 0){
+            break ;
+        }
+        runPass(p) ;
+        printf("%d boards, %d densities still sampling\n",p->recordCount,open) ;
+    }
+    return ;
+}
+
+void * generateWorker(void * arg){
+    pipeline * p = arg ;
+    TRACE_THREAD("generator") ;
+    while (true){
+        int slot = atomic_fetch_add(&p->nextBoard,1) ;
+        if (slot >= p->recordCount){
+            break ;
+        }
+        const record * r = &p->records[slot] ;
+        job * j = malloc(sizeof(job)) ;
+        j->slot = slot ;
+        j->board = malloc(p->size*boardWords(p->size)*sizeof(uint64_t)) ;
+        MTRand seed = seedRand(boardSeed(SEED,r->point,r->b)) ;
+        TRACE_BOARD(r->point,r->b) ;
+        TRACE_START(filling) ;
+        fillBoard(j->board,p->size,p->points[r->point].density,&seed) ;
+        TRACE_SPAN(filling,"generate") ;
+        queue_push(p->generated,j) ;
+    }
+    queue_done(p->generated) ;
+    return NULL ;
+}
+
+void * encodeWorker(void * arg){
+    pipeline * p = arg ;
+    int index = atomic_fetch_add(&p->nextEncoder,1) ;
+    Arena * scratch = p->scratch[index] ;
+    LineCache * cache = p->caches[index] ;
+    TRACE_THREAD("encoder") ;
+    job * j ;
+    while ((j = queue_pop(p->generated)) != NULL){
+        TRACE_BOARD(p->records[j->slot].point,p->records[j->slot].b) ;
+        TRACE_START(encoding) ;
+        j->arena = arena_new(SCRATCH_SIZE) ;
+        if (!formula_board(j->board,p->size,p->presolve,p->cardinality,cache,&j->formula,j->arena,scratch)){
+            const record * r = &p->records[j->slot] ;
+            fprintf(stderr,"The formula of board %d at density %.*f has too many variables or clauses for an int\n",r->b,p->digits,p->points[r->point].density) ;
+            exit(1) ;
+        }
+        arena_reset(scratch) ;
+        free(j->board) ;
+        j->board = NULL ;
+        TRACE_SPAN(encoding,"encode") ;
+        queue_push(p->encoded,j) ;
+    }
+    queue_done(p->encoded) ;
+    return NULL ;
+}
+
+void * solveWorker(void * arg){
+    pipeline * p = arg ;
+    TRACE_THREAD("solver") ;
+    job * j ;
+    while ((j = queue_pop(p->encoded)) != NULL){
+        record * r = &p->records[j->slot] ;
+        TRACE_BOARD(r->point,r->b) ;
+        TRACE_START(solving) ;
+        r->r = solveBoard(&j->formula,p->size) ;
+        TRACE_SPAN(solving,"solve") ;
+        if (atomic_fetch_sub(&p->remaining[r->point],1) == 1){
+            printf("%.*f\n",p->digits,p->points[r->point].density) ;
+        }
+        arena_free(j->arena) ;
+        free(j) ;
+    }
+    return NULL ;
+}
+
+result solveBoard(const cnfFormula * f, int N){
+    result r ;
+    double start = seconds() ;
+    Solver * solver = solver_new(f) ;
+    r.alpha = 0 ;
+    /*
+    For each cell in the board, determine whether an inference is possible by assuming the cell is empty and testing
+    the board for consistency under that assumption.
+    */
+    for (int i = 1 ; i <= N*N ; i++){
+        int empty = -i ;
+        if (!solver_solve(solver,&empty,1)){
+            r.alpha += 1 ;
+        }
+    }
+    r.propagations = solver_propagations(solver) ;
+    r.clauses = f->clauses ;
+    solver_free(solver) ;
+    r.seconds = seconds() - start ;
+    return r ;
+}
+
+double meanFraction(const pipeline * p, int i){
+    const point * pt = &p->points[i] ;
+    return pt->boards > 0 ? pt->fractionSum/pt->boards : 0.0 ;
+}
+
+double intervalWidth(double sum, double squares, int n){
+    if (n < 2){
+        return INFINITY ;
+    }
+    const double mean = sum/n ;
+    double variance = (squares - n*mean*mean)/(n - 1) ;
+    if (variance < 0.0){
+        variance = 0.0 ; // Rounding, when every value is the same
+    }
+    return 2*Z*sqrt(variance/n) ;
+}
+
+int writeSummary(pipeline * p, const char * path){
+    FILE * fp = fopen(path,"w") ;
+    if (fp == NULL){
+        perror(path) ;
+        return 1 ;
+    }
+    fprintf(fp,"density,boards,fraction,fractionWidth,clauses,clauseWidth\n") ;
+    printf("%8s %7s %9s %9s %10s %10s\n","density","boards","fraction","width","clauses","width") ;
+    for (int i = 0 ; i < p->pointCount ; i++){
+        const point * pt = &p->points[i] ;
+        const double fractionWidth = intervalWidth(pt->fractionSum,pt->fractionSquares,pt->boards) ;
+        const double clauseWidth = intervalWidth(pt->clauseSum,pt->clauseSquares,pt->boards) ;
+        fprintf(fp,"%.*f,%d,%f,%f,%f,%f\n",p->digits,pt->density,pt->boards,meanFraction(p,i),fractionWidth,pt->clauseSum/pt->boards,clauseWidth) ;
+        printf("%8.*f %7d %9.4f %9.4f %10.1f %10.1f\n",p->digits,pt->density,pt->boards,meanFraction(p,i),fractionWidth,pt->clauseSum/pt->boards,clauseWidth) ;
+    }
+    fclose(fp) ;
+    return 0 ;
+}
+
+// The records in CSV order, by density and then board
+typedef struct csvKey {
+    float density ;
+    int b ;
+    int slot ;
+} csvKey ;
+
+int compareKeys(const void * a, const void * b){
+    const csvKey * x = a ;
+    const csvKey * y = b ;
+    if (x->density != y->density){
+        return x->density < y->density ? -1 : 1 ;
+    }
+    return x->b - y->b ;
+}
+
+int writeResults(pipeline * p, const char * path){
+    FILE * fp = fopen(path,"w") ;
+    if (fp == NULL){
+        perror(path) ;
+        return 1 ;
+    }
+    csvKey * keys = malloc(p->recordCount*sizeof(csvKey)) ;
+    for (int k = 0 ; k < p->recordCount ; k++){
+        keys[k].density = p->points[p->records[k].point].density ;
+        keys[k].b = p->records[k].b ;
+        keys[k].slot = k ;
+    }
+    qsort(keys,p->recordCount,sizeof(csvKey),compareKeys) ;
+    fprintf(fp,"density,board,alpha,conflicts,clauses,timeTaken\n") ;
+    for (int k = 0 ; k < p->recordCount ; k++){
+        const record * r = &p->records[keys[k].slot] ;
+        fprintf(fp,"%.*f,%d,%d,%ld,%d,%f\n",p->digits,keys[k].density,r->b,r->r.alpha,r->r.propagations,r->r.clauses,r->r.seconds) ;
+    }
+    free(keys) ;
+    fclose(fp) ;
+    return 0 ;
+}
+
+double seconds(void){
+    struct timespec t ;
+    clock_gettime(CLOCK_MONOTONIC,&t) ;
+    return t.tv_sec + t.tv_nsec*1e-9 ;
+}
@@ -0,0 +1,450 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+// gcc -O2 -I../encoding -o scalingBenchmark scalingBenchmark.c ../encoding/nonogram.c ../encoding/sink.c ../encoding/arena.c ../encoding/linecache.c ../encoding/eliminate.c ../encoding/layout.c ../encoding/cardinality.c ../encoding/linesolve.c ../encoding/stream.c ../encoding/stats.c ../encoding/trace.c ../encoding/mtwister.c -lm
+
+#include "nonogram.h"
+#include "linecache.h"
+#include "stream.h"
+
+#define DEFAULT_LINES 20 // The random lines at each size and density when none is given with -l
+#define SEED 32 // regExEncoding's sweep seed, so the boards are the ones its multithreaded sweep writes
+#define SCRATCH_SIZE (1 << 16) // Initial size of each arena, which grows to fit the largest line
+#define CACHE_LITERALS (1 << 22) // Template literals the line cache of the board checks holds before it is emptied
+#define MAX_REPORTED 20 // The mismatches printed in full (every one is counted)
+
+/*
+A check of the closed form counts of the automaton encoding against the formulae it actually
+writes, and of how encoding time and formula size grow with the line length. The DIMACS header of
+a formula is written from these counts before any clause exists (stream.c sums them over the
+lines of the board), so a count that is off means a header that does not match its formula.
+
+For every size of SIZES, lines of each shape below are encoded on their own, with buildConstraint
+and with buildPrunedConstraint, into a recording sink. For each line the clauses written are
+checked against what the builder returned and against clauseCount (prunedClauseCount), the fresh
+variables it took against uniqueVarCount (prunedVarCount), which is what the header counts, and
+for the full form the literals written against formulaVarCount. Every literal must be a cell of
+the line or one of the fresh variables taken, and every fresh variable must appear in some clause.
+The shapes go from sparse to dense:
+
+    sparse --> N/10 runs of one cell
+    half --> one run over half of the line
+    blocks --> runs of three cells with one cell between them, as many as fit
+    ones --> runs of one cell with one cell between them, as many as fit
+    full --> one run over the whole line
+    random p --> -l lines with each cell filled with probability p, for p in DENSITIES
+
+Then a board at each size and density of DENSITIES (the first board of regExEncoding's
+multithreaded sweep there) is streamed with stream_board, for both encodings, into a sink that
+only checks the formula: its header must hold the clauses written and the largest variable in
+them, and no literal may be 0 or past the header's variables.
+
+Each row of the CSV (-o, scalingBenchmark.csv by default) is one size, shape and encoding: the
+lines (or boards) encoded, the mean clauses, fresh variables and literals of each, its mean
+encoding time in nanoseconds, the bytes of the formula in memory (as a recording sink holds it,
+an int for each literal and each clause) and the mismatches. The program exits with 1 if there
+were any, after printing the first MAX_REPORTED.
+*/
+
+static const int SIZES[] = {5, 10, 15, 20, 25, 30, 40, 50, 75, 100, 150, 200} ;
+static const float DENSITIES[] = {0.1, 0.3, 0.5, 0.7, 0.9} ;
+#define SIZE_COUNT ((int) (sizeof(SIZES)/sizeof(SIZES[0])))
+#define DENSITY_COUNT ((int) (sizeof(DENSITIES)/sizeof(DENSITIES[0])))
+
+typedef struct encoding {
+    const char * name ;
+    const lineEncoding * line ;
+    bool literals ; // whether formulaVarCount counts its literals (it is only for the full form)
+} encoding ;
+
+static const encoding ENCODINGS[] = {
+    {"automaton", &automatonEncoding, true},
+    {"pruned", &prunedEncoding, false},
+} ;
+#define ENCODING_COUNT ((int) (sizeof(ENCODINGS)/sizeof(ENCODINGS[0])))
+
+/*
+What a row of the CSV adds up. Each field:
+    lines --> the lines (or boards) encoded
+    clauses, vars, literals --> their clauses, fresh variables (all variables for a board) and literals
+    nanoseconds --> the time taken to encode them
+    bytes --> the size of their formulae as a recording sink holds them
+    mismatches --> the counts that did not match
+*/
+typedef struct totals {
+    long lines ;
+    int64_t clauses ;
+    int64_t vars ;
+    int64_t literals ;
+    uint64_t nanoseconds ;
+    uint64_t bytes ;
+    long mismatches ;
+} totals ;
+
+static long mismatches = 0 ;
+
+/*
+mismatch: const char * x int x const char * x const description * x const char * x int64_t x int64_t -> void
+mismatch(e,N,s,d,what,predicted,actual) counts a mismatch of what in a line (d non-NULL) or board of size
+N, printing it if it is one of the first MAX_REPORTED
+*/
+void mismatch(const char * encodingName, int N, const char * shape, const description * d, const char * what, int64_t predicted, int64_t actual) ;
+
+/*
+checkLine: const encoding * x const description * x int x int * x ClauseSink * x Arena * x int ** x int * x const char * x totals * -> void
+checkLine(e,d,N,vars,out,a,seen,n,shape,t) encodes the non-empty description d in a line of length N
+with e into the recording sink out, checks the formula against e's counts, and adds it to t. *seen
+is a table of *n ints marking the variables used, which is grown to fit the line.
+*/
+void checkLine(const encoding * e, const description * d, int N, int * stringVars, ClauseSink * out, Arena * scratch, int ** seen, int * seenSize, const char * shape, totals * t) ;
+
+/*
+checkBoard: const encoding * x int x int x Arena * x totals * -> void
+checkBoard(e,N,di,a,t) streams the first board of the multithreaded sweep at size N and density index di with
+e and checks its header against the formula, adding it to t
+*/
+void checkBoard(const encoding * e, int N, int densityIndex, Arena * scratch, totals * t) ;
+
+/*
+shapeDescription: const char * x int x Arena * -> description
+shapeDescription(s,N,a) = d, the description of the fixed shape named s (see above) in a line of length N
+*/
+description shapeDescription(const char * shape, int N, Arena * scratch) ;
+
+void report(FILE * fp, int N, const char * shape, const char * encodingName, const totals * t) ;
+
+uint64_t now(void){
+    struct timespec t ;
+    clock_gettime(CLOCK_MONOTONIC,&t) ;
+    return (uint64_t) t.tv_sec*1000000000u + t.tv_nsec ;
+}
+
+static const char * SHAPES[] = {"sparse", "half", "blocks", "ones", "full"} ;
+#define SHAPE_COUNT ((int) (sizeof(SHAPES)/sizeof(SHAPES[0])))
+
+int main(int argc, char ** argv){
+    int lines = DEFAULT_LINES ;
+    const char * output = "scalingBenchmark.csv" ;
+    int option ;
+    while ((option = getopt(argc,argv,"l:o:")) != -1){
+        switch (option){
+            case 'l':
+                lines = atoi(optarg) ;
+                break ;
+            case 'o':
+                output = optarg ;
+                break ;
+            default:
+                fprintf(stderr,"usage: %s [-l lines] [-o output.csv]\n",argv[0]) ;
+                return 1 ;
+        }
+    }
+    if (lines < 1){
+        fprintf(stderr,"The lines must be positive\n") ;
+        return 1 ;
+    }
+    FILE * fp = fopen(output,"w") ;
+    if (fp == NULL){
+        perror(output) ;
+        return 1 ;
+    }
+    fprintf(fp,"size,shape,encoding,lines,clauses,variables,literals,nsPerLine,bytesPerLine,mismatches\n") ;
+    printf("%5s %-14s %-10s %6s %12s %12s %12s %12s %12s %4s\n","size","shape","encoding","lines","clauses","variables","literals","ns/line","bytes/line","bad") ;
+
+    Arena * scratch = arena_new(SCRATCH_SIZE) ;
+    ClauseSink * out = sink_record() ;
+    int * seen = NULL ;
+    int seenSize = 0 ;
+    for (int s = 0 ; s < SIZE_COUNT ; s++){
+        const int N = SIZES[s] ;
+        int * stringVars = malloc(N*sizeof(int)) ;
+        for (int j = 0 ; j < N ; j++){
+            stringVars[j] = j + 1 ;
+        }
+        for (int k = 0 ; k < SHAPE_COUNT ; k++){
+            for (int e = 0 ; e < ENCODING_COUNT ; e++){
+                totals t = {0} ;
+                description d = shapeDescription(SHAPES[k],N,scratch) ;
+                checkLine(&ENCODINGS[e],&d,N,stringVars,out,scratch,&seen,&seenSize,SHAPES[k],&t) ;
+                arena_reset(scratch) ;
+                report(fp,N,SHAPES[k],ENCODINGS[e].name,&t) ;
+            }
+        }
+        for (int di = 0 ; di < DENSITY_COUNT ; di++){
+            char shape[32] ;
+            snprintf(shape,sizeof(shape),"random %.1f",DENSITIES[di]) ;
+            for (int e = 0 ; e < ENCODING_COUNT ; e++){
+                totals t = {0} ;
+                MTRand seed = seedRand(boardSeed(SEED,di,s)) ; // The same lines for both encodings
+                for (int l = 0 ; l < lines ; l++){
+                    description d = newDescription((N + 1)/2,scratch) ;
+                    int run = 0 ;
+                    for (int j = 0 ; j <= N ; j++){
+                        if (j < N && genRand(&seed) < DENSITIES[di]){
+                            run += 1 ;
+                        } else if (run > 0){
+                            appendDescription(&d,run) ;
+                            run = 0 ;
+                        }
+                    }
+                    if (d.length > 0){
+                        checkLine(&ENCODINGS[e],&d,N,stringVars,out,scratch,&seen,&seenSize,shape,&t) ;
+                    }
+                    arena_reset(scratch) ;
+                }
+                report(fp,N,shape,ENCODINGS[e].name,&t) ;
+            }
+        }
+        for (int di = 0 ; di < DENSITY_COUNT ; di++){
+            char shape[32] ;
+            snprintf(shape,sizeof(shape),"board %.1f",DENSITIES[di]) ;
+            for (int e = 0 ; e < ENCODING_COUNT ; e++){
+                totals t = {0} ;
+                checkBoard(&ENCODINGS[e],N,di,scratch,&t) ;
+                arena_reset(scratch) ;
+                report(fp,N,shape,ENCODINGS[e].name,&t) ;
+            }
+        }
+        free(stringVars) ;
+    }
+    free(seen) ;
+    sink_free(out) ;
+    arena_free(scratch) ;
+
+    if (fclose(fp) != 0){
+        perror(output) ;
+        return 1 ;
+    }
+    if (mismatches > 0){
+        fprintf(stderr,"%ld counts did not match the formulae written\n",mismatches) ;
+        return 1 ;
+    }
+    printf("Every count matched\n") ;
+    return 0 ;
+}
+
+description shapeDescription(const char * shape, int N, Arena * scratch){
+    description d = newDescription((N + 1)/2,scratch) ;
+    if (strcmp(shape,"sparse") == 0){
+        for (int k = 0 ; k < (N >= 10 ? N/10 : 1) ; k++){
+            appendDescription(&d,1) ;
+        }
+    } else if (strcmp(shape,"half") == 0){
+        appendDescription(&d,N/2 > 0 ? N/2 : 1) ;
+    } else if (strcmp(shape,"blocks") == 0){
+        for (int k = 0 ; k < (N + 1)/4 ; k++){
+            appendDescription(&d,3) ;
+        }
+    } else if (strcmp(shape,"ones") == 0){
+        for (int k = 0 ; k < (N + 1)/2 ; k++){
+            appendDescription(&d,1) ;
+        }
+    } else {
+        appendDescription(&d,N) ;
+    }
+    return d ;
+}
+
+void checkLine(const encoding * e, const description * d, int N, int * stringVars, ClauseSink * out, Arena * scratch, int ** seen, int * seenSize, const char * shape, totals * t){
+    const long before = mismatches ;
+    sink_reset(out) ;
+    int varIndex = N + 1 ;
+    const uint64_t start = now() ;
+    nfa * n = buildNFA(d,scratch) ;
+    const int returned = e->line->build(n,stringVars,&varIndex,d,N,out,scratch) ;
+    t->nanoseconds += now() - start ;
+    const int fresh = varIndex - (N + 1) ;
+
+    // Walk the clauses written, marking the variables they use
+    if (*seenSize < N + fresh + 1){
+        *seenSize = N + fresh + 1 ;
+        *seen = realloc(*seen,*seenSize*sizeof(int)) ;
+    }
+    memset(*seen,0,(N + fresh + 1)*sizeof(int)) ;
+    const int * packed = (const int *) sink_data(out) ;
+    const size_t size = sink_size(out)/sizeof(int) ;
+    int64_t clauses = 0 ;
+    int64_t literals = 0 ;
+    bool inRange = true ;
+    for (size_t k = 0 ; k < size ; k += packed[k] + 1){
+        for (int j = 1 ; j <= packed[k] ; j++){
+            const int v = abs(packed[k + j]) ;
+            if (v < 1 || v > N + fresh){
+                inRange = false ;
+            } else {
+                (*seen)[v] = 1 ;
+            }
+        }
+        clauses += 1 ;
+        literals += packed[k] ;
+    }
+    int unused = 0 ;
+    for (int v = N + 1 ; v <= N + fresh ; v++){
+        unused += (*seen)[v] == 0 ;
+    }
+
+    if (returned != clauses){
+        mismatch(e->name,N,shape,d,"returned clauses",returned,clauses) ;
+    }
+    if (e->line->clauses(d,N) != clauses){
+        mismatch(e->name,N,shape,d,"clauses",e->line->clauses(d,N),clauses) ;
+    }
+    if (e->line->vars(d,N) != fresh){
+        mismatch(e->name,N,shape,d,"fresh variables",e->line->vars(d,N),fresh) ;
+    }
+    if (e->literals && formulaVarCount(d,N) != literals){
+        mismatch(e->name,N,shape,d,"literals",formulaVarCount(d,N),literals) ;
+    }
+    if (!inRange){
+        mismatch(e->name,N,shape,d,"literals out of range",0,1) ;
+    }
+    if (unused != 0){
+        mismatch(e->name,N,shape,d,"unused fresh variables",0,unused) ;
+    }
+
+    t->lines += 1 ;
+    t->clauses += clauses ;
+    t->vars += fresh ;
+    t->literals += literals ;
+    t->bytes += sink_size(out) ;
+    t->mismatches += mismatches - before ;
+    return ;
+}
+
+/*
+The sink the boards are streamed into, which keeps nothing of the formula: it checks each literal
+against the header and counts the clauses and literals, so a board of any size is checked in
+constant memory. Only the operations stream_board uses do anything.
+*/
+typedef struct checkSink {
+    ClauseSink sink ;
+    int64_t headerVars ;
+    int64_t headerClauses ;
+    int64_t clauses ;
+    int64_t literals ;
+    int64_t largest ; // the largest variable written
+    int64_t outOfRange ; // literals that are 0 or past the header's variables
+} checkSink ;
+
+static void checkHeader(ClauseSink * sink, int64_t vars, int64_t clauses){
+    checkSink * c = (checkSink *) sink ;
+    c->headerVars = vars ;
+    c->headerClauses = clauses ;
+}
+
+static void checkLiteral(checkSink * c, int64_t lit){
+    const int64_t v = lit < 0 ? -lit : lit ;
+    if (v == 0 || v > c->headerVars){
+        c->outOfRange += 1 ;
+    }
+    if (v > c->largest){
+        c->largest = v ;
+    }
+    c->literals += 1 ;
+}
+
+static void checkClause(ClauseSink * sink, const int * lits, int len){
+    checkSink * c = (checkSink *) sink ;
+    for (int j = 0 ; j < len ; j++){
+        checkLiteral(c,lits[j]) ;
+    }
+    c->clauses += 1 ;
+}
+
+static void checkClauses(ClauseSink * sink, const int * packed, size_t size){
+    for (size_t k = 0 ; k < size ; k += packed[k] + 1){
+        checkClause(sink,packed + k + 1,packed[k]) ;
+    }
+}
+
+static void checkLabelled(ClauseSink * sink, const int * packed, size_t size, const int64_t * label){
+    checkSink * c = (checkSink *) sink ;
+    for (size_t k = 0 ; k < size ; k += packed[k] + 1){
+        for (int j = 1 ; j <= packed[k] ; j++){
+            const int lit = packed[k + j] ;
+            checkLiteral(c,lit > 0 ? label[lit] : -label[-lit]) ;
+        }
+        c->clauses += 1 ;
+    }
+}
+
+static void checkFlush(ClauseSink * sink){
+    (void) sink ;
+}
+
+static const SinkOps checkOps = {checkHeader, checkClause, checkClauses, checkLabelled, checkFlush} ;
+
+void checkBoard(const encoding * e, int N, int densityIndex, Arena * scratch, totals * t){
+    const long before = mismatches ;
+    const int words = boardWords(N) ;
+    uint64_t * board = calloc((size_t) N*words,sizeof(uint64_t)) ;
+    uint64_t * transposed = malloc((size_t) N*words*sizeof(uint64_t)) ;
+    MTRand seed = seedRand(boardSeed(SEED,densityIndex,0)) ;
+    fillBoard(board,N,DENSITIES[densityIndex],&seed) ;
+
+    checkSink c = {0} ;
+    c.sink.ops = &checkOps ;
+    LineCache * cache = linecache_new(e->line,CACHE_LITERALS) ;
+    const uint64_t start = now() ;
+    description * rows = descriptionsFromBits(board,N,scratch) ;
+    description * columns = descriptionsFromBits(transposeBits(board,transposed,N),N,scratch) ;
+    int64_t clauses ;
+    const int64_t vars = stream_board(rows,columns,N,N,NULL,0,cache,&c.sink,&clauses,scratch) ;
+    t->nanoseconds += now() - start ;
+
+    char shape[32] ;
+    snprintf(shape,sizeof(shape),"board %.1f",DENSITIES[densityIndex]) ;
+    if (c.headerVars != vars){
+        mismatch(e->name,N,shape,NULL,"header variables",c.headerVars,vars) ;
+    }
+    if (c.headerClauses != clauses || c.headerClauses != c.clauses){
+        mismatch(e->name,N,shape,NULL,"header clauses",c.headerClauses,c.clauses) ;
+    }
+    if (c.largest != c.headerVars){
+        mismatch(e->name,N,shape,NULL,"largest variable",c.headerVars,c.largest) ;
+    }
+    if (c.outOfRange != 0){
+        mismatch(e->name,N,shape,NULL,"literals out of range",0,c.outOfRange) ;
+    }
+
+    t->lines += 1 ;
+    t->clauses += c.clauses ;
+    t->vars += vars ;
+    t->literals += c.literals ;
+    t->bytes += (uint64_t) (c.clauses + c.literals)*sizeof(int) ;
+    t->mismatches += mismatches - before ;
+    linecache_free(cache) ;
+    free(board) ;
+    free(transposed) ;
+    return ;
+}
+
+void mismatch(const char * encodingName, int N, const char * shape, const description * d, const char * what, int64_t predicted, int64_t actual){
+    mismatches += 1 ;
+    if (mismatches > MAX_REPORTED){
+        return ;
+    }
+    fprintf(stderr,"%s, size %d, %s: %s predicted %lld, written %lld",encodingName,N,shape,what,(long long) predicted,(long long) actual) ;
+    if (d != NULL){
+        fprintf(stderr," for") ;
+        for (int k = 0 ; k < d->length ; k++){
+            fprintf(stderr," %d",d->runs[k]) ;
+        }
+    }
+    fprintf(stderr,"\n") ;
+    return ;
+}
+
+void report(FILE * fp, int N, const char * shape, const char * encodingName, const totals * t){
+    const double lines = t->lines > 0 ? t->lines : 1 ;
+    fprintf(fp,"%d,%s,%s,%ld,%.1f,%.1f,%.1f,%.1f,%.1f,%ld\n",N,shape,encodingName,t->lines,t->clauses/lines,t->vars/lines,
+            t->literals/lines,t->nanoseconds/lines,t->bytes/lines,t->mismatches) ;
+    printf("%5d %-14s %-10s %6ld %12.1f %12.1f %12.1f %12.1f %12.1f %4ld\n",N,shape,encodingName,t->lines,t->clauses/lines,t->vars/lines,
+           t->literals/lines,t->nanoseconds/lines,t->bytes/lines,t->mismatches) ;
+    fflush(stdout) ;
+    return ;
+}
@@ -0,0 +1,210 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "archive.h"
+
+#define ARCHIVE_MAGIC "NGAR"
+#define ARCHIVE_FOOTER_MAGIC "NGAX"
+#define ARCHIVE_HEADER_SIZE 8
+#define ARCHIVE_FOOTER_SIZE 20
+
+struct ArchiveWriter {
+    FILE * fp ;
+    uint64_t offset ;       // where the next formula goes
+    ArchiveEntry * index ;
+    size_t count ;
+    size_t cap ;
+} ;
+
+struct ArchiveReader {
+    const char * map ;
+    size_t size ;
+    const ArchiveEntry * index ;
+    size_t count ;
+} ;
+
+static int compareEntries (const void * a, const void * b)
+{
+    const ArchiveEntry * x = a ;
+    const ArchiveEntry * y = b ;
+    if (x->density != y->density) return x->density < y->density ? -1 : 1 ;
+    if (x->board != y->board) return x->board < y->board ? -1 : 1 ;
+    return 0 ;
+}
+
+ArchiveWriter * archive_create (const char * path)
+{
+    FILE * fp = fopen(path, "wb") ;
+    if (!fp) {
+        perror(path) ;
+        return NULL ;
+    }
+
+    ArchiveWriter * archive = malloc(sizeof(ArchiveWriter)) ;
+    archive->fp = fp ;
+    archive->offset = ARCHIVE_HEADER_SIZE ;
+    archive->count = 0 ;
+    archive->cap = 1024 ;
+    archive->index = malloc(archive->cap*sizeof(ArchiveEntry)) ;
+
+    const uint32_t version = ARCHIVE_VERSION ;
+    fwrite(ARCHIVE_MAGIC, 1, 4, fp) ;
+    fwrite(&version, sizeof version, 1, fp) ;
+    return archive ;
+}
+
+void archive_add (ArchiveWriter * archive, int density, int board, const char * data, size_t len)
+{
+    if (archive->count == archive->cap) {
+        archive->cap *= 2 ;
+        archive->index = realloc(archive->index, archive->cap*sizeof(ArchiveEntry)) ;
+        if (!archive->index) {
+            fprintf(stderr, "archive_add failed\n") ;
+            exit(1) ;
+        }
+    }
+
+    ArchiveEntry * entry = &archive->index[archive->count++] ;
+    entry->density = density ;
+    entry->board = board ;
+    entry->offset = archive->offset ;
+    entry->length = len ;
+
+    if (fwrite(data, 1, len, archive->fp) != len) {
+        perror("archive_add") ;
+    }
+    archive->offset += len ;
+}
+
+void archive_finish (ArchiveWriter * archive)
+{
+    if (!archive) return ;
+
+    // Formulae can be added in any order, but the index is kept sorted for the reader
+    qsort(archive->index, archive->count, sizeof(ArchiveEntry), compareEntries) ;
+
+    // Pad so the index is 8-byte aligned in the mapped file
+    static const char zeros[8] = {0} ;
+    const size_t padding = (8 - archive->offset % 8) % 8 ;
+    fwrite(zeros, 1, padding, archive->fp) ;
+    archive->offset += padding ;
+
+    const uint64_t indexOffset = archive->offset ;
+    const uint64_t count = archive->count ;
+    fwrite(archive->index, sizeof(ArchiveEntry), archive->count, archive->fp) ;
+    fwrite(&indexOffset, sizeof indexOffset, 1, archive->fp) ;
+    fwrite(&count, sizeof count, 1, archive->fp) ;
+    fwrite(ARCHIVE_FOOTER_MAGIC, 1, 4, archive->fp) ;
+
+    if (fclose(archive->fp) != 0) {
+        perror("archive_finish") ;
+    }
+    free(archive->index) ;
+    free(archive) ;
+}
+
+const ArchiveEntry * archive_progress (ArchiveWriter * archive, size_t * count, uint64_t * offset)
+{
+    if (fflush(archive->fp) != 0) {
+        perror("archive_progress") ;
+    }
+    *count = archive->count ;
+    *offset = archive->offset ;
+    return archive->index ;
+}
+
+ArchiveWriter * archive_resume (const char * path, const ArchiveEntry * index, size_t count, uint64_t offset)
+{
+    FILE * fp = fopen(path, "r+b") ;
+    if (!fp) {
+        perror(path) ;
+        return NULL ;
+    }
+
+    char magic[4] ;
+    struct stat st ;
+    if (fread(magic, 1, 4, fp) != 4 || memcmp(magic, ARCHIVE_MAGIC, 4) || fstat(fileno(fp), &st) != 0
+        || (uint64_t) st.st_size < offset || ftruncate(fileno(fp), offset) != 0 || fseek(fp, offset, SEEK_SET) != 0) {
+        fprintf(stderr, "%s: cannot resume the archive\n", path) ;
+        fclose(fp) ;
+        return NULL ;
+    }
+
+    ArchiveWriter * archive = malloc(sizeof(ArchiveWriter)) ;
+    archive->fp = fp ;
+    archive->offset = offset ;
+    archive->count = count ;
+    archive->cap = count > 1024 ? count : 1024 ;
+    archive->index = malloc(archive->cap*sizeof(ArchiveEntry)) ;
+    memcpy(archive->index, index, count*sizeof(ArchiveEntry)) ;
+    return archive ;
+}
+
+ArchiveReader * archive_open (const char * path)
+{
+    int fd = open(path, O_RDONLY) ;
+    if (fd < 0) {
+        perror(path) ;
+        return NULL ;
+    }
+
+    struct stat st ;
+    if (fstat(fd, &st) != 0 || (size_t) st.st_size < ARCHIVE_HEADER_SIZE + ARCHIVE_FOOTER_SIZE) {
+        fprintf(stderr, "%s: not a CNF archive\n", path) ;
+        close(fd) ;
+        return NULL ;
+    }
+
+    const size_t size = st.st_size ;
+    const char * map = mmap(NULL, size, PROT_READ, MAP_SHARED, fd, 0) ;
+    close(fd) ;
+    if (map == MAP_FAILED) {
+        perror(path) ;
+        return NULL ;
+    }
+
+    const char * footer = map + size - ARCHIVE_FOOTER_SIZE ;
+    uint64_t indexOffset, count ;
+    memcpy(&indexOffset, footer, sizeof indexOffset) ;
+    memcpy(&count, footer + 8, sizeof count) ;
+
+    if (memcmp(map, ARCHIVE_MAGIC, 4) || memcmp(footer + 16, ARCHIVE_FOOTER_MAGIC, 4)
+        || indexOffset + count*sizeof(ArchiveEntry) != size - ARCHIVE_FOOTER_SIZE) {
+        fprintf(stderr, "%s: not a CNF archive\n", path) ;
+        munmap((void *) map, size) ;
+        return NULL ;
+    }
+
+    ArchiveReader * archive = malloc(sizeof(ArchiveReader)) ;
+    archive->map = map ;
+    archive->size = size ;
+    archive->index = (const ArchiveEntry *) (map + indexOffset) ;
+    archive->count = count ;
+    return archive ;
+}
+
+const char * archive_find (const ArchiveReader * archive, int density, int board, size_t * len)
+{
+    const ArchiveEntry key = {density, board, 0, 0} ;
+    const ArchiveEntry * entry = bsearch(&key, archive->index, archive->count, sizeof(ArchiveEntry), compareEntries) ;
+    if (!entry) return NULL ;
+
+    *len = entry->length ;
+    return archive->map + entry->offset ;
+}
+
+/* Accessors */
+size_t archive_count (const ArchiveReader * archive) { return archive->count ; }
+const ArchiveEntry * archive_entry (const ArchiveReader * archive, size_t i) { return &archive->index[i] ; }
+
+void archive_close (ArchiveReader * archive)
+{
+    if (!archive) return ;
+    munmap((void *) archive->map, archive->size) ;
+    free(archive) ;
+}
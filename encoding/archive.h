@@ -0,0 +1,68 @@
+#pragma once
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stddef.h>
+
+/*
+A CNF archive bundles many formulae into one file, so a sweep does not have to create (and the
+solver does not have to open) one small file per board. Each formula is stored whole, in the
+format it was written in, keyed by its (density, board) pair. Layout (host byte order):
+
+    "NGAR" | uint32 version
+    formula bytes, back to back (zero padded to a multiple of 8)
+    index: one ArchiveEntry per formula, sorted by (density, board)
+    footer: uint64 index offset | uint64 entry count | "NGAX"
+
+The footer has a fixed size, so a reader finds the index from the end of the file and can go
+straight to any formula without scanning the ones before it. Experimental/formatCheck.c reads the
+archives of a sweep back with archive_open and archive_find and checks every formula.
+*/
+
+#define ARCHIVE_VERSION 1
+
+typedef struct ArchiveEntry {
+    int32_t density ;
+    int32_t board ;
+    uint64_t offset ;   // from the start of the file
+    uint64_t length ;   // in bytes
+} ArchiveEntry ;
+
+typedef struct ArchiveWriter ArchiveWriter ;
+typedef struct ArchiveReader ArchiveReader ;
+
+// Create the archive at path. Returns: ArchiveWriter*|NULL
+ArchiveWriter * archive_create (const char * path) ;
+
+// Append the formula for (density, board).
+void archive_add (ArchiveWriter * archive, int density, int board, const char * data, size_t len) ;
+
+// Write the index and footer, and close the file.
+void archive_finish (ArchiveWriter * archive) ;
+
+/*
+    Flush the formulae added so far to the file (so a checkpoint can rely on them), giving the
+    number added and where the next one goes. Returns: their index entries, in the order added
+*/
+const ArchiveEntry * archive_progress (ArchiveWriter * archive, size_t * count, uint64_t * offset) ;
+
+/*
+    Reopen the unfinished archive at path to go on adding formulae after the count whose index
+    entries are given, cutting off anything written after them at offset (see checkpoint.h).
+    Returns: ArchiveWriter*|NULL
+*/
+ArchiveWriter * archive_resume (const char * path, const ArchiveEntry * index, size_t count, uint64_t offset) ;
+
+// Map the archive at path into memory. Returns: ArchiveReader*|NULL
+ArchiveReader * archive_open (const char * path) ;
+
+// Find the formula for (density, board), setting *len to its size.
+// Returns: a pointer into the mapped file, or NULL if the archive does not hold it.
+const char * archive_find (const ArchiveReader * archive, int density, int board, size_t * len) ;
+
+// Accessors for the index
+size_t archive_count (const ArchiveReader * archive) ;
+const ArchiveEntry * archive_entry (const ArchiveReader * archive, size_t i) ;
+
+// Unmap and free the reader.
+void archive_close (ArchiveReader * archive) ;
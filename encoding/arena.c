@@ -0,0 +1,105 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdalign.h>
+
+#include "arena.h"
+
+#define ARENA_ALIGN alignof(max_align_t)
+
+struct ArenaBlock {
+    ArenaBlock * prev ;     // the block chained before this one
+    size_t size ;           // bytes of data
+    size_t used ;           // bytes of data handed out
+    alignas(max_align_t) char data[] ;
+} ;
+
+struct Arena {
+    ArenaBlock * block ;    // the block being allocated from
+    size_t chained ;        // total size of the blocks in the chain
+    size_t peak ;           // largest the chain has been since the last reset
+} ;
+
+static ArenaBlock * newBlock (ArenaBlock * prev, size_t size)
+{
+    ArenaBlock * block = malloc(sizeof(ArenaBlock) + size) ;
+    if (!block) {
+        fprintf(stderr, "arena block of %zu bytes failed\n", size) ;
+        exit(1) ;
+    }
+    block->prev = prev ;
+    block->size = size ;
+    block->used = 0 ;
+    return block ;
+}
+
+static void freeBlocksAfter (Arena * arena, ArenaBlock * keep)
+{
+    while (arena->block != keep) {
+        ArenaBlock * prev = arena->block->prev ;
+        arena->chained -= arena->block->size ;
+        free(arena->block) ;
+        arena->block = prev ;
+    }
+}
+
+Arena * arena_new (size_t size)
+{
+    Arena * arena = malloc(sizeof(Arena)) ;
+    if (!arena) {
+        fprintf(stderr, "arena_new failed\n") ;
+        exit(1) ;
+    }
+    arena->block = newBlock(NULL, size) ;
+    arena->chained = size ;
+    arena->peak = size ;
+    return arena ;
+}
+
+void * arena_alloc (Arena * arena, size_t bytes)
+{
+    ArenaBlock * block = arena->block ;
+    size_t start = (block->used + ARENA_ALIGN - 1) & ~(ARENA_ALIGN - 1) ;
+
+    if (start + bytes > block->size) {
+        size_t size = 2*block->size ;
+        if (size < bytes) size = bytes ;
+        block = arena->block = newBlock(block, size) ;
+        arena->chained += size ;
+        if (arena->chained > arena->peak) arena->peak = arena->chained ;
+        start = 0 ;
+    }
+
+    block->used = start + bytes ;
+    return block->data + start ;
+}
+
+void arena_reset (Arena * arena)
+{
+    if (arena->block->prev || arena->peak > arena->block->size) {
+        // Grow to a single block that holds everything the last board needed (even if a release
+        // has already handed its extra blocks back)
+        freeBlocksAfter(arena, NULL) ;
+        arena->block = newBlock(NULL, arena->peak) ;
+        arena->chained = arena->peak ;
+    }
+    arena->block->used = 0 ;
+}
+
+ArenaMark arena_mark (const Arena * arena)
+{
+    const ArenaMark mark = {arena->block, arena->block->used} ;
+    return mark ;
+}
+
+void arena_release (Arena * arena, ArenaMark mark)
+{
+    freeBlocksAfter(arena, mark.block) ;
+    arena->block->used = mark.used ;
+}
+
+void arena_free (Arena * arena)
+{
+    if (!arena) return ;
+    freeBlocksAfter(arena, NULL) ;
+    free(arena) ;
+}
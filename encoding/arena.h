@@ -0,0 +1,46 @@
+#pragma once
+
+#include <stddef.h>
+
+/*
+An arena is a bump allocator for the scratch memory of encoding a board (descriptions, automata,
+variable tables). Allocating is a pointer increment, nothing is freed on its own, and the whole
+arena is reset at once when the board is done. Each thread encoding boards owns its own arena.
+
+When an allocation does not fit, another block is chained on. A reset keeps the memory: if the
+board needed more than one block, they are replaced by a single block as large as all of them
+(whether they are still chained or a release has already freed them), so once the largest board
+has been seen the arena never goes back to the heap.
+
+Memory for a single line can be handed back early by taking a mark before the line and releasing
+to it afterwards, so every line of a board reuses the same (cache warm) memory.
+*/
+
+typedef struct Arena Arena ;
+typedef struct ArenaBlock ArenaBlock ;
+
+typedef struct ArenaMark {
+    ArenaBlock * block ;
+    size_t used ;
+} ArenaMark ;
+
+// Allocate an arena whose first block holds `size` bytes. Returns: Arena*
+Arena * arena_new (size_t size) ;
+
+// Allocate `bytes` bytes, aligned for any type. Returns: void* (never NULL)
+void * arena_alloc (Arena * arena, size_t bytes) ;
+
+// Allocate an array of `count` ints. Returns: int*
+static inline int * arena_ints (Arena * arena, size_t count)
+{
+    return arena_alloc(arena, count*sizeof(int)) ;
+}
+
+// Free everything allocated from the arena, keeping its memory for reuse.
+void arena_reset (Arena * arena) ;
+
+// Everything allocated after arena_mark is freed by arena_release.
+ArenaMark arena_mark (const Arena * arena) ;
+void arena_release (Arena * arena, ArenaMark mark) ;
+
+void arena_free (Arena * arena) ;
@@ -0,0 +1,135 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "bincnf.h"
+
+#define BINCNF_HEADER_SIZE 8
+
+struct BinaryCnf {
+    int vars ;
+    int clauses ;
+    int * lits ;        // every literal of the formula, clause after clause
+    size_t * offsets ;  // clause i is lits[offsets[i]] to lits[offsets[i+1]-1]
+} ;
+
+/*
+    Read a varint at *p, no further than end.
+    Returns: 1 and the value in *v, or 0 if the varint runs past end or is too long.
+*/
+static inline int getVarint (const unsigned char ** p, const unsigned char * end, uint64_t * v)
+{
+    uint64_t value = 0 ;
+    for (int shift = 0 ; shift < 64 && *p < end ; shift += 7) {
+        const unsigned char byte = *(*p)++ ;
+        value |= (uint64_t) (byte & 0x7f) << shift ;
+        if (!(byte & 0x80)) {
+            *v = value ;
+            return 1 ;
+        }
+    }
+    return 0 ;
+}
+
+BinaryCnf * bincnf_read (const char * data, size_t len)
+{
+    const unsigned char * p = (const unsigned char *) data + BINCNF_HEADER_SIZE ;
+    const unsigned char * end = (const unsigned char *) data + len ;
+    uint32_t version ;
+    uint64_t vars, clauses ;
+
+    if (len < BINCNF_HEADER_SIZE || memcmp(data, BINCNF_MAGIC, 4)) goto bad ;
+    memcpy(&version, data + 4, sizeof version) ;
+    if (version != BINCNF_VERSION
+        || !getVarint(&p, end, &vars) || !getVarint(&p, end, &clauses)
+        || vars > INT32_MAX || clauses > len) goto bad ;
+
+    // Every length and literal takes at least a byte, so the rest of the data bounds the literal count
+    BinaryCnf * cnf = malloc(sizeof(BinaryCnf)) ;
+    cnf->vars = vars ;
+    cnf->clauses = clauses ;
+    cnf->lits = malloc((end - p + 1)*sizeof(int)) ;
+    cnf->offsets = malloc((clauses + 1)*sizeof(size_t)) ;
+    if (!cnf->lits || !cnf->offsets) {
+        fprintf(stderr, "bincnf_read failed\n") ;
+        exit(1) ;
+    }
+
+    size_t count = 0 ;
+    int64_t prev = 0 ;
+    for (uint64_t c = 0 ; c < clauses ; c++) {
+        uint64_t length ;
+        cnf->offsets[c] = count ;
+        if (!getVarint(&p, end, &length) || length > (uint64_t) (end - p)) goto fail ;
+        for (uint64_t i = 0 ; i < length ; i++) {
+            uint64_t code ;
+            if (!getVarint(&p, end, &code)) goto fail ;
+            const uint64_t zigzag = code >> 1 ;
+            const int64_t var = prev + (int64_t) ((zigzag >> 1) ^ -(zigzag & 1)) ;
+            if (var < 1 || var > (int64_t) vars) goto fail ;
+            cnf->lits[count++] = code & 1 ? -var : var ;
+            prev = var ;
+        }
+    }
+    cnf->offsets[clauses] = count ;
+    if (p != end) goto fail ;
+    return cnf ;
+
+fail:
+    bincnf_free(cnf) ;
+bad:
+    fprintf(stderr, "bincnf_read: not a binary CNF formula\n") ;
+    return NULL ;
+}
+
+BinaryCnf * bincnf_load (const char * path)
+{
+    int fd = open(path, O_RDONLY) ;
+    if (fd < 0) {
+        perror(path) ;
+        return NULL ;
+    }
+
+    struct stat st ;
+    if (fstat(fd, &st) != 0 || st.st_size == 0) {
+        fprintf(stderr, "%s: not a binary CNF formula\n", path) ;
+        close(fd) ;
+        return NULL ;
+    }
+
+    const size_t size = st.st_size ;
+    const char * map = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0) ;
+    close(fd) ;
+    if (map == MAP_FAILED) {
+        perror(path) ;
+        return NULL ;
+    }
+
+    BinaryCnf * cnf = bincnf_read(map, size) ;
+    munmap((void *) map, size) ;
+    return cnf ;
+}
+
+/* Accessors */
+int bincnf_vars (const BinaryCnf * cnf) { return cnf->vars ; }
+int bincnf_clauses (const BinaryCnf * cnf) { return cnf->clauses ; }
+const int * bincnf_literals (const BinaryCnf * cnf) { return cnf->lits ; }
+const size_t * bincnf_offsets (const BinaryCnf * cnf) { return cnf->offsets ; }
+
+const int * bincnf_clause (const BinaryCnf * cnf, int i, int * len)
+{
+    *len = cnf->offsets[i + 1] - cnf->offsets[i] ;
+    return cnf->lits + cnf->offsets[i] ;
+}
+
+void bincnf_free (BinaryCnf * cnf)
+{
+    if (!cnf) return ;
+    free(cnf->lits) ;
+    free(cnf->offsets) ;
+    free(cnf) ;
+}
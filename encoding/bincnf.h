@@ -0,0 +1,73 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+/*
+The binary CNF format is a compact alternative to DIMACS text, written by the sink from
+sink_bincnf and read back here without any text parsing. Layout:
+
+    "NGBC" | uint32 version (host byte order)
+    varint vars | varint clauses (the same counts as the "p cnf" line)
+    each clause: varint length, then a varint per literal
+
+Varints are unsigned LEB128 (7 bits per byte, low bits first, high bit set on all but the last
+byte). A literal is stored as the zigzag coded difference between its variable and the variable
+of the literal before it (across clause boundaries, starting from 0), shifted left once with the
+low bit set for a negative literal. The encoders number the variables of a line together, so
+most differences are small and most literals take a single byte.
+
+The reader decodes a whole formula into one flat literal array, allocated with malloc (as are the
+clause offsets) and freed by bincnf_free, and hands out each clause as a pointer into it. It skips
+the text parsing but not the copy: the formula is decoded once, and its clauses are never copied
+one by one after that. Experimental/cnfArchive.py has a decoder of the same format in Python, and
+Experimental/formatCheck.c checks that bincnf_read and bincnf_load give back what the sink wrote.
+*/
+
+#define BINCNF_VERSION 1
+#define BINCNF_MAGIC "NGBC"
+
+typedef struct BinaryCnf BinaryCnf ;
+
+// Decode the binary formula held in data (for example a formula found with archive_find).
+// Returns: BinaryCnf*|NULL if data is not a well formed binary formula
+BinaryCnf * bincnf_read (const char * data, size_t len) ;
+
+// Map the file at path into memory and decode it. Returns: BinaryCnf*|NULL
+BinaryCnf * bincnf_load (const char * path) ;
+
+// The counts from the header
+int bincnf_vars (const BinaryCnf * cnf) ;
+int bincnf_clauses (const BinaryCnf * cnf) ;
+
+// Clause i as a span of literals, setting *len to its length.
+const int * bincnf_clause (const BinaryCnf * cnf, int i, int * len) ;
+
+// The flat literal array, and the offset of each clause into it (clauses + 1 offsets)
+const int * bincnf_literals (const BinaryCnf * cnf) ;
+const size_t * bincnf_offsets (const BinaryCnf * cnf) ;
+
+void bincnf_free (BinaryCnf * cnf) ;
+
+/*
+    Write v as a varint at p.
+    Returns: the position just past the last byte written.
+*/
+static inline unsigned char * bincnf_putVarint (unsigned char * p, uint64_t v)
+{
+    while (v >= 0x80) {
+        *p++ = (unsigned char) (v | 0x80) ;
+        v >>= 7 ;
+    }
+    *p++ = (unsigned char) v ;
+    return p ;
+}
+
+// The code stored for literal lit following a literal on variable prev
+static inline uint64_t bincnf_code (int64_t lit, int64_t prev)
+{
+    const int64_t var = lit < 0 ? -lit : lit ;
+    const int64_t delta = var - prev ;
+    const uint64_t zigzag = ((uint64_t) delta << 1) ^ (uint64_t) (delta >> 63) ;
+    return zigzag << 1 | (lit < 0) ;
+}
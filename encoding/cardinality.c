@@ -0,0 +1,112 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "cardinality.h"
+
+static inline int minimum (int a, int b) { return a < b ? a : b ; }
+
+/*
+The clauses merging counts a (p outputs) and b (q outputs) into r (m outputs), where outputs are
+numbered from 1 and a_0 = b_0 = true:
+
+    a_i & b_j -> r_{i+j}              for 1 <= i+j <= m
+    -a_{i+1} & -b_{j+1} -> -r_{i+j+1}  for i+j+1 <= m
+
+A literal a_{p+1} (or b_{q+1}) only comes up when a counts all of its inputs, and is then false.
+*/
+
+// The pairs 0 <= i <= p, 0 <= j <= q with i+j <= s
+static int64_t pairsUpTo (int p, int q, int s)
+{
+    int64_t pairs = 0 ;
+    for (int i = 0 ; i <= p && i <= s ; i++) {
+        pairs += minimum(q, s - i) + 1 ;
+    }
+    return pairs ;
+}
+
+// The clauses merge writes, one for each pair with 1 <= i+j <= m and one for each with i+j+1 <= m
+static int64_t mergeClauses (int p, int q, int m)
+{
+    return pairsUpTo(p, q, m) - 1 + pairsUpTo(p, q, m - 1) ;
+}
+
+static void merge (const int * a, int p, const int * b, int q, const int * r, int m, ClauseSink * out)
+{
+    for (int i = 0 ; i <= p ; i++) {
+        for (int j = 0 ; j <= q ; j++) {
+            if (i + j >= 1 && i + j <= m) {
+                if (i > 0) sink_lit(out, -a[i - 1]) ;
+                if (j > 0) sink_lit(out, -b[j - 1]) ;
+                sink_lit(out, r[i + j - 1]) ;
+                sink_end(out) ;
+            }
+            if (i + j + 1 <= m) {
+                if (i < p) sink_lit(out, a[i]) ;
+                if (j < q) sink_lit(out, b[j]) ;
+                sink_lit(out, -r[i + j]) ;
+                sink_end(out) ;
+            }
+        }
+    }
+}
+
+/*
+    Count lits[0..n-1] in unary, keeping at most limit outputs, which go in outputs.
+    Returns: the number of clauses written
+*/
+static int64_t totalizer (const int * lits, int n, int limit, int * varIndex, int * outputs, ClauseSink * out, Arena * scratch)
+{
+    if (n == 1) {
+        outputs[0] = lits[0] ;
+        return 0 ;
+    }
+    const int left = n/2 ;
+    const int p = minimum(left, limit), q = minimum(n - left, limit), m = minimum(n, limit) ;
+    int * a = arena_ints(scratch, p) ;
+    int * b = arena_ints(scratch, q) ;
+    int64_t clauses = totalizer(lits, left, limit, varIndex, a, out, scratch) ;
+    clauses += totalizer(lits + left, n - left, limit, varIndex, b, out, scratch) ;
+    for (int j = 0 ; j < m ; j++) {
+        outputs[j] = *varIndex ;
+        *varIndex = *varIndex + 1 ;
+    }
+    merge(a, p, b, q, outputs, m, out) ;
+    return clauses + mergeClauses(p, q, m) ;
+}
+
+static int64_t totalizerCounts (int n, int limit, int64_t * vars)
+{
+    if (n == 1) return 0 ;
+    const int left = n/2 ;
+    const int p = minimum(left, limit), q = minimum(n - left, limit), m = minimum(n, limit) ;
+    int64_t clauses = totalizerCounts(left, limit, vars) + totalizerCounts(n - left, limit, vars) ;
+    *vars += m ;
+    return clauses + mergeClauses(p, q, m) ;
+}
+
+int64_t cardinality_exactly (const int * lits, int n, int k, int * varIndex, ClauseSink * out, Arena * scratch)
+{
+    if (n == 0) return 0 ;
+    ArenaMark start = arena_mark(scratch) ;
+    const int m = minimum(n, k + 1) ;
+    int * count = arena_ints(scratch, m) ;
+    int64_t clauses = totalizer(lits, n, k + 1, varIndex, count, out, scratch) ;
+    if (k >= 1) {
+        sink_unit(out, count[k - 1]) ; // at least k
+        clauses += 1 ;
+    }
+    if (k + 1 <= n) {
+        sink_unit(out, -count[k]) ; // not at least k+1
+        clauses += 1 ;
+    }
+    arena_release(scratch, start) ;
+    return clauses ;
+}
+
+int64_t cardinality_counts (int n, int k, int64_t * vars)
+{
+    *vars = 0 ;
+    if (n == 0) return 0 ;
+    return totalizerCounts(n, k + 1, vars) + (k >= 1) + (k + 1 <= n) ;
+}
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <stdint.h>
+
+#include "sink.h"
+#include "arena.h"
+
+/*
+Cardinality constraints saying exactly k of a set of literals are true, as a totalizer (Bailleux
+and Boufkhad). The literals are split in half, each half is counted in unary (output j is true
+iff at least j of its literals are), and the two counts are merged into the count of the whole.
+Only outputs up to k+1 are kept at any node, so a constraint on n literals takes O(n log n)
+variables and at most O(n*k) clauses, and exactly k is then two singleton clauses on the outputs.
+
+Every Nonogram line has a known number of filled cells (the total of its description), and the
+board as a whole the sum of those. The automaton encoding only implies these counts, and a solver
+cannot see them until most of a line is settled; stating them outright as well (see regExEncoding's
+-c and -C) lets it reason about how many cells are left to fill.
+*/
+
+#define CARDINALITY_LINES 1 // Each line also states how many of its cells are filled (-c)
+#define CARDINALITY_BOARD 2 // The board also states how many of its cells are filled (-C)
+
+/*
+    Write the constraint that exactly k of the n literals lits[0..n-1] are true, with its fresh
+    variables numbered from *varIndex on (which is moved past them).
+    Returns: the number of clauses written
+*/
+int64_t cardinality_exactly (const int * lits, int n, int k, int * varIndex, ClauseSink * out, Arena * scratch) ;
+
+/*
+    The counts of the constraint cardinality_exactly writes for n literals and k, which are 64-bit
+    as the clauses of a board constraint (O(n*k)) overflow an int long before its variables do.
+    Returns: the number of clauses, with the number of fresh variables in *vars
+*/
+int64_t cardinality_counts (int n, int k, int64_t * vars) ;
@@ -0,0 +1,96 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "checkpoint.h"
+
+#define CHECKPOINT_MAGIC "NGCK"
+
+bool checkpoint_write (const char * path, const Checkpoint * checkpoint)
+{
+    char temporary[1024] ;
+    snprintf(temporary, sizeof temporary, "%s.tmp", path) ;
+    FILE * fp = fopen(temporary, "wb") ;
+    if (!fp) {
+        perror(temporary) ;
+        return false ;
+    }
+
+    const uint32_t version = CHECKPOINT_VERSION ;
+    const uint8_t hasRng = checkpoint->hasRng ;
+    const uint8_t hasArchive = checkpoint->hasArchive ;
+    bool ok = fwrite(CHECKPOINT_MAGIC, 1, 4, fp) == 4
+           && fwrite(&version, sizeof version, 1, fp) == 1
+           && fwrite(checkpoint->key, 1, CHECKPOINT_KEY, fp) == CHECKPOINT_KEY
+           && fwrite(&checkpoint->position, sizeof checkpoint->position, 1, fp) == 1
+           && fwrite(&hasRng, 1, 1, fp) == 1
+           && (!hasRng || fwrite(&checkpoint->rng, sizeof(MTRand), 1, fp) == 1)
+           && fwrite(&hasArchive, 1, 1, fp) == 1 ;
+    if (ok && hasArchive) {
+        ok = fwrite(&checkpoint->archiveDensity, sizeof checkpoint->archiveDensity, 1, fp) == 1
+          && fwrite(&checkpoint->archiveOffset, sizeof checkpoint->archiveOffset, 1, fp) == 1
+          && fwrite(&checkpoint->entryCount, sizeof checkpoint->entryCount, 1, fp) == 1
+          && fwrite(checkpoint->entries, sizeof(ArchiveEntry), checkpoint->entryCount, fp) == checkpoint->entryCount ;
+    }
+    if (fclose(fp) != 0) ok = false ;
+    if (!ok || rename(temporary, path) != 0) {
+        perror(path) ;
+        remove(temporary) ;
+        return false ;
+    }
+    return true ;
+}
+
+bool checkpoint_read (const char * path, const char * key, Checkpoint * checkpoint)
+{
+    FILE * fp = fopen(path, "rb") ;
+    if (!fp) {
+        perror(path) ;
+        return false ;
+    }
+
+    char magic[4] ;
+    uint32_t version ;
+    uint8_t hasRng = 0 ;
+    uint8_t hasArchive = 0 ;
+    checkpoint->entries = NULL ;
+    bool ok = fread(magic, 1, 4, fp) == 4 && !memcmp(magic, CHECKPOINT_MAGIC, 4)
+           && fread(&version, sizeof version, 1, fp) == 1 && version == CHECKPOINT_VERSION
+           && fread(checkpoint->key, 1, CHECKPOINT_KEY, fp) == CHECKPOINT_KEY
+           && fread(&checkpoint->position, sizeof checkpoint->position, 1, fp) == 1
+           && fread(&hasRng, 1, 1, fp) == 1
+           && (!hasRng || fread(&checkpoint->rng, sizeof(MTRand), 1, fp) == 1)
+           && fread(&hasArchive, 1, 1, fp) == 1 ;
+    if (ok && hasArchive) {
+        ok = fread(&checkpoint->archiveDensity, sizeof checkpoint->archiveDensity, 1, fp) == 1
+          && fread(&checkpoint->archiveOffset, sizeof checkpoint->archiveOffset, 1, fp) == 1
+          && fread(&checkpoint->entryCount, sizeof checkpoint->entryCount, 1, fp) == 1 ;
+        if (ok) {
+            checkpoint->entries = malloc((checkpoint->entryCount + 1)*sizeof(ArchiveEntry)) ;
+            ok = checkpoint->entries != NULL
+              && fread(checkpoint->entries, sizeof(ArchiveEntry), checkpoint->entryCount, fp) == checkpoint->entryCount ;
+        }
+    }
+    fclose(fp) ;
+    checkpoint->hasRng = hasRng ;
+    checkpoint->hasArchive = hasArchive ;
+    if (!ok) {
+        fprintf(stderr, "%s: not a checkpoint\n", path) ;
+        checkpoint_release(checkpoint) ;
+        return false ;
+    }
+
+    checkpoint->key[CHECKPOINT_KEY - 1] = '\0' ;
+    if (strcmp(checkpoint->key, key) != 0) {
+        fprintf(stderr, "%s is the checkpoint of another run:\n    %s\nnot\n    %s\n", path, checkpoint->key, key) ;
+        checkpoint_release(checkpoint) ;
+        return false ;
+    }
+    return true ;
+}
+
+void checkpoint_release (Checkpoint * checkpoint)
+{
+    free(checkpoint->entries) ;
+    checkpoint->entries = NULL ;
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "mtwister.h"
+#include "archive.h"
+
+/*
+A checkpoint records how far a long run got, so that an interrupted run can be resumed rather
+than started again (regExEncoding -k/-r, and the scraped puzzle converter). It holds:
+
+    key --> the options of the run, so a checkpoint is only resumed by the same run
+    position --> how far the run got: the jobs finished in order, or the next puzzle to convert
+    rng --> the state of the single random stream, when the run draws its boards from one
+    archive --> the archive being written when the checkpoint was taken: the density it is for
+                (as in the sweep's archive path), where its next formula goes, and its index so far
+
+Everything a run writes after its last checkpoint is written again when it resumes (files
+rewritten, the archive cut back to the recorded offset), so the resumed run's output is the same
+as an uninterrupted one's. The file is written whole to a temporary file and renamed over the
+last checkpoint, so a run killed while checkpointing leaves the previous checkpoint intact.
+Layout (host byte order):
+
+    "NGCK" | uint32 version | key (CHECKPOINT_KEY bytes) | int64 position
+    uint8 has rng | MTRand (if it has)
+    uint8 has archive | int32 density | uint64 offset | uint64 entry count | ArchiveEntry * count (if it has)
+*/
+
+#define CHECKPOINT_VERSION 1
+#define CHECKPOINT_KEY 256
+
+typedef struct Checkpoint {
+    char key[CHECKPOINT_KEY] ;
+    int64_t position ;
+    bool hasRng ;
+    MTRand rng ;
+    bool hasArchive ;
+    int32_t archiveDensity ;
+    uint64_t archiveOffset ;
+    uint64_t entryCount ;
+    ArchiveEntry * entries ;    // owned by the checkpoint once read
+} Checkpoint ;
+
+// Write the checkpoint to path, replacing any checkpoint already there. Returns: whether it was written
+bool checkpoint_write (const char * path, const Checkpoint * checkpoint) ;
+
+// Read the checkpoint at path written with the given key. Returns: whether there is one (with a message if not)
+bool checkpoint_read (const char * path, const char * key, Checkpoint * checkpoint) ;
+
+// Free the index entries of a checkpoint read with checkpoint_read
+void checkpoint_release (Checkpoint * checkpoint) ;
@@ -0,0 +1,164 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+
+#include "dnf.h"
+
+#define DNF_MAX_LINE 64 // the cells of a line are the bits of a word
+
+/*
+A clause over the cells of a line, as the cells it has positively and negatively (bit j is cell j+1).
+*/
+typedef struct implicate {
+    uint64_t pos ;
+    uint64_t neg ;
+} implicate ;
+
+/*
+A growable array of clauses.
+*/
+typedef struct implicates {
+    implicate * items ;
+    size_t count ;
+    size_t cap ;
+} implicates ;
+
+static void push (implicates * s, uint64_t pos, uint64_t neg)
+{
+    if (s->count == s->cap) {
+        s->cap = s->cap ? 2*s->cap : 64 ;
+        s->items = realloc(s->items, s->cap*sizeof(implicate)) ;
+        if (!s->items) {
+            fprintf(stderr, "buildDNFConstraint failed\n") ;
+            exit(1) ;
+        }
+    }
+    s->items[s->count++] = (implicate) {pos, neg} ;
+}
+
+// The word with the low n bits set
+static inline uint64_t lowBits (int n)
+{
+    return n >= 64 ? ~(uint64_t) 0 : ((uint64_t) 1 << n) - 1 ;
+}
+
+/*
+    Add the filling `filled` (its filled cells) as the next term: keep the clauses of cur that have
+    one of its literals, and extend each of the others by each of its literals on a cell the clause
+    does not have, unless that makes it a superset of a clause kept. The result goes in next.
+*/
+static void addTerm (const implicates * cur, implicates * next, uint64_t filled, uint64_t full)
+{
+    const uint64_t empty = full & ~filled ;
+    next->count = 0 ;
+    for (size_t i = 0 ; i < cur->count ; i++) {
+        const implicate c = cur->items[i] ;
+        if ((c.pos & filled) | (c.neg & empty)) push(next, c.pos, c.neg) ;
+    }
+    const size_t kept = next->count ;
+
+    for (size_t i = 0 ; i < cur->count ; i++) {
+        const implicate c = cur->items[i] ;
+        if ((c.pos & filled) | (c.neg & empty)) continue ;
+        const uint64_t free = full & ~(c.pos | c.neg) ;
+        for (uint64_t rest = free ; rest ; rest &= rest - 1) {
+            const uint64_t bit = rest & -rest ;
+            const implicate e = (filled & bit) ? (implicate) {c.pos | bit, c.neg} : (implicate) {c.pos, c.neg | bit} ;
+            // The extensions of different clauses never contain one another, so only the kept clauses can make e redundant
+            bool subsumed = false ;
+            for (size_t k = 0 ; k < kept && !subsumed ; k++) {
+                const implicate h = next->items[k] ;
+                subsumed = !(h.pos & ~e.pos) && !(h.neg & ~e.neg) ;
+            }
+            if (!subsumed) push(next, e.pos, e.neg) ;
+        }
+    }
+}
+
+/*
+    Order clauses by length, and then by their cells in order (a positive literal before a negative
+    one on the same cell), so the formula does not depend on the order the fillings came in.
+*/
+static int compareImplicates (const void * a, const void * b)
+{
+    const implicate * x = a ;
+    const implicate * y = b ;
+    const uint64_t xs = x->pos | x->neg ;
+    const uint64_t ys = y->pos | y->neg ;
+    const int xl = __builtin_popcountll(xs) ;
+    const int yl = __builtin_popcountll(ys) ;
+    if (xl != yl) return xl < yl ? -1 : 1 ;
+    uint64_t d = xs ^ ys ;
+    if (d) return (xs & d & -d) ? -1 : 1 ;
+    d = x->pos ^ y->pos ;
+    if (d) return (x->pos & d & -d) ? -1 : 1 ;
+    return 0 ;
+}
+
+int buildDNFConstraint (nfa * n, int * stringVars, int * varIndex, const description * d, int lineLength, ClauseSink * out, Arena * scratch)
+{
+    (void) n ;
+    (void) varIndex ;
+    if (lineLength > DNF_MAX_LINE) {
+        fprintf(stderr, "The DNF encoding only takes lines of up to %d cells\n", DNF_MAX_LINE) ;
+        exit(1) ;
+    }
+    const uint64_t full = lowBits(lineLength) ;
+
+    // No fillings yet is the formula false, the empty clause
+    implicates cur = {0} ;
+    implicates next = {0} ;
+    push(&cur, 0, 0) ;
+
+    // Every filling, with the runs as far left as they go first
+    ArenaMark mark = arena_mark(scratch) ;
+    int * starts = arena_ints(scratch, d->length + 1) ;
+    int at = 0 ;
+    for (int r = 0 ; r < d->length ; r++) {
+        starts[r] = at ;
+        at += d->runs[r] + 1 ;
+    }
+    bool more = at - 1 <= lineLength || d->length == 0 ;
+    while (more) {
+        uint64_t filled = 0 ;
+        for (int r = 0 ; r < d->length ; r++) {
+            filled |= lowBits(d->runs[r]) << starts[r] ;
+        }
+        addTerm(&cur, &next, filled, full) ;
+        implicates t = cur ;
+        cur = next ;
+        next = t ;
+
+        // The next filling moves the last run that can go right by one, and packs the runs after it behind it
+        more = false ;
+        for (int r = d->length - 1 ; r >= 0 && !more ; r--) {
+            const int limit = r == d->length - 1 ? lineLength : starts[r + 1] - 1 ;
+            if (starts[r] + d->runs[r] < limit) {
+                starts[r] += 1 ;
+                for (int s = r + 1 ; s < d->length ; s++) {
+                    starts[s] = starts[s - 1] + d->runs[s - 1] + 1 ;
+                }
+                more = true ;
+            }
+        }
+    }
+    arena_release(scratch, mark) ;
+
+    qsort(cur.items, cur.count, sizeof(implicate), compareImplicates) ;
+    int lits[DNF_MAX_LINE] ;
+    for (size_t i = 0 ; i < cur.count ; i++) {
+        int len = 0 ;
+        for (uint64_t rest = cur.items[i].pos | cur.items[i].neg ; rest ; rest &= rest - 1) {
+            const uint64_t bit = rest & -rest ;
+            const int cell = __builtin_ctzll(bit) ;
+            lits[len++] = (cur.items[i].pos & bit) ? stringVars[cell] : -stringVars[cell] ;
+        }
+        sink_clause(out, lits, len) ;
+    }
+    const int clauses = cur.count ;
+    free(cur.items) ;
+    free(next.items) ;
+    return clauses ;
+}
+
+const lineEncoding dnfEncoding = {buildDNFConstraint, NULL, NULL, NULL, false, false} ;
@@ -0,0 +1,34 @@
+#pragma once
+
+#include "nonogram.h"
+
+/*
+A DNF encoding of a line, on the same idea as the one of the thesis that dnfToCNF.c writes (every
+filling of a line is a term of a DNF formula over its cells, converted to CNF with no fresh
+variables) but a different conversion, whose formulae have not been compared with dnfToCNF.c's.
+The line's CNF is the clauses made by taking one literal from each term, with the tautologies and
+the subsumed clauses left out. These are exactly the prime implicates of the line's fillings (the
+clauses it implies with no literal to spare), so the formula is the line's complete prime form and
+has the same solutions over the cells as the automaton encoding. It is not in general the smallest
+CNF of the line, and the number of its clauses can grow exponentially with the length of the line.
+
+The conversion is done a term at a time (Berge's algorithm for minimal transversals): the clauses
+for the fillings seen so far that already have a literal of the next filling stay, and each of the
+others is extended by each literal of the filling that keeps it minimal. The fillings are never
+all held at once, but lines are limited to 64 cells.
+
+dnfEncoding is a lineEncoding (see nonogram.h) like the automaton encodings, so it can be given
+to a line cache and used wherever they are (Experimental/pipeline.c -d solves the sweep with it).
+Its counts depend on the conversion, so the cache gives them (linecache_counts).
+*/
+
+extern const lineEncoding dnfEncoding ;
+
+/*
+    Write the DNF encoding of d in a line of lineLength (at most 64) cells, which are the variables
+    stringVars. There are no fresh variables, so *varIndex is left as it is (and the nfa is not
+    used, so dnfEncoding has automaton false and a line cache passes NULL; the signature is
+    buildConstraint's).
+    Returns: the number of clauses written
+*/
+int buildDNFConstraint (nfa * n, int * stringVars, int * varIndex, const description * d, int lineLength, ClauseSink * out, Arena * scratch) ;
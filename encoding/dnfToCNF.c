@@ -4,8 +4,14 @@
 #include <string.h>
 
 #include "mtwister.h"
+#include "sink.h"
+#include "stats.h"
+#include "trace.h"
 
 #define N 8
+#define BINARY 0 // 1 writes the binary format of bincnf.h (.cnfb files) instead of DIMACS text
+#define STATS_FILE "dnfToCNFStats.json" // Where a build with -DSTATS writes its counters (see stats.h)
+#define TRACE_FILE "dnfToCNFTrace.json" // Where a build with -DTRACE writes its timeline (see trace.h)
 
 // Struct Declarations
 typedef struct node node ;
@@ -162,6 +168,13 @@ void printDescription(node *[N]) ;
 
 
 //--------DNF Dynamic Programming--------
+/*
+newDNFtree: void -> DNFtreeNode *
+newDNFtree() = T, the DNF tree holding only its base cases, the fillings of every singleton description
+in every line length
+*/
+DNFtreeNode * newDNFtree() ;
+
 /* True if there is a formula for the description description in a length of tiles in 
 the tree with root root, false otherwise */
 bool inDNFtree(node * description, int tiles, DNFtreeNode * root) ;
@@ -262,86 +275,15 @@ bool isSubsumed(int * subsumed, CNFnode * subsumer) ;
 
 
 int main(void){
-    
-
-    // INITIALIZE DNF TREE
-    DNFtreeNode * DNFDP = malloc(sizeof(DNFtreeNode)) ;
-    DNFnode ** constraints = malloc(N*sizeof(DNFnode *));
-    DNFDP->constraints = constraints ;
-    DNFtreeNode ** childArray = malloc(N*sizeof(DNFtreeNode *));
-    DNFDP->children = childArray ;
-    DNFDP->scaled = false ;
+    TRACE_OPEN(TRACE_FILE) ;
 
-    /*
-    BASE CASES
-    
-    The base cases are all of the singleton descriptions (1,...,N) and the DNF constraints
-    for all line sizes (1,...,N). For a description r in a line of c cells:
-        if r > c -->    no fillings (NULL)
-        if r = c -->    the final r cells are positive, first N-r negative
-        if r > c -->    first N-c negative, then r positive, then remaining c-r negative concatenated
-                        with the fillings for r in c-1
-    */
-    for (int r = 0 ; r < N ; r++){
-        DNFtreeNode * child = malloc(sizeof(DNFtreeNode)) ;
-        child->scaled = false ;
-        DNFnode ** childConstraints = malloc(N*sizeof(DNFnode *)) ;
-        child->constraints = childConstraints ;
-        DNFtreeNode ** grandchildren = malloc(N*sizeof(DNFtreeNode *)) ;
-        for (int i = 0 ; i < N ; i++){grandchildren[i] = NULL ;}
-        child->children = grandchildren ;
-        /* This child will be the fillings for a run of size r across 
-        all possible line sizes (c = 1,2,...,N)
-        
-        Since it's zero-indexed the first element in the array is index zero
-        but corresponds to a line of size one. Same for r.
-        */
-        for (int c = 0 ; c < N ; c++){
-            if (r > c){ // Can't fit a run of r+1 in c+1 cells
-                child->constraints[c] = NULL ;
-            } else if (r == c){ // final r+1 cells positive, first N-r-1 negative
-                DNFnode * f = malloc(sizeof(DNFnode)) ;
-                f->tail = f ;
-                f->next = NULL ;
-                int * indicator = malloc(N*sizeof(int)) ;
-                f->term = indicator ;
-                for (int j = 0 ; j < N ; j++){
-                    if (j < N-r-1){
-                        f->term[j] = -1 ;
-                    } else{
-                        f->term[j] = 1 ;
-                    }
-                }
-                child->constraints[c] = f ;
-            } else {
-                // Construct the one new filling
-                DNFnode * fNew = malloc(sizeof(DNFnode)) ;
-                fNew->tail = fNew ;
-                fNew->next = NULL ;
-                int * indicator = malloc(N*sizeof(int)) ;
-                fNew->term = indicator ;
-                for (int j = 0 ; j < N ; j++){
-                    if (j < N-c-1){
-                        fNew->term[j] = -1 ;
-                    } else if (j < N-c+r){
-                        fNew->term[j] = 1 ;
-                    } else {
-                        fNew->term[j] = -1 ;
-                    }
-                }
-                // Combine with fillings from prior sizes
-                fNew->next = child->constraints[c-1] ;
-                fNew->tail = child->constraints[c-1]->tail ;
-                child->constraints[c] = fNew ;
-            }
-        }
-        DNFDP->children[r] = child ;
-    }
+    DNFtreeNode * DNFDP = newDNFtree() ;
 
     // INITIALIZE CNF TREE
     CNFtreeNode * CNFDP = malloc(sizeof(CNFtreeNode)) ;
     CNFDP->cnf = emptyLineCNF() ;
     CNFtreeNode ** childCNF = malloc(N*sizeof(CNFtreeNode *));
+    for (int i = 0 ; i < N ; i++){childCNF[i] = NULL ;}
     CNFDP->children = childCNF ;
     
     int boards = 0 ;
@@ -349,14 +291,23 @@ int main(void){
         for (int b = 0 ; b < 2 ; b++){
             MTRand seed = seedRand(31 + boards) ;
             printf("\nDensity - %d \t Board - %d\n", d,b) ;
+            TRACE_BOARD(d,b) ;
             // Fill the board randomly
             int * t ;
+            STATS_START(filling) ;
             t = randomFilled(d,seed) ;
+            STATS_STOP(filling,STAGE_GENERATE) ;
             printFilled(N,t) ;
+            STATS_START(encoding) ;
             // Build up the row descriptions
+            STATS_START(describing) ;
             node * rowDescriptions[N] ;
             for (int i = 0 ; i < N ; i++){
                 node *row = malloc(sizeof(node));
+                row->val = 0 ; // The empty description until a run is appended
+                row->len = 0 ;
+                row->next = NULL ;
+                row->tail = NULL ;
                 rowDescriptions[i] = row ;
             }
             genRowDescriptions(N,t, rowDescriptions) ;
@@ -365,9 +316,14 @@ int main(void){
             node * columnDescriptions[N] ;
             for (int i = 0 ; i < N ; i++){
                 node *column = malloc(sizeof(node));
+                column->val = 0 ;
+                column->len = 0 ;
+                column->next = NULL ;
+                column->tail = NULL ;
                 columnDescriptions[i] = column ;
             }
             genColumnDescriptions(N,t, columnDescriptions) ;
+            STATS_STOP(describing,STAGE_DESCRIBE) ;
 
             /*
             printf("Row\t Description\n") ;
@@ -376,6 +332,7 @@ int main(void){
             printDescription(columnDescriptions) ;
             */
             // Building up the DNF Tree with the Row and Column Descriptions
+            STATS_START(enumerating) ;
             for (int index = 0 ; index < N ; index++){
                 if (rowDescriptions[index]->val != 0){
                     if (!inDNFtree(rowDescriptions[index],N,DNFDP)){ // If not in the tree, need to add it
@@ -400,10 +357,12 @@ int main(void){
             }
 
             scaleFullLength(DNFDP) ; // Change full length DNF from indicators (0-1) to boolean variables (positive integers)
+            STATS_STOP(enumerating,STAGE_AUTOMATON) ;
             //printf("Scaled Up the DNF formulae\n") ;
             //printf("DNF Tree Grown\t") ;
             
             // Build up CNF tree
+            STATS_START(converting) ;
             for (int index = 0 ; index < N ; index++){
                 if (rowDescriptions[index]->val != 0){ // If the description is not the empty description
                     if (!inCNFtree(rowDescriptions[index],CNFDP)){ // If not in the tree, need to add it
@@ -527,26 +486,38 @@ int main(void){
                 clauses += 1 ;
                 clauseCounter = clauseCounter->next ;
             }
+            STATS_STOP(converting,STAGE_CONSTRAINT) ;
+            STATS_ADD(STAGE_BOARD,clauses,clauses) ;
+            STATS_ADD(STAGE_BOARD,variables,N*N) ;
             
             
             FILE * fp ;
             char index[50];
-            sprintf(index,"8x8 V2 Testing/density-%d board-%d.cnf",d, b) ;
+            sprintf(index,"8x8 V2 Testing/density-%d board-%d.%s",d, b, BINARY ? "cnfb" : "cnf") ;
             
             fp = fopen(index,"w") ;
-            fprintf(fp, "p cnf %d %d\n", N*N, clauses) ;
+            if (fp == NULL){
+                fprintf(stderr,"Could not open %s (does the directory exist?)\n",index) ;
+                exit(1) ;
+            }
+            ClauseSink * out = BINARY ? sink_bincnf(fp) : sink_dimacs(fp) ;
+            sink_header(out, N*N, clauses) ;
 
+            STATS_START(formatting) ;
             CNFnode * writeTemp = longFormula ;
             while (writeTemp != NULL){
                 for (int i = 0 ; i < N*N ; i++){
                     if (writeTemp->clause[i] != 0){
-                        fprintf(fp,"%d ", writeTemp->clause[i]) ;
+                        sink_lit(out, writeTemp->clause[i]) ;
                     }
                 }
-                fprintf(fp,"0\n") ;
+                sink_end(out) ;
                 writeTemp = writeTemp->next ;
             }
+            STATS_STOP(formatting,STAGE_FORMAT) ;
+            sink_free(out) ;
             fclose(fp) ; 
+            STATS_STOP(encoding,STAGE_BOARD) ;
             CNFnode * freeTemp = longFormula ;
             CNFnode * nextFree = longFormula->next ;
             while (nextFree != NULL){
@@ -560,6 +531,8 @@ int main(void){
             boards += 1 ;
         }
     }
+    STATS_MERGE() ;
+    STATS_WRITE(STATS_FILE) ;
     
     
     return 0 ;
@@ -567,6 +540,83 @@ int main(void){
 
 
 
+DNFtreeNode * newDNFtree(){
+    DNFtreeNode * DNFDP = malloc(sizeof(DNFtreeNode)) ;
+    DNFnode ** constraints = malloc(N*sizeof(DNFnode *));
+    for (int i = 0 ; i < N ; i++){constraints[i] = NULL ;} // The empty description has no formula in the tree
+    DNFDP->constraints = constraints ;
+    DNFtreeNode ** childArray = malloc(N*sizeof(DNFtreeNode *));
+    DNFDP->children = childArray ;
+    DNFDP->scaled = false ;
+
+    /*
+    BASE CASES
+    
+    The base cases are all of the singleton descriptions (1,...,N) and the DNF constraints
+    for all line sizes (1,...,N). For a description r in a line of c cells:
+        if r > c -->    no fillings (NULL)
+        if r = c -->    the final r cells are positive, first N-r negative
+        if r > c -->    first N-c negative, then r positive, then remaining c-r negative concatenated
+                        with the fillings for r in c-1
+    */
+    for (int r = 0 ; r < N ; r++){
+        DNFtreeNode * child = malloc(sizeof(DNFtreeNode)) ;
+        child->scaled = false ;
+        DNFnode ** childConstraints = malloc(N*sizeof(DNFnode *)) ;
+        child->constraints = childConstraints ;
+        DNFtreeNode ** grandchildren = malloc(N*sizeof(DNFtreeNode *)) ;
+        for (int i = 0 ; i < N ; i++){grandchildren[i] = NULL ;}
+        child->children = grandchildren ;
+        /* This child will be the fillings for a run of size r across 
+        all possible line sizes (c = 1,2,...,N)
+        
+        Since it's zero-indexed the first element in the array is index zero
+        but corresponds to a line of size one. Same for r.
+        */
+        for (int c = 0 ; c < N ; c++){
+            if (r > c){ // Can't fit a run of r+1 in c+1 cells
+                child->constraints[c] = NULL ;
+            } else if (r == c){ // final r+1 cells positive, first N-r-1 negative
+                DNFnode * f = malloc(sizeof(DNFnode)) ;
+                f->tail = f ;
+                f->next = NULL ;
+                int * indicator = malloc(N*sizeof(int)) ;
+                f->term = indicator ;
+                for (int j = 0 ; j < N ; j++){
+                    if (j < N-r-1){
+                        f->term[j] = -1 ;
+                    } else{
+                        f->term[j] = 1 ;
+                    }
+                }
+                child->constraints[c] = f ;
+            } else {
+                // Construct the one new filling
+                DNFnode * fNew = malloc(sizeof(DNFnode)) ;
+                fNew->tail = fNew ;
+                fNew->next = NULL ;
+                int * indicator = malloc(N*sizeof(int)) ;
+                fNew->term = indicator ;
+                for (int j = 0 ; j < N ; j++){
+                    if (j < N-c-1){
+                        fNew->term[j] = -1 ;
+                    } else if (j < N-c+r){
+                        fNew->term[j] = 1 ;
+                    } else {
+                        fNew->term[j] = -1 ;
+                    }
+                }
+                // Combine with fillings from prior sizes
+                fNew->next = child->constraints[c-1] ;
+                fNew->tail = child->constraints[c-1]->tail ;
+                child->constraints[c] = fNew ;
+            }
+        }
+        DNFDP->children[r] = child ;
+    }
+    return DNFDP ;
+}
+
 int * randomFilled(int t, MTRand r){
     // Initialize the board as empty (all cells zero)
     int * tiles = malloc(sizeof(int)*N*N) ;
@@ -606,7 +656,7 @@ void genRowDescriptions(int n, int * filled, node *description[N]){
             node * p = malloc(sizeof(node)) ;
 
             // Find the length of the run
-            while (filled[j] == 1){
+            while (j < n*n && filled[j] == 1){
                 // Don't want to allow runs over multiple rows
                 if (j/n != tileIndex/n){
                     break ;
@@ -637,7 +687,7 @@ void genColumnDescriptions(int n, int * filled, node *descriptions[N]){
                 int run = 0 ;
                 node * p = malloc(sizeof(node)) ;
 
-                while (filled[k] && k < n*n){
+                while (k < n*n && filled[k]){
                     k += n ;
                     run += 1 ;
                 }
@@ -659,6 +709,7 @@ void append(node * desc[N],int index, node * p){
         p->tail = p ;
     } else {
         if (desc[index]->next == NULL){
+            p->next = NULL ;
             desc[index]->next = p ;
             desc[index]->tail = p ;
         } else{
@@ -799,6 +850,7 @@ DNFnode * addFirst(int * toAdd, DNFnode * addTo, int startI, int endI){
     // Copy over addTo so I can copy over the information in toAdd
     DNFnode * ret = malloc(sizeof(DNFnode)) ;
     ret->tail = ret ;
+    ret->next = NULL ;
     int * indicator = malloc(N*sizeof(int)) ;
     ret->term = indicator ;
     
@@ -810,6 +862,7 @@ DNFnode * addFirst(int * toAdd, DNFnode * addTo, int startI, int endI){
     while (curr != NULL){
         DNFnode * new = malloc(sizeof(DNFnode)) ;
         new->tail = new ;
+        new->next = NULL ;
         prev->next = new ;
         ret->tail = new ;
 
@@ -922,7 +975,8 @@ void insert(node * description, int tiles, DNFnode * constraint, DNFtreeNode * r
 }
 
 void scaleFullLength(DNFtreeNode * treeNode){
-    if (treeNode->scaled == false){
+    // A node gets its full length formula when a description needs it, which can be after the tree was last scaled
+    if (treeNode->scaled == false && treeNode->constraints[N-1] != NULL){
         DNFnode * temp = treeNode->constraints[N-1] ;
         while (temp != NULL){
             for (int i = 0 ; i < N ; i++){
@@ -1022,6 +1076,7 @@ void insertCNF(node * description, CNFnode * cnf, CNFtreeNode * root){
     while (temp != NULL){
         if (head == NULL){
             CNFtreeNode * newTreeNode = malloc(sizeof(CNFtreeNode)) ;
+            newTreeNode->cnf = NULL ;
             CNFtreeNode ** children = malloc(N*sizeof(CNFtreeNode *)) ;
             for (int i = 0 ; i < N ; i++){children[i] = NULL ;}
             newTreeNode->children = children ;
@@ -1042,6 +1097,7 @@ void insertCNF(node * description, CNFnode * cnf, CNFtreeNode * root){
     */
     if (head == NULL){
         CNFtreeNode * newTreeNode = malloc(sizeof(CNFtreeNode)) ;
+        newTreeNode->cnf = NULL ;
         CNFtreeNode ** children = malloc(N*sizeof(CNFtreeNode *)) ;
         for (int i = 0 ; i < N ; i++){children[i] = NULL ;}
         
@@ -1350,8 +1406,10 @@ CNFnode * copyCNFscaled(node * description, CNFtreeNode * root, int index, char
     CNFnode * copyRoot = malloc(sizeof(CNFnode)) ;
 
     copyRoot->tail = copyRoot ;
+    copyRoot->next = NULL ;
     copyRoot->len = toCopy->len ;
     int * clause = malloc(N*N*sizeof(int)) ;
+    for (int i = 0 ; i < N*N ; i++){clause[i] = 0 ;} // copySmallToBig only sets the line's cells
     copySmallToBig(toCopy->clause,clause,index,line) ;
     copyRoot->clause = clause ;
 
@@ -1361,11 +1419,13 @@ CNFnode * copyCNFscaled(node * description, CNFtreeNode * root, int index, char
     while (curr != NULL){
         CNFnode * newNode = malloc(sizeof(CNFnode)) ;
         newNode->tail = newNode ;
+        newNode->next = NULL ;
         newNode->len = curr->len ;
         prev->next = newNode ;
         copyRoot->tail = newNode ;
 
         int * newClause = malloc(N*N*sizeof(int)) ;
+        for (int i = 0 ; i < N*N ; i++){newClause[i] = 0 ;}
         copySmallToBig(curr->clause,newClause,index,line) ;
         newNode->clause = newClause ;
 
@@ -1486,7 +1546,7 @@ CNFnode * emptyLineCNF(){
     CNFnode * root = malloc(sizeof(CNFnode)) ;
     root->len = 1 ;
     root->tail = root ;
-   
+    root->next = NULL ;
 
     int * clause = malloc(N*sizeof(int)) ;
     clause[0] = -1 ;
@@ -1501,6 +1561,7 @@ CNFnode * emptyLineCNF(){
 
         prev->next = newClause ;
         root->tail = newClause ;
+        newClause->next = NULL ;
         newClause->len = 1 ;
         int * clause = malloc(N*sizeof(int)) ;
 
@@ -1563,10 +1624,13 @@ CNFnode * DNFtoCNF(DNFnode * dnf) {
 
     CNFnode * ledger = malloc(sizeof(CNFnode)) ;
     ledger->tail = NULL ; // While tail is NULL, there are no clauses in the ledger
+    ledger->next = NULL ;
+    ledger->indices = NULL ;
+    ledger->len = 0 ;
 
 
     for (int i = 0 ; i < 2*N ; i++){
-        printf("Literal: %d\tFrequency: %d\n", frequencies[i].literal, frequencies[i].frequency) ;
+        //printf("Literal: %d\tFrequency: %d\n", frequencies[i].literal, frequencies[i].frequency) ;
         literalNode literal = frequencies[i] ;
         if (literal.frequency == 0){
             break ; // If I start seeing non-appearing literals, none of them make clauses so I can break
@@ -1590,14 +1654,14 @@ CNFnode * DNFtoCNF(DNFnode * dnf) {
             }
             temp = temp->next ;
         }
-        printf("\n\nLiteral: %d\tFrequency: %d\tIntended Free Terms: %d\n", literal.literal,literal.frequency,*terms-literal.frequency) ;
+        /*printf("\n\nLiteral: %d\tFrequency: %d\tIntended Free Terms: %d\n", literal.literal,literal.frequency,*terms-literal.frequency) ;
         for (int i = 0 ; i < *terms-literal.frequency ; i++){ // Prints the free terms
             printf("< ") ;
             for (int j = 0 ; j < N ; j++){
                 printf("%d ",freeTerms[i]->term[j]) ;
             }
             printf(">\n") ;
-        }
+        }*/
         
         int indices[*terms-literal.frequency] ;
         for (int i = 0 ; i < *terms-literal.frequency ; i++){indices[i] = 0 ;}
@@ -1607,11 +1671,11 @@ CNFnode * DNFtoCNF(DNFnode * dnf) {
         int finalTerm = 0 ;
         int clausesToConsider = 50 ;
         while (incremented && clausesToConsider > 0){
-            printf("potentialClause at the beginning of the loop: < ") ;
+            /*printf("potentialClause at the beginning of the loop: < ") ;
             for (int c = 0 ; c < N ; c++){
                 printf("%d ",potentialClause[c]) ;
             }
-            printf(">\n") ;
+            printf(">\n") ;*/
             incremented = false ;
             tautological = false ;
             subsumed = false ;
@@ -1621,7 +1685,7 @@ CNFnode * DNFtoCNF(DNFnode * dnf) {
                 finalTerm = j ;
                 if (freeTerms[j]->term[indices[j]] == -1*potentialClause[indices[j]]){
                     tautological = true ;
-                    printf("Tautology: %d\n", freeTerms[j]->term[indices[j]]) ;
+                    //printf("Tautology: %d\n", freeTerms[j]->term[indices[j]]) ;
                     break ;
                 } else {
                     potentialClause[indices[j]] = freeTerms[j]->term[indices[j]] ;
@@ -1629,23 +1693,23 @@ CNFnode * DNFtoCNF(DNFnode * dnf) {
                 
                 if (ledgerSubsumes(potentialClause,ledger)){
                     subsumed = true ;
-                    printf("Subsumed:\t") ;
+                    /*printf("Subsumed:\t") ;
                     printf("< ") ;
                     for (int i = 0 ; i < N ; i++){
                         printf("%d ",potentialClause[i]) ;
                     }
-                    printf(">\n") ;
+                    printf(">\n") ;*/
                     break ;
                 }
                 
             }
 
             if (!subsumed && !tautological){
-                printf("Adding this clause: (literal %d)\t< ",literal.literal) ;
+                /*printf("Adding this clause: (literal %d)\t< ",literal.literal) ;
                 for (int i = 0 ; i < N ; i++){
                     printf("%d ",potentialClause[i]) ;
                 }
-                printf(">\n") ;
+                printf(">\n") ;*/
                 addToLedger(potentialClause,ledger) ;
             }
             
@@ -1670,11 +1734,11 @@ CNFnode * DNFtoCNF(DNFnode * dnf) {
                     }
                 }
             }
-            printf("finalTerm: %d\tindices: [", finalTerm) ;
+            /*printf("finalTerm: %d\tindices: [", finalTerm) ;
             for (int i = 0 ; i < *terms-literal.frequency ; i++){
                 printf("%d,", indices[i]) ;
             }
-            printf("]\n") ;
+            printf("]\n") ;*/
             clausesToConsider -= 1 ;
             
         } 
@@ -1764,6 +1828,8 @@ void addToLedger(int * clause, CNFnode * ledger){
             if (clause[i] != 0){
                 literalIndexNode * index = malloc(sizeof(literalIndexNode)) ;
                 index->index = i ;
+                index->next = NULL ;
+                ledger->len += 1 ;
                 if (ledger->indices == NULL){
                     ledger->indices = index ;
                     ledger->indices->tail = ledger->indices ;
@@ -1777,12 +1843,17 @@ void addToLedger(int * clause, CNFnode * ledger){
         ledger->clause = cnf ;
     } else {
         CNFnode * cnf = malloc(sizeof(CNFnode)) ;
+        cnf->next = NULL ;
+        cnf->indices = NULL ;
+        cnf->len = 0 ;
         int * c = malloc(N*sizeof(int)) ;
         for (int i = 0 ; i < N ; i++){
             c[i] = clause[i] ;
             if (clause[i] != 0){
                 literalIndexNode * index = malloc(sizeof(literalIndexNode)) ;
                 index->index = i ;
+                index->next = NULL ;
+                cnf->len += 1 ;
                 if (cnf->indices == NULL){
                     cnf->indices = index ;
                     cnf->indices->tail = cnf->indices ;
@@ -0,0 +1,228 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "eliminate.h"
+
+// A growable list of ints (clause ids, or literals)
+typedef struct IntList {
+    int * items ;
+    size_t n ;
+    size_t cap ;
+} IntList ;
+
+static void grow (IntList * list)
+{
+    list->cap = list->cap ? 2*list->cap : 8 ;
+    list->items = realloc(list->items, list->cap*sizeof(int)) ;
+    if (!list->items) {
+        fprintf(stderr, "eliminate_variables failed\n") ;
+        exit(1) ;
+    }
+}
+
+static inline void push (IntList * list, int item)
+{
+    if (list->n == list->cap) grow(list) ;
+    list->items[list->n++] = item ;
+}
+
+/*
+The clauses being worked on. Clause i is lits[start[i]] to lits[start[i] + len[i] - 1], and is
+dropped when dead[i] is set. The occurrence lists (one for each sign of each variable being
+eliminated) may still hold clauses that have since been dropped, which are skipped.
+*/
+typedef struct Clauses {
+    IntList lits ;
+    IntList start ;
+    IntList len ;
+    char * dead ;
+    size_t deadCap ;
+    IntList * occurs ;  // occurs[2*(v-first) + (lit < 0)] are the clauses with lit
+    int first ;
+    int end ;
+} Clauses ;
+
+static inline IntList * occurrences (Clauses * f, int lit)
+{
+    const int v = abs(lit) ;
+    if (v < f->first || v >= f->end) return NULL ;
+    return &f->occurs[2*(v - f->first) + (lit < 0)] ;
+}
+
+static void addClause (Clauses * f, const int * lits, int len)
+{
+    const int id = f->start.n ;
+    push(&f->start, f->lits.n) ;
+    push(&f->len, len) ;
+    if ((size_t) id == f->deadCap) {
+        f->deadCap = f->deadCap ? 2*f->deadCap : 64 ;
+        f->dead = realloc(f->dead, f->deadCap) ;
+        if (!f->dead) {
+            fprintf(stderr, "eliminate_variables failed\n") ;
+            exit(1) ;
+        }
+    }
+    f->dead[id] = 0 ;
+    for (int j = 0 ; j < len ; j++) {
+        push(&f->lits, lits[j]) ;
+        IntList * occ = occurrences(f, lits[j]) ;
+        if (occ) push(occ, id) ;
+    }
+}
+
+// Drop the clauses that have died from an occurrence list
+static void compact (Clauses * f, IntList * occ)
+{
+    size_t kept = 0 ;
+    for (size_t i = 0 ; i < occ->n ; i++) {
+        if (!f->dead[occ->items[i]]) occ->items[kept++] = occ->items[i] ;
+    }
+    occ->n = kept ;
+}
+
+/*
+Resolvents on v are taken a clause p (with v) at a time: p's other literals are marked, with
+mark[u] == stamp (or -stamp) when u (or -u) is one of them, and then each clause q (with -v) is
+checked against the marks. stamp has to be new for each p.
+*/
+static void markClause (Clauses * f, int p, int v, int * mark, int stamp)
+{
+    const int * a = f->lits.items + f->start.items[p] ;
+    for (int j = 0 ; j < f->len.items[p] ; j++) {
+        if (a[j] != v) mark[abs(a[j])] = a[j] > 0 ? stamp : -stamp ;
+    }
+}
+
+// Returns: whether the resolvent of the marked clause and q on v is a tautology
+static bool tautology (const Clauses * f, int q, int v, const int * mark, int stamp)
+{
+    const int * b = f->lits.items + f->start.items[q] ;
+    for (int j = 0 ; j < f->len.items[q] ; j++) {
+        if (b[j] != -v && mark[abs(b[j])] == (b[j] > 0 ? -stamp : stamp)) return true ;
+    }
+    return false ;
+}
+
+/*
+    The resolvent on v of p and q into out, without repeated literals (p must be the marked clause,
+    and the resolvent not a tautology).
+*/
+static void resolve (const Clauses * f, int p, int q, int v, const int * mark, int stamp, IntList * out)
+{
+    out->n = 0 ;
+    const int * a = f->lits.items + f->start.items[p] ;
+    const int * b = f->lits.items + f->start.items[q] ;
+    for (int j = 0 ; j < f->len.items[p] ; j++) {
+        if (a[j] != v) push(out, a[j]) ;
+    }
+    for (int j = 0 ; j < f->len.items[q] ; j++) {
+        if (b[j] != -v && mark[abs(b[j])] != (b[j] > 0 ? stamp : -stamp)) push(out, b[j]) ;
+    }
+}
+
+int * eliminate_variables (const int * packed, size_t * size, int * clauses, int first, int * end, Arena * scratch)
+{
+    const int range = *end - first ;
+    Clauses f = {0} ;
+    f.first = first ;
+    f.end = *end ;
+    f.occurs = calloc(2*range > 0 ? 2*range : 1, sizeof(IntList)) ;
+
+    int maxVar = *end - 1 ;
+    for (size_t i = 0 ; i < *size ; i += packed[i] + 1) {
+        addClause(&f, packed + i + 1, packed[i]) ;
+        for (int j = 1 ; j <= packed[i] ; j++) {
+            if (abs(packed[i + j]) > maxVar) maxVar = abs(packed[i + j]) ;
+        }
+    }
+
+    int * mark = calloc(maxVar + 1, sizeof(int)) ;
+    char * gone = calloc(range > 0 ? range : 1, 1) ;
+    if (!f.occurs || !mark || !gone) {
+        fprintf(stderr, "eliminate_variables failed\n") ;
+        exit(1) ;
+    }
+    int stamp = 0 ;
+    IntList resolvent = {0} ;
+
+    for (int v = first ; v < *end ; v++) {
+        IntList * pos = occurrences(&f, v) ;
+        IntList * neg = occurrences(&f, -v) ;
+        compact(&f, pos) ;
+        compact(&f, neg) ;
+
+        // Count the resolvents first, giving up as soon as there are more than the clauses they replace
+        const size_t limit = pos->n + neg->n ;
+        size_t count = 0 ;
+        for (size_t i = 0 ; i < pos->n && count <= limit ; i++) {
+            markClause(&f, pos->items[i], v, mark, ++stamp) ;
+            for (size_t j = 0 ; j < neg->n && count <= limit ; j++) {
+                count += !tautology(&f, neg->items[j], v, mark, stamp) ;
+            }
+        }
+        if (count > limit) continue ;
+
+        // Resolvents are added after the clauses they replace are dropped, so v never gets new occurrences
+        const size_t posCount = pos->n, negCount = neg->n ;
+        int * replaced = malloc((limit > 0 ? limit : 1)*sizeof(int)) ;
+        memcpy(replaced, pos->items, posCount*sizeof(int)) ;
+        memcpy(replaced + posCount, neg->items, negCount*sizeof(int)) ;
+        for (size_t i = 0 ; i < limit ; i++) f.dead[replaced[i]] = 1 ;
+        for (size_t i = 0 ; i < posCount ; i++) {
+            markClause(&f, replaced[i], v, mark, ++stamp) ;
+            for (size_t j = 0 ; j < negCount ; j++) {
+                if (!tautology(&f, replaced[posCount + j], v, mark, stamp)) {
+                    resolve(&f, replaced[i], replaced[posCount + j], v, mark, stamp, &resolvent) ;
+                    addClause(&f, resolvent.items, resolvent.n) ;
+                }
+            }
+        }
+        free(replaced) ;
+        pos->n = 0 ;
+        neg->n = 0 ;
+        gone[v - first] = 1 ;
+    }
+
+    // Number what is left of the range from first, in order
+    int * label = mark ;
+    int next = first ;
+    for (int v = first ; v < *end ; v++) label[v] = gone[v - first] ? 0 : next++ ;
+
+    size_t outSize = 0 ;
+    int count = 0 ;
+    for (size_t i = 0 ; i < f.start.n ; i++) {
+        if (!f.dead[i]) {
+            outSize += f.len.items[i] + 1 ;
+            count += 1 ;
+        }
+    }
+    int * out = arena_ints(scratch, outSize) ;
+    size_t k = 0 ;
+    for (size_t i = 0 ; i < f.start.n ; i++) {
+        if (f.dead[i]) continue ;
+        const int * lits = f.lits.items + f.start.items[i] ;
+        out[k++] = f.len.items[i] ;
+        for (int j = 0 ; j < f.len.items[i] ; j++) {
+            const int v = abs(lits[j]) ;
+            const int u = v >= first && v < *end ? label[v] : v ;
+            out[k++] = lits[j] > 0 ? u : -u ;
+        }
+    }
+
+    for (int i = 0 ; i < 2*range ; i++) free(f.occurs[i].items) ;
+    free(f.occurs) ;
+    free(f.lits.items) ;
+    free(f.start.items) ;
+    free(f.len.items) ;
+    free(f.dead) ;
+    free(resolvent.items) ;
+    free(mark) ;
+    free(gone) ;
+
+    *size = outSize ;
+    *clauses = count ;
+    *end = next ;
+    return out ;
+}
@@ -0,0 +1,26 @@
+#pragma once
+
+#include <stddef.h>
+
+#include "arena.h"
+
+/*
+Bounded variable elimination (as in SatELite). A variable v is eliminated by replacing every
+clause containing v or -v with all the non-tautological resolvents on v between them, which keeps
+the formula's solutions over every other variable. It is bounded by only eliminating v when there
+are no more resolvents than the clauses they replace, so the formula never gets more clauses.
+
+The line encodings use it on their transition variables. Each transition is little more than the
+conjunction of the states at its ends and its cell, so many of them (and most of them in short
+or pruned lines) can go without adding a clause, which leaves a smaller formula mostly over the
+cell and state variables.
+*/
+
+/*
+    Eliminate what the bound allows of the variables first..*end-1 from the *size ints of packed
+    (each clause as its length then its literals, as sink_record writes them), trying them in order.
+    The variables left in the range are renumbered first, first+1, ... in order.
+    Returns: the formula left, packed the same way and allocated from scratch, with its ints in *size,
+    its clauses in *clauses, and the end of the renumbered range in *end
+*/
+int * eliminate_variables (const int * packed, size_t * size, int * clauses, int first, int * end, Arena * scratch) ;
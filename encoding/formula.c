@@ -0,0 +1,86 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+
+#include "formula.h"
+#include "linesolve.h"
+#include "sink.h"
+#include "stream.h"
+
+/*
+    The board's cells as linesolve_board settles them, allocated from scratch (all unknown if the
+    descriptions contradict each other, so the formula is written in full and is unsatisfiable).
+*/
+static signed char * presolveCells (const description * rows, const description * columns, int height, int width, Arena * scratch)
+{
+    signed char * cells = arena_alloc(scratch, (size_t) height*width) ;
+    memset(cells, CELL_UNKNOWN, (size_t) height*width) ;
+    if (linesolve_board(rows, columns, height, width, cells, scratch) < 0) {
+        memset(cells, CELL_UNKNOWN, (size_t) height*width) ;
+    }
+    return cells ;
+}
+
+/*
+    Write the formula into f's arrays, with room for litCap literals and clauseCap clauses, and set
+    f's counts.
+    Returns: whether the counts fit in an int (if not, they are all set to 0)
+*/
+static bool encodeInto (const description * rows, const description * columns, int height, int width, const signed char * cells, int cardinality, LineCache * cache, cnfFormula * f, size_t litCap, size_t clauseCap, Arena * scratch)
+{
+    ClauseSink * out = sink_csr(f->lits, litCap, f->offsets, clauseCap) ;
+    int64_t clauses ;
+    const int64_t vars = stream_board(rows, columns, height, width, cells, cardinality, cache, out, &clauses, scratch) ;
+    const size_t literals = sink_size(out)/sizeof(int) ;
+    sink_free(out) ;
+
+    if (vars > INT_MAX || clauses > INT_MAX) {
+        f->vars = 0 ;
+        f->clauses = 0 ;
+        f->literals = 0 ;
+        return false ;
+    }
+    f->vars = vars ;
+    f->clauses = clauses ;
+    f->literals = literals ;
+    return true ;
+}
+
+bool formula_encode (const description * rows, const description * columns, int height, int width, bool presolve, int cardinality, LineCache * cache, cnfFormula * f, size_t litCap, size_t clauseCap, Arena * scratch)
+{
+    ArenaMark mark = arena_mark(scratch) ;
+    const signed char * cells = presolve ? presolveCells(rows, columns, height, width, scratch) : NULL ;
+    const bool counted = encodeInto(rows, columns, height, width, cells, cardinality, cache, f, litCap, clauseCap, scratch) ;
+    arena_release(scratch, mark) ;
+    return counted && f->literals <= litCap && (size_t) f->clauses <= clauseCap ;
+}
+
+bool formula_arena (const description * rows, const description * columns, int height, int width, bool presolve, int cardinality, LineCache * cache, cnfFormula * f, Arena * arena, Arena * scratch)
+{
+    ArenaMark mark = arena_mark(scratch) ;
+    const signed char * cells = presolve ? presolveCells(rows, columns, height, width, scratch) : NULL ;
+
+    f->lits = NULL ;
+    f->offsets = NULL ;
+    const bool counted = encodeInto(rows, columns, height, width, cells, cardinality, cache, f, 0, 0, scratch) ;
+    if (counted) {
+        f->lits = arena_ints(arena, f->literals) ;
+        f->offsets = arena_alloc(arena, ((size_t) f->clauses + 1)*sizeof(size_t)) ;
+        encodeInto(rows, columns, height, width, cells, cardinality, cache, f, f->literals, f->clauses, scratch) ;
+    }
+
+    arena_release(scratch, mark) ;
+    return counted ;
+}
+
+bool formula_board (const uint64_t * board, int size, bool presolve, int cardinality, LineCache * cache, cnfFormula * f, Arena * arena, Arena * scratch)
+{
+    ArenaMark mark = arena_mark(scratch) ;
+    description * rows = descriptionsFromBits(board, size, scratch) ;
+    uint64_t * transposed = arena_alloc(scratch, (size_t) size*boardWords(size)*sizeof(uint64_t)) ;
+    description * columns = descriptionsFromBits(transposeBits(board, transposed, size), size, scratch) ;
+    const bool counted = formula_arena(rows, columns, size, size, presolve, cardinality, cache, f, arena, scratch) ;
+    arena_release(scratch, mark) ;
+    return counted ;
+}
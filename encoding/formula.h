@@ -0,0 +1,64 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "nonogram.h"
+#include "linecache.h"
+#include "arena.h"
+
+/*
+Encoding a board in process, for code that solves the formulae itself and would otherwise have to
+write DIMACS text and parse it back. The formula comes back in CSR form (the literals of every
+clause one after another, and where each clause starts), in memory the caller provides or takes
+from an arena, and nothing touches the filesystem.
+
+The board is written by stream_board (see stream.h) into a CSR sink (see sink.h), so the formula is
+exactly the one regExEncoding writes for the same board and options. Which line encoding it has is
+the line cache's: any of the automaton encodings of nonogram.h, or the DNF encoding of dnf.h.
+*/
+
+/*
+A CNF formula in CSR form. Each field:
+
+    vars --> the number of variables, which are 1..vars (the board's cells are 1..height*width, row by row)
+    clauses --> the number of clauses
+    literals --> the number of literals, over all of the clauses
+    lits --> the literals of every clause, one clause after another
+    offsets --> clauses + 1 entries: the literals of clause i are lits[offsets[i]] up to lits[offsets[i + 1]]
+*/
+typedef struct cnfFormula {
+    int vars ;
+    int clauses ;
+    size_t literals ;
+    int * lits ;
+    size_t * offsets ;
+} cnfFormula ;
+
+/*
+    Encode the board with the height row descriptions rows and the width column descriptions columns
+    into the caller's arrays f->lits (of litCap ints) and f->offsets (of clauseCap + 1 entries), with
+    each line written from cache. With presolve the board is solved line by line first (as with
+    regExEncoding -s, see linesolve.h), and cardinality asks for the cardinality constraints
+    CARDINALITY_LINES and/or CARDINALITY_BOARD (see cardinality.h). f's counts are set either way, so
+    a call with no room (litCap and clauseCap 0) sizes the formula. All scratch memory is taken from
+    (and given back to) scratch.
+    Returns: whether the formula fit, which it never does if its counts do not fit in an int
+*/
+bool formula_encode (const description * rows, const description * columns, int height, int width, bool presolve, int cardinality, LineCache * cache, cnfFormula * f, size_t litCap, size_t clauseCap, Arena * scratch) ;
+
+/*
+    formula_encode with f's arrays allocated from arena (which must not be scratch), sized by a
+    first pass that only counts. The second pass finds every line's template in the cache, so it is
+    little more than copying the clauses.
+    Returns: whether the counts fit in an int (if not, f has no arrays)
+*/
+bool formula_arena (const description * rows, const description * columns, int height, int width, bool presolve, int cardinality, LineCache * cache, cnfFormula * f, Arena * arena, Arena * scratch) ;
+
+/*
+    formula_arena for the size x size bit packed board (see nonogram.h), whose descriptions are
+    taken from scratch.
+    Returns: whether the counts fit in an int
+*/
+bool formula_board (const uint64_t * board, int size, bool presolve, int cardinality, LineCache * cache, cnfFormula * f, Arena * arena, Arena * scratch) ;
@@ -0,0 +1,101 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <limits.h>
+
+#include "layout.h"
+
+#define NO_POSITION INT_MAX
+
+static int compareKeys (const void * a, const void * b)
+{
+    const uint64_t x = *(const uint64_t *) a, y = *(const uint64_t *) b ;
+    return (x > y) - (x < y) ;
+}
+
+/*
+Positions are kept at four times the cell index, so the middle of two neighbouring cells' positions
+is still a whole number. Each sort key is a position over the variable or clause index, which keeps
+the original order among equal positions.
+*/
+int * layout_positional (const int * packed, size_t size, int lineLength, int fresh, Arena * scratch)
+{
+    const int vars = lineLength + fresh ;
+    int * position = arena_ints(scratch, vars + 1) ;
+    int * lo = arena_ints(scratch, vars + 1) ;
+    int * hi = arena_ints(scratch, vars + 1) ;
+    for (int v = 1 ; v <= vars ; v++) {
+        position[v] = v <= lineLength ? 4*(v - 1) : NO_POSITION ;
+        lo[v] = NO_POSITION ;
+        hi[v] = -1 ;
+    }
+
+    // Variables sharing a clause with a cell take the first such cell's position
+    int clauses = 0 ;
+    for (size_t i = 0 ; i < size ; i += packed[i] + 1, clauses++) {
+        int first = NO_POSITION ;
+        for (int j = 1 ; j <= packed[i] ; j++) {
+            const int v = abs(packed[i + j]) ;
+            if (v <= lineLength && position[v] < first) first = position[v] ;
+        }
+        if (first == NO_POSITION) continue ;
+        for (int j = 1 ; j <= packed[i] ; j++) {
+            const int v = abs(packed[i + j]) ;
+            if (v > lineLength && first < position[v]) position[v] = first ;
+        }
+    }
+
+    // Every other variable takes the middle of the positions of those it shares a clause with
+    for (size_t i = 0 ; i < size ; i += packed[i] + 1) {
+        for (int j = 1 ; j <= packed[i] ; j++) {
+            const int u = abs(packed[i + j]) ;
+            if (position[u] != NO_POSITION) continue ;
+            for (int k = 1 ; k <= packed[i] ; k++) {
+                const int w = abs(packed[i + k]) ;
+                if (position[w] == NO_POSITION) continue ;
+                if (position[w] < lo[u]) lo[u] = position[w] ;
+                if (position[w] > hi[u]) hi[u] = position[w] ;
+            }
+        }
+    }
+    for (int v = lineLength + 1 ; v <= vars ; v++) {
+        if (position[v] == NO_POSITION && hi[v] >= 0) position[v] = (lo[v] + hi[v])/2 ;
+    }
+
+    // Renumber the fresh variables by position
+    uint64_t * keys = arena_alloc(scratch, (fresh > clauses ? fresh : clauses)*sizeof(uint64_t)) ;
+    for (int k = 0 ; k < fresh ; k++) {
+        const int v = lineLength + 1 + k ;
+        keys[k] = (uint64_t) (uint32_t) position[v] << 32 | (uint32_t) k ;
+    }
+    qsort(keys, fresh, sizeof(uint64_t), compareKeys) ;
+    int * label = lo ; // lo is no longer needed
+    for (int v = 1 ; v <= lineLength ; v++) label[v] = v ;
+    for (int k = 0 ; k < fresh ; k++) label[lineLength + 1 + (uint32_t) keys[k]] = lineLength + 1 + k ;
+
+    // Order the clauses by the first position they touch
+    size_t * start = arena_alloc(scratch, clauses*sizeof(size_t)) ;
+    int c = 0 ;
+    for (size_t i = 0 ; i < size ; i += packed[i] + 1, c++) {
+        int first = NO_POSITION ;
+        for (int j = 1 ; j <= packed[i] ; j++) {
+            const int v = abs(packed[i + j]) ;
+            if (position[v] < first) first = position[v] ;
+        }
+        start[c] = i ;
+        keys[c] = (uint64_t) (uint32_t) first << 32 | (uint32_t) c ;
+    }
+    qsort(keys, clauses, sizeof(uint64_t), compareKeys) ;
+
+    int * out = arena_ints(scratch, size) ;
+    size_t k = 0 ;
+    for (c = 0 ; c < clauses ; c++) {
+        const size_t i = start[(uint32_t) keys[c]] ;
+        out[k++] = packed[i] ;
+        for (int j = 1 ; j <= packed[i] ; j++) {
+            const int lit = packed[i + j] ;
+            out[k++] = lit > 0 ? label[lit] : -label[-lit] ;
+        }
+    }
+    return out ;
+}
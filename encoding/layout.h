@@ -0,0 +1,24 @@
+#pragma once
+
+#include <stddef.h>
+
+#include "arena.h"
+
+/*
+The line encodings number their fresh variables in blocks (every state variable of a line, then
+every transition variable) and write their clauses a constraint at a time, so the variables and
+clauses about one cell are spread over the whole line's formula. The positional layout puts them
+back in the order of the line. Every variable gets a position along the line: a cell its own
+index, a variable that shares a clause with a cell the first such cell, and any other variable
+(a state) the middle of the positions of the variables it shares clauses with. The fresh variables
+are then renumbered, and the clauses ordered, by position. A solver working on one part of the
+board then finds the variables and clauses it needs next to each other (in its assignment, watch
+and occurrence arrays), and the formula is otherwise exactly the same.
+*/
+
+/*
+    Lay out the line formula packed (each clause as its length then its literals, as sink_record
+    writes them, over the cells 1..l and the fresh variables l+1..l+fresh) in positional order.
+    Returns: the formula, the same size as packed and allocated from scratch
+*/
+int * layout_positional (const int * packed, size_t size, int lineLength, int fresh, Arena * scratch) ;
@@ -0,0 +1,293 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "linecache.h"
+#include "eliminate.h"
+#include "layout.h"
+#include "stats.h"
+
+#define CACHE_SLOTS 4096 // hash table slots, kept at most half full
+#define SEEN_SLOTS 16384 // lines remembered by the doorkeeper
+
+typedef struct CacheEntry {
+    uint64_t hash ;     // 0 marks an empty slot
+    int lineLength ;
+    int runs ;          // number of runs in the description
+    size_t key ;        // offset in the pool of the description's runs
+    size_t data ;       // offset in the pool of the template
+    size_t size ;       // ints in the template
+    int clauses ;
+    int fresh ;         // fresh variables the template uses
+} CacheEntry ;
+
+struct LineCache {
+    const lineEncoding * encoding ;
+    CacheEntry * table ;
+    int used ;              // occupied slots
+    int * pool ;            // descriptions and templates, back to back
+    size_t poolLen ;
+    size_t poolCap ;
+    ClauseSink * record ;   // where new templates are built
+    uint64_t * seen ;       // hashes of lines seen once, so only repeated lines get a template
+    long hits ;
+    long misses ;
+} ;
+
+LineCache * linecache_new (const lineEncoding * encoding, size_t maxLiterals)
+{
+    LineCache * cache = malloc(sizeof(LineCache)) ;
+    cache->encoding = encoding ;
+    cache->table = calloc(CACHE_SLOTS, sizeof(CacheEntry)) ;
+    cache->used = 0 ;
+    cache->pool = malloc(maxLiterals*sizeof(int)) ;
+    cache->poolLen = 0 ;
+    cache->poolCap = maxLiterals ;
+    cache->record = sink_record() ;
+    cache->seen = calloc(SEEN_SLOTS, sizeof(uint64_t)) ;
+    cache->hits = 0 ;
+    cache->misses = 0 ;
+    if (!cache->table || !cache->pool || !cache->seen) {
+        fprintf(stderr, "linecache_new failed\n") ;
+        exit(1) ;
+    }
+    return cache ;
+}
+
+void linecache_free (LineCache * cache)
+{
+    if (!cache) return ;
+    free(cache->table) ;
+    free(cache->pool) ;
+    free(cache->seen) ;
+    sink_free(cache->record) ;
+    free(cache) ;
+}
+
+/* Accessors */
+long linecache_hits (const LineCache * cache) { return cache->hits ; }
+long linecache_misses (const LineCache * cache) { return cache->misses ; }
+
+// FNV-1a over the line length and the runs (never 0, so 0 can mark an empty slot)
+static uint64_t hashLine (const description * d, int lineLength)
+{
+    uint64_t h = 0xcbf29ce484222325ULL ;
+    h = (h ^ (uint32_t) lineLength) * 0x100000001b3ULL ;
+    for (int j = 0 ; j < d->length ; j++) {
+        h = (h ^ (uint32_t) d->runs[j]) * 0x100000001b3ULL ;
+    }
+    return h ? h : 1 ;
+}
+
+/*
+    Find the slot for (d, lineLength): the entry holding it, or the empty slot it would go in.
+*/
+static CacheEntry * findSlot (LineCache * cache, uint64_t hash, const description * d, int lineLength)
+{
+    for (size_t i = hash & (CACHE_SLOTS - 1) ; ; i = (i + 1) & (CACHE_SLOTS - 1)) {
+        CacheEntry * e = &cache->table[i] ;
+        if (e->hash == 0) return e ;
+        if (e->hash == hash && e->lineLength == lineLength && e->runs == d->length
+            && !memcmp(cache->pool + e->key, d->runs, d->length*sizeof(int))) return e ;
+    }
+}
+
+/*
+    Write the template t of `size` ints to out, with cell j relabelled stringVars[j-1] and fresh
+    variable l+k relabelled base+k-1. The whole template is relabelled into one buffer and handed
+    to the sink in a single call.
+*/
+static void relabel (const int * t, size_t size, const int * stringVars, int base, int lineLength, int fresh, ClauseSink * out, Arena * scratch)
+{
+    STATS_START(formatStart) ;
+    ArenaMark start = arena_mark(scratch) ;
+
+    // The new label of every template literal (of either sign), so each literal is a single lookup
+    const int vars = lineLength + fresh ;
+    int * label = arena_ints(scratch, 2*vars + 1) + vars ;
+    for (int j = 0 ; j < lineLength ; j++) {
+        label[j + 1] = stringVars[j] ;
+        label[-(j + 1)] = -stringVars[j] ;
+    }
+    for (int k = 1 ; k <= fresh ; k++) {
+        label[lineLength + k] = base + k - 1 ;
+        label[-(lineLength + k)] = -(base + k - 1) ;
+    }
+
+    int * packed = arena_ints(scratch, size) ;
+    size_t i = 0 ;
+    while (i < size) {
+        const int len = t[i] ;
+        packed[i++] = len ;
+        for (int j = 0 ; j < len ; j++, i++) {
+            packed[i] = label[t[i]] ;
+        }
+    }
+    sink_clauses(out, packed, size) ;
+    STATS_STOP(formatStart, STAGE_FORMAT) ;
+
+    arena_release(scratch, start) ;
+}
+
+/*
+    Build the template for (d, lineLength) in the record sink, with its transition variables
+    eliminated and the positional layout if the cache's encoding asks for them.
+    Returns: its clause count, with the number of fresh variables in *fresh
+*/
+static int buildTemplate (LineCache * cache, const description * d, int lineLength, int * fresh, Arena * scratch)
+{
+    ArenaMark start = arena_mark(scratch) ;
+
+    int * cells = arena_ints(scratch, lineLength) ;
+    for (int j = 0 ; j < lineLength ; j++) cells[j] = j + 1 ;
+    int next = lineLength + 1 ;
+
+    sink_reset(cache->record) ;
+    nfa * n = NULL ;
+    if (cache->encoding->automaton) {
+        STATS_START(automatonStart) ;
+        n = buildNFA(d, scratch) ;
+        STATS_STOP(automatonStart, STAGE_AUTOMATON) ;
+    }
+    STATS_START(constraintStart) ;
+    int clauses = cache->encoding->build(n, cells, &next, d, lineLength, cache->record, scratch) ;
+    STATS_STOP(constraintStart, STAGE_CONSTRAINT) ;
+    STATS_ADD(STAGE_CONSTRAINT, clauses, clauses) ;
+    STATS_ADD(STAGE_CONSTRAINT, variables, next - lineLength - 1) ;
+    if (cache->encoding->keptVars != NULL) {
+        const int transitions = lineLength + 1 + cache->encoding->keptVars(d, lineLength) ;
+        size_t size = sink_size(cache->record)/sizeof(int) ;
+        const int * t = eliminate_variables((const int *) sink_data(cache->record), &size, &clauses, transitions, &next, scratch) ;
+        sink_reset(cache->record) ;
+        sink_clauses(cache->record, t, size) ;
+    }
+    *fresh = next - lineLength - 1 ;
+    if (cache->encoding->positional) {
+        const size_t size = sink_size(cache->record)/sizeof(int) ;
+        const int * t = layout_positional((const int *) sink_data(cache->record), size, lineLength, *fresh, scratch) ;
+        sink_reset(cache->record) ;
+        sink_clauses(cache->record, t, size) ;
+    }
+
+    arena_release(scratch, start) ;
+    return clauses ;
+}
+
+/*
+    Keep the template in the record sink in slot e, emptying the cache first if it is full (a
+    template too large for the cache is not kept).
+*/
+static void keepTemplate (LineCache * cache, CacheEntry * e, uint64_t hash, const description * d, int lineLength, int clauses, int fresh)
+{
+    const int * t = (const int *) sink_data(cache->record) ;
+    const size_t size = sink_size(cache->record)/sizeof(int) ;
+    const size_t needed = d->length + size ;
+    if (needed > cache->poolCap) return ;
+    if (cache->poolLen + needed > cache->poolCap || 2*(cache->used + 1) > CACHE_SLOTS) {
+        memset(cache->table, 0, CACHE_SLOTS*sizeof(CacheEntry)) ;
+        cache->used = 0 ;
+        cache->poolLen = 0 ;
+        e = findSlot(cache, hash, d, lineLength) ;
+    }
+    e->hash = hash ;
+    e->lineLength = lineLength ;
+    e->runs = d->length ;
+    e->key = cache->poolLen ;
+    memcpy(cache->pool + e->key, d->runs, d->length*sizeof(int)) ;
+    e->data = e->key + d->length ;
+    memcpy(cache->pool + e->data, t, size*sizeof(int)) ;
+    e->size = size ;
+    e->clauses = clauses ;
+    e->fresh = fresh ;
+    cache->poolLen += needed ;
+    cache->used += 1 ;
+}
+
+int linecache_encode (LineCache * cache, int * stringVars, int * varIndex, const description * d, int lineLength, ClauseSink * out, Arena * scratch)
+{
+    const uint64_t hash = hashLine(d, lineLength) ;
+    CacheEntry * e = findSlot(cache, hash, d, lineLength) ;
+
+    if (e->hash != 0) {
+        cache->hits += 1 ;
+        relabel(cache->pool + e->data, e->size, stringVars, *varIndex, lineLength, e->fresh, out, scratch) ;
+        STATS_ADD(STAGE_FORMAT, clauses, e->clauses) ;
+        *varIndex += e->fresh ;
+        return e->clauses ;
+    }
+
+    cache->misses += 1 ;
+
+    /*
+    Most lines of a large board have a description that never comes up again, and building a
+    template costs more than encoding the line directly. So a line is only given a template the
+    second time it is seen, and the first time it is written straight to out. (An encoding that
+    eliminates its transitions or is laid out positionally always goes through a template.)
+    */
+    uint64_t * seen = &cache->seen[hash & (SEEN_SLOTS - 1)] ;
+    if (*seen != hash && cache->encoding->keptVars == NULL && !cache->encoding->positional) {
+        *seen = hash ;
+        ArenaMark start = arena_mark(scratch) ;
+        nfa * n = NULL ;
+        if (cache->encoding->automaton) {
+            STATS_START(automatonStart) ;
+            n = buildNFA(d, scratch) ;
+            STATS_STOP(automatonStart, STAGE_AUTOMATON) ;
+        }
+        STATS_LET(base, *varIndex) ;
+        STATS_START(constraintStart) ;
+        const int clauses = cache->encoding->build(n, stringVars, varIndex, d, lineLength, out, scratch) ;
+        STATS_STOP(constraintStart, STAGE_CONSTRAINT) ;
+        STATS_ADD(STAGE_CONSTRAINT, clauses, clauses) ;
+        STATS_ADD(STAGE_CONSTRAINT, variables, *varIndex - base) ;
+        arena_release(scratch, start) ;
+        return clauses ;
+    }
+
+    int fresh ;
+    const int clauses = buildTemplate(cache, d, lineLength, &fresh, scratch) ;
+    keepTemplate(cache, e, hash, d, lineLength, clauses, fresh) ;
+
+    relabel((const int *) sink_data(cache->record), sink_size(cache->record)/sizeof(int), stringVars, *varIndex, lineLength, fresh, out, scratch) ;
+    *varIndex += fresh ;
+    return clauses ;
+}
+
+const int * linecache_template (LineCache * cache, const description * d, int lineLength, size_t * size, int * clauses, int * fresh, Arena * scratch)
+{
+    const uint64_t hash = hashLine(d, lineLength) ;
+    CacheEntry * e = findSlot(cache, hash, d, lineLength) ;
+    if (e->hash != 0) {
+        *size = e->size ;
+        *clauses = e->clauses ;
+        *fresh = e->fresh ;
+        return cache->pool + e->data ;
+    }
+
+    *clauses = buildTemplate(cache, d, lineLength, fresh, scratch) ;
+    keepTemplate(cache, e, hash, d, lineLength, *clauses, *fresh) ;
+    *size = sink_size(cache->record)/sizeof(int) ;
+    return (const int *) sink_data(cache->record) ;
+}
+
+int linecache_counts (LineCache * cache, const description * d, int lineLength, int * vars, Arena * scratch)
+{
+    if (cache->encoding->clauses != NULL) {
+        *vars = cache->encoding->vars(d, lineLength) ;
+        return cache->encoding->clauses(d, lineLength) ;
+    }
+
+    const uint64_t hash = hashLine(d, lineLength) ;
+    CacheEntry * e = findSlot(cache, hash, d, lineLength) ;
+    if (e->hash != 0) {
+        *vars = e->fresh ;
+        return e->clauses ;
+    }
+
+    int fresh ;
+    const int clauses = buildTemplate(cache, d, lineLength, &fresh, scratch) ;
+    keepTemplate(cache, e, hash, d, lineLength, clauses, fresh) ;
+    *vars = fresh ;
+    return clauses ;
+}
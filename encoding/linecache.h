@@ -0,0 +1,57 @@
+#pragma once
+
+#include <stddef.h>
+
+#include "nonogram.h"
+
+/*
+The formula a line encoding (see nonogram.h) writes for a line depends only on the description
+and the line length. Two lines with the same description differ only in their cell variables and
+in where their fresh (state and transition) variables start. A line cache keeps the formula of each
+(description, length) it has seen as a template, with the cells labelled 1..l and the fresh
+variables l+1, l+2, ... . Encoding a line that is already in the cache is then a relabel and copy
+of its template, with no automaton built at all. A line only gets a template once its description
+has been seen before, so descriptions that never repeat are encoded directly at no extra cost.
+
+The cache keeps at most a fixed number of template literals. When it is full it is emptied and
+refilled, which suits a sweep going density by density, since the common descriptions change
+with the density. Each thread encoding boards owns its own cache, and a cache only ever holds
+the formulae of the one encoding it was made for. An encoding that eliminates its transition
+variables or has the positional layout (see lineEncoding) is written only through a cache, so the
+elimination and layout are done once for each template rather than for every line.
+*/
+
+typedef struct LineCache LineCache ;
+
+// Allocate a cache of formulae written with `encoding`, holding at most `maxLiterals` template literals. Returns: LineCache*
+LineCache * linecache_new (const lineEncoding * encoding, size_t maxLiterals) ;
+
+/*
+    Write the formula for the line with the non-empty description d, exactly as the cache's
+    encoding would (the same clauses, in the same order, with the same fresh variables).
+    Returns: the number of clauses written
+*/
+int linecache_encode (LineCache * cache, int * stringVars, int * varIndex, const description * d, int lineLength, ClauseSink * out, Arena * scratch) ;
+
+/*
+    The counts of the formula linecache_encode writes for the line with the non-empty description d.
+    These are the encoding's own counts when it has them, and otherwise come from the line's
+    template, which is built (and kept) if it is not in the cache yet.
+    Returns: the number of clauses, with the number of fresh variables in *vars
+*/
+int linecache_counts (LineCache * cache, const description * d, int lineLength, int * vars, Arena * scratch) ;
+
+/*
+    The template of the line with the non-empty description d (built, and kept, if it is not in the
+    cache yet), over the cells 1..l and the fresh variables l+1..l+fresh, for a caller that numbers
+    the variables itself. It is only valid until the cache is next used.
+    Returns: the template (each clause as its length then its literals, `*size` ints in all), with its
+    clause count in *clauses and number of fresh variables in *fresh
+*/
+const int * linecache_template (LineCache * cache, const description * d, int lineLength, size_t * size, int * clauses, int * fresh, Arena * scratch) ;
+
+// Number of lines linecache_encode wrote from a template already in the cache, and otherwise
+long linecache_hits (const LineCache * cache) ;
+long linecache_misses (const LineCache * cache) ;
+
+void linecache_free (LineCache * cache) ;
@@ -0,0 +1,153 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "linehistory.h"
+#include "stats.h"
+
+/*
+One line's last formula. The clauses are kept as sink_record writes them, with the literals they
+were written with, so the fresh variables are the ones numbered from base on.
+*/
+typedef struct LineRecord {
+    bool valid ;        // the clauses belong to the segment below
+    bool reusable ;     // linehistory_same found the segment unchanged
+    int start ;
+    int length ;
+    int * runs ;        // the runs of the segment's rest
+    int runCount ;
+    int runCap ;
+    int * packed ;      // the clauses
+    size_t size ;
+    size_t cap ;
+    int clauses ;
+    int fresh ;
+    int base ;          // the first fresh variable the clauses use
+} LineRecord ;
+
+struct LineHistory {
+    LineRecord * lines ;
+    int lineCount ;
+    int cells ;             // variables up to this are cells, and never move
+    ClauseSink * record ;   // where changed lines are written before they are kept
+    long reused ;
+    long rewritten ;
+} ;
+
+LineHistory * linehistory_new (int lines, int cells)
+{
+    LineHistory * history = malloc(sizeof(LineHistory)) ;
+    history->lines = calloc(lines, sizeof(LineRecord)) ;
+    history->lineCount = lines ;
+    history->cells = cells ;
+    history->record = sink_record() ;
+    history->reused = 0 ;
+    history->rewritten = 0 ;
+    if (!history->lines) {
+        fprintf(stderr, "linehistory_new failed\n") ;
+        exit(1) ;
+    }
+    return history ;
+}
+
+void linehistory_free (LineHistory * history)
+{
+    if (!history) return ;
+    for (int i = 0 ; i < history->lineCount ; i++) {
+        free(history->lines[i].runs) ;
+        free(history->lines[i].packed) ;
+    }
+    free(history->lines) ;
+    sink_free(history->record) ;
+    free(history) ;
+}
+
+/* Accessors */
+long linehistory_reused (const LineHistory * history) { return history->reused ; }
+long linehistory_rewritten (const LineHistory * history) { return history->rewritten ; }
+
+void linehistory_clear (LineHistory * history)
+{
+    for (int i = 0 ; i < history->lineCount ; i++) {
+        history->lines[i].valid = false ;
+        history->lines[i].reusable = false ;
+    }
+}
+
+bool linehistory_same (LineHistory * history, int i, const lineSegment * g, int * clauses, int * vars)
+{
+    LineRecord * r = &history->lines[i] ;
+    r->reusable = r->valid && r->start == g->start && r->length == g->length && r->runCount == g->rest.length
+                  && !memcmp(r->runs, g->rest.runs, g->rest.length*sizeof(int)) ;
+    if (r->reusable) {
+        *clauses = r->clauses ;
+        *vars = r->fresh ;
+    }
+    return r->reusable ;
+}
+
+/*
+    Keep the clauses in the record sink as line i's formula for the segment g.
+*/
+static void keepLine (LineHistory * history, LineRecord * r, const lineSegment * g, int clauses, int fresh, int base)
+{
+    const size_t size = sink_size(history->record)/sizeof(int) ;
+    if (size > r->cap) {
+        r->cap = size + size/2 ;
+        r->packed = realloc(r->packed, r->cap*sizeof(int)) ;
+    }
+    if (g->rest.length > r->runCap) {
+        r->runCap = g->rest.length ;
+        r->runs = realloc(r->runs, r->runCap*sizeof(int)) ;
+    }
+    if (!r->packed || !r->runs) {
+        fprintf(stderr, "linehistory_encode failed\n") ;
+        exit(1) ;
+    }
+    memcpy(r->packed, sink_data(history->record), size*sizeof(int)) ;
+    memcpy(r->runs, g->rest.runs, g->rest.length*sizeof(int)) ;
+    r->size = size ;
+    r->runCount = g->rest.length ;
+    r->start = g->start ;
+    r->length = g->length ;
+    r->clauses = clauses ;
+    r->fresh = fresh ;
+    r->base = base ;
+    r->valid = true ;
+}
+
+int linehistory_encode (LineHistory * history, int i, const lineSegment * g, LineCache * cache, int * stringVars, int * varIndex, ClauseSink * out, Arena * scratch)
+{
+    LineRecord * r = &history->lines[i] ;
+    if (r->reusable) {
+        history->reused += 1 ;
+        STATS_START(formatStart) ;
+        // Move the fresh variables to their new start, in place, so the clauses stay current
+        const int shift = *varIndex - r->base ;
+        if (shift != 0) {
+            size_t k = 0 ;
+            while (k < r->size) {
+                const int len = r->packed[k++] ;
+                for (int j = 0 ; j < len ; j++, k++) {
+                    const int lit = r->packed[k] ;
+                    if (lit > history->cells) r->packed[k] = lit + shift ;
+                    else if (lit < -history->cells) r->packed[k] = lit - shift ;
+                }
+            }
+            r->base = *varIndex ;
+        }
+        sink_clauses(out, r->packed, r->size) ;
+        STATS_STOP(formatStart, STAGE_FORMAT) ;
+        STATS_ADD(STAGE_FORMAT, clauses, r->clauses) ;
+        *varIndex += r->fresh ;
+        return r->clauses ;
+    }
+
+    history->rewritten += 1 ;
+    const int base = *varIndex ;
+    sink_reset(history->record) ;
+    const int clauses = linecache_encode(cache, stringVars, varIndex, &g->rest, g->length, history->record, scratch) ;
+    keepLine(history, r, g, clauses, *varIndex - base, base) ;
+    sink_clauses(out, r->packed, r->size) ;
+    return clauses ;
+}
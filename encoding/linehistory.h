@@ -0,0 +1,48 @@
+#pragma once
+
+#include <stdbool.h>
+
+#include "linecache.h"
+#include "linesolve.h"
+
+/*
+In a coupled sweep (regExEncoding -u) the boards of one board index are nested: each is the one
+before it with some more cells filled. Most lines then have the same description as at the density
+before, and the formula of such a line is the same as before except for where its fresh variables
+start. A line history keeps the clauses each line was last written with, so an unchanged line is
+written by moving its fresh variables to their new start rather than going through the line cache.
+
+The history of a line is keyed on its segment (see linesolve.h) rather than its description, so it
+also works with presolving: a line is reused when the same cells are left between its settled ends
+with the same runs in them. Each thread encoding boards owns its own history, which only ever holds
+the lines of one board index and is cleared before the next.
+*/
+
+typedef struct LineHistory LineHistory ;
+
+// Allocate a history for boards with `lines` lines (rows and columns) and `cells` cells. Returns: LineHistory*
+LineHistory * linehistory_new (int lines, int cells) ;
+
+// Forget every line, before a new board index
+void linehistory_clear (LineHistory * history) ;
+
+/*
+    Compare the segment g of line i with the one its clauses were last written for, and remember
+    whether they can be reused by linehistory_encode.
+    Returns: whether they can, with their clause count, and the number of their fresh variables in *vars
+*/
+bool linehistory_same (LineHistory * history, int i, const lineSegment * g, int * clauses, int * vars) ;
+
+/*
+    Write line i with the segment g (whose rest is not empty) over the cells stringVars, exactly as
+    linecache_encode would: from its previous clauses if linehistory_same found them reusable, and
+    otherwise through the cache, keeping the clauses for the next board.
+    Returns: the number of clauses written
+*/
+int linehistory_encode (LineHistory * history, int i, const lineSegment * g, LineCache * cache, int * stringVars, int * varIndex, ClauseSink * out, Arena * scratch) ;
+
+// Number of lines linehistory_encode wrote from their previous clauses, and otherwise
+long linehistory_reused (const LineHistory * history) ;
+long linehistory_rewritten (const LineHistory * history) ;
+
+void linehistory_free (LineHistory * history) ;
@@ -0,0 +1,209 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "linesolve.h"
+
+/*
+The line solver is the usual pair of dynamic programmes over (runs placed, cells read). With t runs
+and l cells,
+
+    fits[j][x] == 1 iff the first j runs can be placed in cells [0,x), every other cell of which is
+                    left empty, without contradicting a settled cell
+    rest[j][x] == 1 iff runs j..t-1 can be placed in cells [x,l) in the same way
+
+A cell can be empty when fits[j][y] and rest[j][y+1] for some j, and can be filled when some run
+can start at or just before it with fits to its left and rest to its right. Both tables take
+O(t*l) time, and so does marking every cell each run can cover, with a difference array.
+*/
+int linesolve_line (const description * d, signed char * cells, int stride, int lineLength, Arena * scratch)
+{
+    ArenaMark start = arena_mark(scratch) ;
+    const int L = lineLength ;
+    const int t = d->length ;
+    const int * runs = d->runs ;
+    const int W = L + 1 ;
+
+    signed char * c = arena_alloc(scratch, L) ;
+    int * empties = arena_ints(scratch, L + 1) ; // empties[x] is the number of empty cells in [0,x)
+    empties[0] = 0 ;
+    for (int k = 0 ; k < L ; k++) {
+        c[k] = cells[k*stride] ;
+        empties[k + 1] = empties[k] + (c[k] == CELL_EMPTY) ;
+    }
+
+    char * fits = arena_alloc(scratch, (t + 1)*W) ;
+    fits[0] = 1 ;
+    for (int x = 1 ; x <= L ; x++) fits[x] = fits[x - 1] && c[x - 1] != CELL_FILLED ;
+    for (int j = 1 ; j <= t ; j++) {
+        const int r = runs[j - 1] ;
+        char * f = fits + j*W ;
+        f[0] = 0 ;
+        for (int x = 1 ; x <= L ; x++) {
+            bool v = c[x - 1] != CELL_FILLED && f[x - 1] ;
+            const int s = x - r ; // run j-1 in [s,x)
+            if (!v && s >= 0 && empties[x] == empties[s]) {
+                v = s == 0 ? j == 1 : c[s - 1] != CELL_FILLED && fits[(j - 1)*W + s - 1] ;
+            }
+            f[x] = v ;
+        }
+    }
+    if (!fits[t*W + L]) {
+        arena_release(scratch, start) ;
+        return -1 ;
+    }
+
+    char * rest = arena_alloc(scratch, (t + 1)*W) ;
+    char * g = rest + t*W ;
+    g[L] = 1 ;
+    for (int x = L - 1 ; x >= 0 ; x--) g[x] = g[x + 1] && c[x] != CELL_FILLED ;
+    for (int j = t - 1 ; j >= 0 ; j--) {
+        const int r = runs[j] ;
+        g = rest + j*W ;
+        g[L] = 0 ;
+        for (int x = L - 1 ; x >= 0 ; x--) {
+            bool v = c[x] != CELL_FILLED && g[x + 1] ;
+            const int e = x + r ; // run j in [x,e)
+            if (!v && e <= L && empties[e] == empties[x]) {
+                v = e == L ? j == t - 1 : c[e] != CELL_FILLED && rest[(j + 1)*W + e + 1] ;
+            }
+            g[x] = v ;
+        }
+    }
+
+    // covered[k] > 0 iff some consistent placement of a run covers cell k
+    int * covered = arena_ints(scratch, L + 1) ;
+    memset(covered, 0, (L + 1)*sizeof(int)) ;
+    for (int j = 0 ; j < t ; j++) {
+        const int r = runs[j] ;
+        for (int s = 0 ; s + r <= L ; s++) {
+            if (empties[s + r] != empties[s]) continue ;
+            const bool left = s == 0 ? j == 0 : c[s - 1] != CELL_FILLED && fits[j*W + s - 1] ;
+            const bool right = s + r == L ? j == t - 1 : c[s + r] != CELL_FILLED && rest[(j + 1)*W + s + r + 1] ;
+            if (left && right) {
+                covered[s] += 1 ;
+                covered[s + r] -= 1 ;
+            }
+        }
+    }
+
+    int settled = 0 ;
+    int cover = 0 ;
+    for (int y = 0 ; y < L ; y++) {
+        cover += covered[y] ;
+        if (c[y] != CELL_UNKNOWN) continue ;
+        bool canEmpty = false ;
+        for (int j = 0 ; j <= t && !canEmpty ; j++) {
+            canEmpty = fits[j*W + y] && rest[j*W + y + 1] ;
+        }
+        if (cover > 0 && !canEmpty) {
+            cells[y*stride] = CELL_FILLED ;
+            settled += 1 ;
+        } else if (cover == 0 && canEmpty) {
+            cells[y*stride] = CELL_EMPTY ;
+            settled += 1 ;
+        }
+    }
+
+    arena_release(scratch, start) ;
+    return settled ;
+}
+
+int linesolve_board (const description * rows, const description * columns, int height, int width, signed char * cells, Arena * scratch)
+{
+    ArenaMark start = arena_mark(scratch) ;
+    char * rowDirty = arena_alloc(scratch, height) ;
+    char * columnDirty = arena_alloc(scratch, width) ;
+    signed char * before = arena_alloc(scratch, height > width ? height : width) ;
+    memset(rowDirty, 1, height) ;
+    memset(columnDirty, 1, width) ;
+
+    bool pending = true ;
+    while (pending) {
+        pending = false ;
+        for (int i = 0 ; i < height ; i++) {
+            if (!rowDirty[i]) continue ;
+            rowDirty[i] = 0 ;
+            signed char * row = cells + i*width ;
+            memcpy(before, row, width) ;
+            const int settled = linesolve_line(&rows[i], row, 1, width, scratch) ;
+            if (settled < 0) goto contradiction ;
+            if (settled == 0) continue ;
+            for (int j = 0 ; j < width ; j++) {
+                if (row[j] != before[j]) columnDirty[j] = 1 ;
+            }
+            pending = true ;
+        }
+        for (int j = 0 ; j < width ; j++) {
+            if (!columnDirty[j]) continue ;
+            columnDirty[j] = 0 ;
+            for (int i = 0 ; i < height ; i++) before[i] = cells[i*width + j] ;
+            const int settled = linesolve_line(&columns[j], cells + j, width, height, scratch) ;
+            if (settled < 0) goto contradiction ;
+            if (settled == 0) continue ;
+            for (int i = 0 ; i < height ; i++) {
+                if (cells[i*width + j] != before[i]) rowDirty[i] = 1 ;
+            }
+            pending = true ;
+        }
+    }
+
+    int settled = 0 ;
+    for (int k = 0 ; k < height*width ; k++) settled += cells[k] != CELL_UNKNOWN ;
+    arena_release(scratch, start) ;
+    return settled ;
+
+contradiction:
+    arena_release(scratch, start) ;
+    return -1 ;
+}
+
+lineSegment linesolve_segment (const description * d, const signed char * cells, int stride, int lineLength)
+{
+    lineSegment segment = {0, lineLength, *d} ;
+
+    // The settled prefix is [0,u) and the settled suffix [v,l)
+    int u = 0 ;
+    while (u < lineLength && cells[u*stride] != CELL_UNKNOWN) u++ ;
+    if (u == lineLength) {
+        segment.length = 0 ;
+        segment.rest.length = 0 ;
+        segment.rest.total = 0 ;
+        return segment ;
+    }
+    int v = lineLength ;
+    while (cells[(v - 1)*stride] != CELL_UNKNOWN) v-- ;
+
+    // Only the runs closed off by an empty cell are known to be whole
+    int first = 0, lo = 0, run = 0 ;
+    for (int k = 0 ; k < u ; k++) {
+        if (cells[k*stride] == CELL_FILLED) {
+            run += 1 ;
+        } else {
+            first += run > 0 ;
+            run = 0 ;
+            lo = k + 1 ;
+        }
+    }
+    int last = 0, hi = lineLength ;
+    run = 0 ;
+    for (int k = lineLength - 1 ; k >= v ; k--) {
+        if (cells[k*stride] == CELL_FILLED) {
+            run += 1 ;
+        } else {
+            last += run > 0 ;
+            run = 0 ;
+            hi = k ;
+        }
+    }
+    if (first + last > d->length) return segment ; // settled cells that do not fit d
+
+    segment.start = lo ;
+    segment.length = hi - lo ;
+    segment.rest.runs = d->runs + first ;
+    segment.rest.length = d->length - first - last ;
+    segment.rest.total = 0 ;
+    for (int j = 0 ; j < segment.rest.length ; j++) segment.rest.total += segment.rest.runs[j] ;
+    return segment ;
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+#include "nonogram.h"
+
+/*
+A line solver settles the cells of a line that every filling consistent with its description (and
+with the cells already settled) agrees on. Solving the rows and columns of a board in turn until no
+line changes settles everything that line-by-line reasoning can, which for many random boards is
+most of the board and often all of it. The encoder writes the settled cells as unit clauses and
+only encodes what is left of each line (see linesolve_segment), so the solver gets a smaller
+formula with the easy part of the puzzle already done.
+
+Cells are signed chars, one per cell of a board in row-major order, holding one of
+*/
+#define CELL_UNKNOWN 0
+#define CELL_FILLED 1
+#define CELL_EMPTY -1
+
+/*
+The part of a line left to encode once its settled ends are taken off. Each field:
+
+    start --> the first cell of the segment
+    length --> the number of cells in the segment (0 when the whole line is settled)
+    rest --> the runs of the description that fall inside the segment (pointing into the line's runs)
+*/
+typedef struct lineSegment {
+    int start ;
+    int length ;
+    description rest ;
+} lineSegment ;
+
+/*
+    Settle the cells of the line with description d, whose cell k is cells[k*stride], exactly: a cell
+    is settled when it is filled in every consistent filling of the line, or empty in every one.
+    Returns: the number of cells newly settled, or -1 if no filling is consistent with the settled cells
+*/
+int linesolve_line (const description * d, signed char * cells, int stride, int lineLength, Arena * scratch) ;
+
+/*
+    Solve the rows and columns of the height*width board in cells (row-major) to a fixpoint, only
+    solving a line again once one of its cells has been settled by a crossing line.
+    Returns: the number of cells settled, or -1 if the descriptions contradict each other
+*/
+int linesolve_board (const description * rows, const description * columns, int height, int width, signed char * cells, Arena * scratch) ;
+
+/*
+    Take the settled ends off the line with description d. A settled prefix ending in an empty cell
+    holds the first runs of d in full, so the line is left with the cells after it and the runs after
+    those (and the same for a settled suffix).
+    Returns: the segment of the line still to be encoded
+*/
+lineSegment linesolve_segment (const description * d, const signed char * cells, int stride, int lineLength) ;
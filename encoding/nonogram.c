@@ -0,0 +1,666 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "nonogram.h"
+
+/*
+The kernels that loop over a line are written once against a line length parameter and then
+dispatched on that length. The sizes used in the phase transition sweep each get their own copy
+with the length as a compile time constant, so the loops over a line can be unrolled and
+vectorized. Any other length falls through to the generic copy.
+*/
+#define KERNEL static inline __attribute__((always_inline))
+#define DISPATCH_LENGTH(kernel, length, ...) \
+    switch (length){ \
+        case 10: return kernel(__VA_ARGS__, 10) ; \
+        case 15: return kernel(__VA_ARGS__, 15) ; \
+        case 20: return kernel(__VA_ARGS__, 20) ; \
+        case 25: return kernel(__VA_ARGS__, 25) ; \
+        case 30: return kernel(__VA_ARGS__, 30) ; \
+        case 40: return kernel(__VA_ARGS__, 40) ; \
+        default: return kernel(__VA_ARGS__, length) ; \
+    }
+
+description newDescription(int maxRuns, Arena * scratch){
+    description d ;
+    d.runs = arena_ints(scratch,maxRuns) ;
+    d.length = 0 ;
+    d.total = 0 ;
+    return d ;
+}
+
+void appendDescription(description * d,int runLength){
+    d->runs[d->length] = runLength ;
+    d->length += 1 ;
+    d->total += runLength ;
+    return ;
+}
+
+void printDescription(const description * d){
+    if (d->length == 0){
+        return ;
+    }
+    printf("< ") ;
+    for (int j = 0 ; j < d->length ; j++){
+        printf("%d ",d->runs[j]) ;
+    }
+    printf(">\n") ;
+    return ;
+}
+
+/* NOT USED ---- (you need to generate an entire board, can't do it one line at a time)
+descriptionNode * generateDescription(double p,MTRand seed){
+    descriptionNode * head = malloc(sizeof(descriptionNode)) ;
+    head->length = 0 ;
+    int currentRun = 0 ;
+    bool currentlyRunning = false ;
+
+    for (int i = 0 ; i < N ; i++){
+        if (genRand(&seed) < p){
+            currentRun += 1 ;
+            currentlyRunning = true ;
+        } else {
+            if (currentlyRunning){
+                appendDescription(head,currentRun) ;
+                currentlyRunning = false ;
+                currentRun = 0 ;
+            }
+        }
+    }
+
+    if (currentlyRunning){
+        appendDescription(head,currentRun) ;
+    }
+    if (head->tail == NULL){
+        free(head) ;
+        return NULL ;
+    } else {
+        return head ;
+    }
+} */
+
+int stateCount(const description * d){
+    // One state for each filled cell of the runs, and one more for each run
+    return d->total + d->length ;
+}
+
+/* NOT USED --- (incorporated into buildNFA)
+int * transitions(descriptionNode * d){
+    int states = stateCount(d) ; // Number of states in the NFA
+    int * mat = malloc(states * states * sizeof(int)) ; // Malloc the transition set
+    for (int i = 0 ; i < states * states ; i++){ // Initialize values to -1 to prevent errors when filling in with real values
+        mat[i] = -1 ;
+    }
+
+    int l_LEQ_j = 0 ;
+
+    mat[0] = 0 ; // Self-loop on zero from the first state back to the first state
+
+    for (int k = 0 ; k < d->val ; k++){ // Transitions for the first run (j=0)
+        mat[k*states + k + 1] = 1;
+    }
+
+    l_LEQ_j += d->val ;
+    descriptionNode * temp = d->next ;
+    for (int j = 1 ; j < d->length ; j++){
+        int index1 = l_LEQ_j + j + (l_LEQ_j + j) * states ; // Set 1 for the transition set
+        if (mat[index1] == -1){
+            mat[index1] = 0 ;
+        } else {
+            mat[index1] = 2 ;
+        }
+
+        for (int k = 0 ; k < temp->val ; k++){ // Set 2 for the transition set
+            int index2 = l_LEQ_j + j + (l_LEQ_j + j)*states + k*states + k + 1 ;
+            if (mat[index2] == -1){
+                mat[index2] = 1 ;
+            } else {
+                mat[index2] = 2 ;
+            }
+        }
+        
+        int index3 = l_LEQ_j + j + (l_LEQ_j + j-1)*(states) ; // Set 3 for the transition set
+        if (mat[index3] == -1){
+            mat[index3] = 0 ;
+        }  else {
+            mat[index3] = 2 ;
+        }
+        l_LEQ_j += temp->val ;
+        temp = temp->next ;
+    }
+    mat[states*states - 1] = 0 ; // Set 3 for j=t
+
+    return mat ;
+}
+*/
+nfa * buildNFA(const description * d, Arena * scratch){
+    nfa * NFA = arena_alloc(scratch,sizeof(nfa)) ;
+
+    NFA->states = stateCount(d) ; // Get the number of states
+
+    // Get ready to build the automata
+    int * selfLoops = arena_ints(scratch,NFA->states) ;
+    int * incomingOnes = arena_ints(scratch,NFA->states) ;
+    int * incomingZeros = arena_ints(scratch,NFA->states) ;
+
+    for (int i = 0 ; i < NFA->states ; i++){ // Initialize to Zero (no transition)
+        selfLoops[i] = 0 ;
+        incomingOnes[i] = 0 ;
+        incomingZeros[i] = 0 ;
+    }
+
+    // Assign to the NFA
+    NFA->selfZeros = selfLoops ;
+    NFA->inOnes = incomingOnes ;
+    NFA->inZeros = incomingZeros ;
+
+    // sets 1,2,3 are labelled in section 2.3
+    NFA->selfZeros[0] = 1 ; // State zero always has a self-loop (set 1 for j = 0)
+    for (int k = 0 ; k < d->runs[0] ; k++){ // set 2 for j = 0
+        NFA->inOnes[k+1] = 1 ;
+    }
+    NFA->selfZeros[NFA->states - 1] = 1 ; // set 3 for j=t
+
+    int l_LEQ_j = d->runs[0] ;
+
+    for (int j = 1 ; j < d->length ; j++){
+        NFA->selfZeros[l_LEQ_j + j] = 1 ; // set 1
+
+        for (int k = 0 ; k < d->runs[j] ; k++){ // set 2
+            NFA->inOnes[l_LEQ_j + j + k + 1] = 1 ;
+        }
+
+        NFA->inZeros[l_LEQ_j + j] = 1 ; // set 3
+
+        l_LEQ_j += d->runs[j] ;
+    }
+
+    return NFA ;
+}
+
+void printNFA(nfa * n ){
+    printf("States: %d\n",n->states) ;
+    
+    if (n->selfZeros[0] == 1){
+        printf("(0,0,0)\n") ;
+    } else {
+        printf("SOMETHING IS WRONG!\n") ;
+        return ;
+    }
+
+    for (int i = 1 ; i <= n->states ; i++){
+        if (n->selfZeros[i] == 1){
+            printf("(%d,0,%d)\n",i,i) ;
+        }
+        if (n->inOnes[i] == 1){
+            printf("(%d,1,%d)\n",i-1,i) ;
+        }
+        if (n->inZeros[i] == 1){
+            printf("(%d,0,%d)\n",i-1,i) ;
+        }
+    }
+    return ;
+}
+
+/*
+The constraint kernel writes either the full encoding of section 2.3 or its pruned form. In the
+full encoding every state has a variable at every position. But a state can only be reached once
+enough cells have been read to get to it, and only while enough cells remain to finish the
+description from it. State i needs at least i cells to reach, and S-1-i more to get to the final
+state, so after k cells it can only be occupied when
+
+    i <= k <= i + slack,    where slack = lineLength - (S-1)
+
+The pruned form only has variables for states inside these windows, and transitions between
+them, and leaves out every literal and clause that would involve one of the missing variables
+(they are all false in any accepting run). The full form is the pruned one with every window the
+whole line.
+*/
+KERNEL int buildConstraintKernel(nfa * n, int * stringVars, int * varIndex, const description * d, ClauseSink * out, Arena * scratch, const bool pruned, const int lineLength){
+    (void) d ;
+    // First we build up the variables that will be sampled from when building the formula
+    // (the tables only live for this line, so their memory is handed back at the end)
+    ArenaMark lineStart = arena_mark(scratch) ;
+    const int states = n->states ;
+    const int slack = lineLength - (states - 1) ;
+
+    // A state variable is 0 when the state cannot be occupied at that position
+    int * stateVars = arena_ints(scratch,(lineLength+1) * states) ;
+    for (int k = 0 ; k <= lineLength ; k++){
+        for (int i = 0 ; i < states ; i++){
+            if (!pruned || (i <= k && k <= i + slack)){
+                stateVars[k*states + i] = *varIndex ;
+                *varIndex = *varIndex + 1 ;
+            } else {
+                stateVars[k*states + i] = 0 ;
+            }
+        }
+    }
+
+    // Transition variables (into state i on reading cell k) exist when the automaton has the
+    // transition and the states at both of its ends have variables
+    int * transitionVars = arena_ints(scratch,2 * lineLength * states) ;
+    for (int k = 0 ; k < lineLength ; k++){
+        for (int i = 0 ; i < states ; i++){
+            const bool target = stateVars[(k+1)*states + i] != 0 ;
+            const bool fromSelf = stateVars[k*states + i] != 0 ;
+            const bool fromPrevious = i > 0 && stateVars[k*states + i - 1] != 0 ;
+            if (target && ((n->selfZeros[i] == 1 && fromSelf) || (n->inZeros[i] == 1 && fromPrevious))){
+                transitionVars[2*k*states + i] = *varIndex ;
+                *varIndex = *varIndex + 1 ;
+            } else {
+                transitionVars[2*k*states + i] = 0 ;
+            }
+            if (target && n->inOnes[i] == 1 && fromPrevious){
+                transitionVars[(2*k+1)*states + i] = *varIndex ;
+                *varIndex = *varIndex + 1 ;
+            } else {
+                transitionVars[(2*k+1)*states + i] = 0 ;
+            }
+        }
+    }
+
+    // Now let's print out each to see if it's being developed properly
+    /*
+    printf("String Variables:\n") ;
+    for (int i = 0 ; i < lineLength ; i++){
+        printf("%d ",stringVars[i]) ;
+    }
+    printf("\nState Variables:\n") ;
+    for (int i = 0 ; i < (lineLength+1)*n->states ; i++){
+        printf("%d ",stateVars[i]) ;
+    }
+    printf("\nTransition Variables:\n") ;
+    for (int i = 0 ; i < 2*lineLength*n->states ; i++){
+        printf("%d ",transitionVars[i]) ;
+    }
+    printf("\n") ; */
+
+    // Build up the formula, one clause at a time
+    int clauses = 0 ;
+    for (int k = 0 ; k < lineLength ; k++){
+        // First Constraint
+        for (int i = 0 ; i < states ; i++){
+            if (transitionVars[2*k*states + i] != 0){
+                sink_binary(out,-transitionVars[2*k*states + i],-stringVars[k]) ;
+                sink_binary(out,-transitionVars[2*k*states + i],stateVars[(k+1)*states + i]) ;
+                clauses += 2 ;
+            }
+            if (transitionVars[(2*k+1)*states + i] != 0){
+                sink_binary(out,-transitionVars[(2*k+1)*states + i],stringVars[k]) ;
+                sink_binary(out,-transitionVars[(2*k+1)*states + i],stateVars[(k+1)*states + i]) ;
+                clauses += 2 ;
+            }
+        }
+        // Second Constraint
+        for (int i = 0 ; i < states ; i++){
+            if (stateVars[k*states + i] == 0){
+                continue ;
+            }
+            sink_lit(out,-stateVars[k*states + i]) ;
+            if (n->selfZeros[i] != 0 && transitionVars[2*k*states + i] != 0){ // zero self-loop transition
+                sink_lit(out,transitionVars[2*k*states + i]) ;
+            }
+            if (i != states - 1){
+                if (transitionVars[(2*k+1)*states + i + 1] != 0){
+                    sink_lit(out,transitionVars[(2*k+1)*states + i + 1]) ;
+                }
+                if (n->inZeros[i+1] != 0 && transitionVars[2*k*states + i + 1] != 0){
+                    sink_lit(out,transitionVars[2*k*states + i + 1]) ;
+                }
+            }
+            sink_end(out) ;
+            clauses += 1 ;
+        }
+        // Third Constraint
+        for (int i = 0 ; i < states ; i++){
+            if (stateVars[(k+1)*states + i] == 0){
+                continue ;
+            }
+            sink_lit(out,-stateVars[(k+1)*states + i]) ;
+            if (transitionVars[2*k*states + i] != 0){
+                sink_lit(out,transitionVars[2*k*states + i]) ;
+            }
+            if (transitionVars[(2*k+1)*states + i] != 0){
+                sink_lit(out,transitionVars[(2*k+1)*states + i]) ;
+            }
+            sink_end(out) ;
+            clauses += 1 ;
+        }
+        
+        // Fourth Constraint
+        sink_lit(out,stringVars[k]) ;
+        for (int i = 0 ; i < states ; i++){
+            if (transitionVars[2*k*states + i] != 0){
+                sink_lit(out,transitionVars[2*k*states + i]) ;
+            }
+        }
+        sink_end(out) ;
+        sink_lit(out,-stringVars[k]) ;
+        for (int i = 0 ; i < states ; i++){
+            if (transitionVars[(2*k+1)*states + i] != 0){
+                sink_lit(out,transitionVars[(2*k+1)*states + i]) ;
+            } 
+        }
+        sink_end(out) ;
+        clauses += 2 ;
+        
+        // Fifth Constraint
+        for (int i = 0 ; i < states ; i++){
+            if (transitionVars[2*k*states + i] != 0){
+                sink_lit(out,-transitionVars[2*k*states + i]) ;
+                if (n->inZeros[i] != 0 && stateVars[k*states + i - 1] != 0){
+                    sink_lit(out,stateVars[k*states + i - 1]) ;
+                }
+                if (n->selfZeros[i] != 0 && stateVars[k*states + i] != 0){
+                    sink_lit(out,stateVars[k*states + i]) ;
+                }
+                sink_end(out) ;
+                clauses += 1 ;
+            }
+            if (transitionVars[(2*k+1)*states + i] != 0){
+                sink_binary(out,-transitionVars[(2*k+1)*states + i],stateVars[k*states + i - 1]) ;
+                clauses += 1 ;
+            }
+            
+        }
+    }
+    // Sixth Constraint (none of these variables exist in the pruned form)
+    for (int i = 1 ; i < states ; i++){
+        if (stateVars[i] != 0){
+            sink_unit(out,-stateVars[i]) ;
+            clauses += 1 ;
+        }
+    }
+    for (int i = states * lineLength ; i < states * (lineLength+1) - 1 ; i++){
+        if (stateVars[i] != 0){
+            sink_unit(out,-stateVars[i]) ;
+            clauses += 1 ;
+        }
+    }
+    arena_release(scratch,lineStart) ;
+    return clauses ;
+    
+}
+
+int buildConstraint(nfa * n, int * stringVars, int * varIndex, const description * d, int lineLength, ClauseSink * out, Arena * scratch){
+    DISPATCH_LENGTH(buildConstraintKernel,lineLength,n,stringVars,varIndex,d,out,scratch,false)
+}
+
+int buildPrunedConstraint(nfa * n, int * stringVars, int * varIndex, const description * d, int lineLength, ClauseSink * out, Arena * scratch){
+    DISPATCH_LENGTH(buildConstraintKernel,lineLength,n,stringVars,varIndex,d,out,scratch,true)
+}
+
+int clauseCount(const description * d, int lineLength){
+    int t = d->length ; // the number of runs
+    int s = d->total ; // the total length of the runs
+    return (5*lineLength+2)*(t+1+s) - 4 ; // return the recurrence (section 2.4)
+}
+int formulaVarCount(const description * d, int lineLength){
+    int t = d->length ; // the number of runs
+    int s = d->total ; // the total length of the runs
+    return (13*lineLength+2)*t+9*lineLength-2+(11*lineLength+2)*s ; // the recurrence of section 2.4, less the lineLength*(t-1) literals it overcounts
+}
+int uniqueVarCount(const description * d, int lineLength){
+    int t = d->length ; // the number of runs
+    int s = d->total ; // the total length of the runs
+    return (2*lineLength+1)*(t+s) + lineLength ; // return the recurrence (section 2.4)
+}
+/*
+In the pruned form every state has slack+1 positions, and every transition slack+1 steps, except
+the zero self-loops of the first and last states, which have slack steps (see buildConstraintKernel).
+The sixth constraint disappears, and the second and third each lose a clause, since the final
+state cannot be left before the end of the line and the first cannot be entered after its start.
+*/
+int prunedClauseCount(const description * d, int lineLength){
+    int S = d->total + d->length ; // the number of states
+    int w = lineLength - (S - 1) ; // the slack
+    int transitions = (S - 1)*(w + 1) + 2*w ;
+    return 3*transitions + 2*(S*(w + 1) - 1) + 2*lineLength ;
+}
+int prunedVarCount(const description * d, int lineLength){
+    int S = d->total + d->length ;
+    int w = lineLength - (S - 1) ;
+    return S*(w + 1) + (S - 1)*(w + 1) + 2*w ;
+}
+
+int stateVarCount(const description * d, int lineLength){
+    return (lineLength + 1)*stateCount(d) ;
+}
+int prunedStateVarCount(const description * d, int lineLength){
+    int S = stateCount(d) ;
+    return S*(lineLength - (S - 1) + 1) ;
+}
+
+const lineEncoding automatonEncoding = {buildConstraint, clauseCount, uniqueVarCount, NULL, false, true} ;
+const lineEncoding prunedEncoding = {buildPrunedConstraint, prunedClauseCount, prunedVarCount, NULL, false, true} ;
+const lineEncoding eliminatedEncoding = {buildConstraint, NULL, NULL, stateVarCount, false, true} ;
+const lineEncoding prunedEliminatedEncoding = {buildPrunedConstraint, NULL, NULL, prunedStateVarCount, false, true} ;
+
+int * randomFilled(float p, MTRand seed, int size){
+    int * tiles = malloc(sizeof(int)*size*size) ;
+    for (int i = 0 ; i < size*size ; i++){
+        if (genRand(&seed) < p){
+            tiles[i] = 1 ;
+        } else {
+            tiles[i] = 0 ;
+        }
+    }
+    return tiles ;
+}
+
+KERNEL int * transposeKernel(int * matrixList, const int size){
+    for (int i = 0 ; i < size ; i++){
+        for (int j = i + 1 ; j < size ; j++){
+            int t = matrixList[i*size + j] ;
+            matrixList[i*size + j] = matrixList[j*size + i] ;
+            matrixList[j*size + i] = t ;
+        }
+    }
+    return matrixList ;
+}
+
+int * transpose(int * matrixList, int size){
+    DISPATCH_LENGTH(transposeKernel,size,matrixList)
+}
+
+KERNEL description * descriptionsFromBoardKernel(int * board, Arena * scratch, const int size){
+    description * descriptions = arena_alloc(scratch,size*sizeof(description)) ;
+    // A line has at most (size+1)/2 runs, so the runs of every line fit in one block at a fixed stride
+    const int maxRuns = (size + 1)/2 ;
+    int * runs = arena_ints(scratch,size*maxRuns) ;
+    // There are N rows or N columns to get descriptions for
+    for (int i = 0 ; i < size ; i++){
+        descriptions[i].runs = runs + i*maxRuns ; // start off with no description elements
+        descriptions[i].length = 0 ;
+        descriptions[i].total = 0 ;
+        int currentRun = 0 ; // zero-length run to start
+        bool currentlyRunning = false ; // not in a run to start
+
+        for (int j = i*size ; j < (i+1)*size ; j++){
+            if (board[j] == 1){ // If you see a filled cell
+                currentRun += 1 ;
+                currentlyRunning = true ;
+            } else {
+                // If you had been seeing filled cells, you've reached the end of a run and can add it to the description
+                if (currentlyRunning){ 
+                    appendDescription(&descriptions[i],currentRun) ;
+                    currentlyRunning = false ;
+                    currentRun = 0 ;
+                }
+            }
+        }
+        // If you end and are running, add that to the description as well
+        if (currentlyRunning){
+            appendDescription(&descriptions[i],currentRun) ;
+        }
+    }
+    return descriptions ;
+}
+
+description * descriptionsFromBoard(int * board, int size, Arena * scratch){
+    DISPATCH_LENGTH(descriptionsFromBoardKernel,size,board,scratch)
+}
+
+int boardWords(int size){
+    return (size + 63)/64 ;
+}
+
+/*
+Transposes the 64x64 bit matrix a (row r is a[r], column c is bit c) in place. The two off diagonal
+32x32 blocks are swapped, then the off diagonal 16x16 blocks within each of the four, and so on
+down to single bits, so it takes six passes over the 64 words.
+*/
+static inline void transpose64(uint64_t * a){
+    uint64_t mask = 0x00000000FFFFFFFFULL ;
+    for (int j = 32 ; j != 0 ; j >>= 1, mask ^= mask << j){
+        for (int k = 0 ; k < 64 ; k = (k + j + 1) & ~j){
+            uint64_t t = ((a[k] >> j) ^ a[k + j]) & mask ;
+            a[k + j] ^= t ;
+            a[k] ^= t << j ;
+        }
+    }
+    return ;
+}
+
+KERNEL uint64_t * transposeBitsKernel(const uint64_t * board, uint64_t * transposed, const int size){
+    const int words = boardWords(size) ;
+    uint64_t block[64] ;
+    for (int bi = 0 ; bi < words ; bi++){ // block of rows
+        const int rows = size - 64*bi < 64 ? size - 64*bi : 64 ;
+        for (int bj = 0 ; bj < words ; bj++){ // block of columns
+            const int columns = size - 64*bj < 64 ? size - 64*bj : 64 ;
+            for (int r = 0 ; r < rows ; r++){
+                block[r] = board[(64*bi + r)*words + bj] ;
+            }
+            for (int r = rows ; r < 64 ; r++){ // Rows past the end of the board are empty
+                block[r] = 0 ;
+            }
+            transpose64(block) ;
+            for (int c = 0 ; c < columns ; c++){
+                transposed[(64*bj + c)*words + bi] = block[c] ;
+            }
+        }
+    }
+    return transposed ;
+}
+
+uint64_t * transposeBits(const uint64_t * board, uint64_t * transposed, int size){
+    DISPATCH_LENGTH(transposeBitsKernel,size,board,transposed)
+}
+
+/*
+The index of the first cell at or after `from` in a bit packed row of `words` words that is filled
+(or empty, if filled is false), or 64*words if there is none.
+*/
+static inline int nextCell(const uint64_t * row, int words, int from, bool filled){
+    int w = from >> 6 ;
+    if (w >= words){
+        return 64*words ;
+    }
+    uint64_t bits = (filled ? row[w] : ~row[w]) & (~0ULL << (from & 63)) ;
+    while (bits == 0){
+        w += 1 ;
+        if (w == words){
+            return 64*words ;
+        }
+        bits = filled ? row[w] : ~row[w] ;
+    }
+    return 64*w + __builtin_ctzll(bits) ;
+}
+
+KERNEL description * descriptionsFromBitsKernel(const uint64_t * board, Arena * scratch, const int size){
+    const int words = boardWords(size) ;
+    description * descriptions = arena_alloc(scratch,size*sizeof(description)) ;
+    const int maxRuns = (size + 1)/2 ;
+    int * runs = arena_ints(scratch,size*maxRuns) ;
+    for (int i = 0 ; i < size ; i++){
+        const uint64_t * row = board + i*words ;
+        descriptions[i].runs = runs + i*maxRuns ;
+        descriptions[i].length = 0 ;
+        descriptions[i].total = 0 ;
+
+        // A run goes from a filled cell to the next empty one (the zero bits past the row end one too)
+        int start = nextCell(row,words,0,true) ;
+        while (start < size){
+            int end = nextCell(row,words,start,false) ;
+            if (end > size){
+                end = size ;
+            }
+            appendDescription(&descriptions[i],end - start) ;
+            start = nextCell(row,words,end,true) ;
+        }
+    }
+    return descriptions ;
+}
+
+description * descriptionsFromBits(const uint64_t * board, int size, Arena * scratch){
+    DISPATCH_LENGTH(descriptionsFromBitsKernel,size,board,scratch)
+}
+
+KERNEL int emptyLineKernel(int * stringVars, ClauseSink * out, const int lineLength){
+    for (int i = 0 ; i < lineLength ; i++){
+        sink_unit(out,-stringVars[i]) ;
+    }
+    return lineLength ;
+    
+}
+
+void fillBoard(uint64_t * board, int N, float d, MTRand * seed){
+    const int words = boardWords(N) ;
+    for (int i = 0 ; i < N ; i++){
+        for (int w = 0 ; w < words ; w++){
+            // Each word is built up in a register and stored once
+            const int cells = N - 64*w < 64 ? N - 64*w : 64 ;
+            uint64_t bits = 0 ;
+            for (int j = 0 ; j < cells ; j++){
+                bits |= (uint64_t) (genRand(seed) < d) << j ;
+            }
+            board[i*words + w] = bits ;
+        }
+    }
+    return ;
+}
+
+void fillField(double * field, int N, MTRand * seed){
+    for (int k = 0 ; k < N*N ; k++){
+        field[k] = genRand(seed) ;
+    }
+    return ;
+}
+
+void fieldBoard(uint64_t * board, int N, const double * field, float d){
+    const int words = boardWords(N) ;
+    for (int i = 0 ; i < N ; i++){
+        for (int w = 0 ; w < words ; w++){
+            const int cells = N - 64*w < 64 ? N - 64*w : 64 ;
+            const double * f = field + i*N + 64*w ;
+            uint64_t bits = 0 ;
+            for (int j = 0 ; j < cells ; j++){
+                bits |= (uint64_t) (f[j] < d) << j ;
+            }
+            board[i*words + w] = bits ;
+        }
+    }
+    return ;
+}
+
+unsigned long boardSeed(unsigned long seed, int densityIndex, int b){
+    /*
+    SplitMix64 finalizer over the packed (seed, density, board) triple. Neighbouring boards get
+    unrelated seeds, so their Mersenne twister streams do not overlap in any useful sense.
+    */
+    unsigned long long z = (unsigned long long) seed ;
+    z = z * 0x9E3779B97F4A7C15ULL + (unsigned long long) densityIndex ;
+    z = z * 0x9E3779B97F4A7C15ULL + (unsigned long long) b ;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL ;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL ;
+    z = z ^ (z >> 31) ;
+    return (unsigned long) (z & 0xffffffff) ;
+}
+
+int emptyLine(int * stringVars, int lineLength, ClauseSink * out){
+    DISPATCH_LENGTH(emptyLineKernel,lineLength,stringVars,out)
+}
@@ -0,0 +1,266 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "mtwister.h"
+#include "sink.h"
+#include "arena.h"
+
+/*
+The regular expression (automata) encoding of Nonogram lines from section 2.3, shared by the
+random board sweep in regExEncoding.c and the scraped puzzle converter in parseScrapedPuzzles.c.
+The formulae are written to a ClauseSink (see sink.h). Descriptions, automata and the variable
+tables of a line are all allocated from the caller's scratch arena (see arena.h), so there is
+nothing to free one by one: the caller resets the arena once the board is written.
+*/
+
+typedef struct description description ;
+typedef struct nfa nfa ;
+
+/*
+Descriptions are implemented as an array of run lengths. The descriptions of a board are made
+together, with the runs of all of its lines in one block, and the number of runs and their total
+are kept alongside so the counting functions never have to walk the runs. Each field:
+    
+    runs --> the run lengths of the description, in order
+    length --> the number of runs in the description
+    total --> the sum of the run lengths
+*/
+struct description{
+    int * runs ;
+    int length ;
+    int total ;
+} ;
+
+/*
+The nfa struct is used to implement the automata version of the regular expression that 
+encodes the description. Due to the unique structure of the automata (Σ = {0,1}), the
+only possible transition arrows are from a zero or a one. Additionally, there will only
+ever be a transition from the previous state (s_{i} to s_{i+1}) so you can capture all
+of the necessary information to create the CNF formula with the three binary vectors
+inOnes,inZeros, and selfZeros. Each field:
+
+    states --> the number of states in the automata
+    inOnes --> inOnes[i] == 1 iff state i of the automata has an incoming one transition
+    inZeros --> inZeros[i] == 1 iff state i of the automata has an incoming zero transition
+    selfZeros --> selfZeros[i] == 1 iff state i of the automata has an incoming zero
+                    transition and that transition originates from state i (and not i-1)
+*/
+struct nfa {
+    int states ;
+    int * inOnes ;
+    int * inZeros ;
+    int * selfZeros ;
+} ;
+
+/*
+newDescription: int x Arena * -> description
+newDescription(k,a) = <>, the empty description with room for k runs (allocated from a)
+*/
+description newDescription(int maxRuns, Arena * scratch) ;
+
+/*
+appendDescription: description * x int -> void
+appendDescription([r_1,r_2,...,r_i],r) = [r_1,r_2,...,r_i,r]
+*/
+void appendDescription(description * d, int runLength) ;
+
+void printDescription(const description * d) ;
+
+//descriptionNode * generateDescription(double p,MTRand seed) ;
+
+/*
+stateCount: description * -> int
+stateCount(d) = s, the number of states in the automata representing d (as defined in section 2.3)
+*/
+int stateCount(const description * d) ;
+
+//int * transitions(descriptionNode * d) ;
+
+/*
+buildNFA: description * x Arena * -> nfa *
+buildNFA(d,a) = n, the automata representing d (as defined in section 2.3), allocated from a. Strings
+will be accepted by n if they fit the description d (for any size line).
+*/
+nfa * buildNFA(const description * d, Arena * scratch) ;
+void printNFA(nfa * n) ;
+
+/*
+buildConstraint: nfa * x int * x int * x description * x int x ClauseSink * x Arena * -> int
+buildConstraint(n,stringVariables,variableIndex,d,l,out,a) = c, after writing Ψ to out, where Ψ is satisfiable
+when there is a string input to n of length l that can be accepted, and c is the number of clauses in Ψ.
+
+The parameter stringVariables is an array of the variables that correspond to the cells in the board that d 
+is constraining (row 0 in an NxN board would be [x_0,...,x_{N-1}]). The parameter variableIndex is the minimum
+ index of a fresh variable in Ψ. The state and transition variable tables are taken from a and handed back
+before returning.
+*/
+int buildConstraint(nfa * n, int * stringVars, int * varIndex, const description * d, int lineLength, ClauseSink * out, Arena * scratch) ;
+
+/*
+buildPrunedConstraint: nfa * x int * x int * x description * x int x ClauseSink * x Arena * -> int
+buildPrunedConstraint(n,stringVariables,variableIndex,d,l,out,a) = c, the same as buildConstraint except
+that a state only has variables at the positions it can be occupied in. The first i cells are needed to
+reach state i and the cells after it have to fit the rest of d, so with S states state i is only possible
+after reading k cells when i <= k <= i + l - (S-1). Every other state variable, and every transition
+into or out of one, is left out (they are all false in an accepting run), along with the literals and
+clauses that mention them. Ψ has the same solutions over stringVariables in far fewer variables.
+*/
+int buildPrunedConstraint(nfa * n, int * stringVars, int * varIndex, const description * d, int lineLength, ClauseSink * out, Arena * scratch) ;
+
+/*
+clauseCount: description * x int -> int
+clauseCount(d,l) = c, the number of clauses in the CNF formula encoding the description d in a line of
+length l (as defined in section 2.3)
+*/
+int clauseCount(const description * d, int lineLength) ;
+
+/*
+formulaVarCount: description * x int -> int
+formulaVarCount(d,l) = v, the total number of variables in the CNF formula encoding the 
+description d in a line of length l (as defined in section 2.3), counted with repetition (the
+literals buildConstraint writes)
+*/
+int formulaVarCount(const description * d, int lineLength) ;
+
+/*
+uniqueVarCount: description * x int -> int
+uniqueVarCount(d,l) = v, the number of distinct variables in the CNF formula encoding the 
+description d in a line of length l (as defined in section 2.3)
+*/
+int uniqueVarCount(const description * d, int lineLength) ;
+
+/*
+prunedClauseCount, prunedVarCount: description * x int -> int
+The clauseCount and uniqueVarCount of the formula buildPrunedConstraint writes
+*/
+int prunedClauseCount(const description * d, int lineLength) ;
+int prunedVarCount(const description * d, int lineLength) ;
+
+/*
+stateVarCount, prunedStateVarCount: description * x int -> int
+The number of state variables buildConstraint and buildPrunedConstraint number before any transition
+variable (the transitions are numbered after all of them)
+*/
+int stateVarCount(const description * d, int lineLength) ;
+int prunedStateVarCount(const description * d, int lineLength) ;
+
+/*
+A line encoding bundles a constraint builder with the counts of the formulae it writes, which the
+callers need for the DIMACS header before any clause is written. Each field:
+
+    build --> writes the formula for a line (buildConstraint's signature)
+    clauses --> clauses(d,l) = the number of clauses build writes for d in a line of length l
+    vars --> vars(d,l) = the number of fresh variables build uses for d in a line of length l
+    keptVars --> NULL, or for an encoding whose transition variables are eliminated (see eliminate.h),
+                 keptVars(d,l) = the number of fresh variables build numbers before the transitions
+    positional --> whether the formula is laid out along the line (see layout.h), which changes the
+                   numbering of the fresh variables and the order of the clauses but not their counts
+    automaton --> whether build reads the automaton of the description it is given (if not, a line
+                  cache gives it NULL rather than building one)
+
+The formula of an encoding with keptVars is build's with the transitions eliminated, and is only
+written by a line cache (see linecache.h), which does the elimination once for each description
+(and the same goes for the positional layout).
+Its counts depend on what the elimination manages, so clauses and vars are NULL and the cache gives
+them instead (linecache_counts).
+
+automatonEncoding is the encoding of section 2.3 and prunedEncoding its positionally pruned form, and
+eliminatedEncoding and prunedEliminatedEncoding are the same with their transitions eliminated. Any
+of them can be copied and given the positional layout.
+*/
+typedef struct lineEncoding {
+    int (*build)(nfa * n, int * stringVars, int * varIndex, const description * d, int lineLength, ClauseSink * out, Arena * scratch) ;
+    int (*clauses)(const description * d, int lineLength) ;
+    int (*vars)(const description * d, int lineLength) ;
+    int (*keptVars)(const description * d, int lineLength) ;
+    bool positional ;
+    bool automaton ;
+} lineEncoding ;
+
+extern const lineEncoding automatonEncoding ;
+extern const lineEncoding prunedEncoding ;
+extern const lineEncoding eliminatedEncoding ;
+extern const lineEncoding prunedEliminatedEncoding ;
+
+/*
+randomFilled: float x MTRand x int -> int *
+randomFilled(p,seed,N) = B, an N*N-element binary vector representing a Nonogram board
+*/
+int * randomFilled(float p, MTRand r, int size) ;
+
+/*
+transpose: int * x int -> int *
+transpose(xs,N) = ys, where entry xs[i,j] == ys[j,i] for the N*N matrix xs (done in place)
+*/
+int * transpose(int * matrixList, int size) ;
+
+/*
+descriptionsFromBoard: int * x int x Arena * -> description *
+descriptionsFromBoard(B,N,a) = Ds, an array of Nonogram line descriptions for the rows of the N*N
+board B, with all of their runs in one block allocated from a
+*/
+description * descriptionsFromBoard(int * board, int size, Arena * scratch) ;
+
+/*
+Boards can also be bit packed, with each row of an N*N board stored as boardWords(N) 64-bit words.
+Cell (i,j) is bit j%64 of word j/64 of row i, and the bits past the end of a row are always zero.
+A 40x40 board is then 320 bytes rather than 6400, and a line is read a word at a time.
+*/
+
+/*
+boardWords: int -> int
+boardWords(N) = w, the number of 64-bit words in a row of a bit packed N*N board
+*/
+int boardWords(int size) ;
+
+/*
+transposeBits: uint64_t * x uint64_t * x int -> uint64_t *
+transposeBits(B,T,N) = T, after setting the bit packed N*N board T to the transpose of B. The board is
+transposed in 64x64 blocks, each with the usual log-step swap of ever smaller sub-blocks.
+*/
+uint64_t * transposeBits(const uint64_t * board, uint64_t * transposed, int size) ;
+
+/*
+descriptionsFromBits: uint64_t * x int x Arena * -> description *
+descriptionsFromBits(B,N,a) = Ds, the same descriptions as descriptionsFromBoard for the bit packed N*N
+board B. Each run is found with two count trailing zeros (its first filled and first empty cell)
+rather than a step per cell.
+*/
+description * descriptionsFromBits(const uint64_t * board, int size, Arena * scratch) ;
+
+/*
+fillBoard: uint64_t * x int x float x MTRand * -> void
+fillBoard(B,N,p,seed) fills the bit packed N*N board B (see nonogram.h), with each cell filled with
+probability p. Cells are drawn in row-major order, the same as for the original int boards.
+*/
+void fillBoard(uint64_t * board, int N, float d, MTRand * seed) ;
+
+/*
+fillField: double * x int x MTRand * -> void
+fieldBoard: uint64_t * x int x double * x float -> void
+fillField(F,N,seed) draws the uniform field F of an N*N board, one number for each cell in row-major
+order, and fieldBoard(B,N,F,p) fills the bit packed board B with the cells whose number is below p.
+The board is then the same as fillBoard draws from the same stream, and as p grows each board has
+all the filled cells of the one before, so a coupled sweep (regExEncoding -u) compares nested boards at every
+density rather than independent ones, which takes out much of the variance between neighbouring
+densities of the phase transition curve.
+*/
+void fillField(double * field, int N, MTRand * seed) ;
+void fieldBoard(uint64_t * board, int N, const double * field, float d) ;
+
+/*
+boardSeed: unsigned long x int x int -> unsigned long
+boardSeed(s,d,b) = the seed of the random stream for board b at density index d of the sweep with seed s.
+Giving every board its own stream makes the boards independent of the order they are generated in,
+so a multithreaded sweep (regExEncoding -t) writes the same files regardless of the number of threads.
+*/
+unsigned long boardSeed(unsigned long seed, int densityIndex, int b) ;
+
+/*
+emptyLine: int * x int x ClauseSink * -> int
+emptyLine(stringVariables,l,out) = l, after writing to out the l singleton clauses forcing every cell
+of an empty line to be empty
+*/
+int emptyLine(int * stringVars, int lineLength, ClauseSink * out) ;
@@ -0,0 +1,91 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <pthread.h>
+
+#include "queue.h"
+#include "trace.h"
+
+struct BoundedQueue {
+    void ** items ;     // a ring of capacity slots
+    int capacity ;
+    int head ;          // the oldest item
+    int count ;
+    int producers ;     // producers not done yet
+    pthread_mutex_t lock ;
+    pthread_cond_t notEmpty ;
+    pthread_cond_t notFull ;
+} ;
+
+BoundedQueue * queue_new (int capacity, int producers)
+{
+    BoundedQueue * queue = malloc(sizeof(BoundedQueue)) ;
+    if (!queue || capacity < 1 || !(queue->items = malloc(capacity*sizeof(void *)))) {
+        fprintf(stderr, "queue_new failed\n") ;
+        exit(1) ;
+    }
+    queue->capacity = capacity ;
+    queue->head = 0 ;
+    queue->count = 0 ;
+    queue->producers = producers ;
+    pthread_mutex_init(&queue->lock, NULL) ;
+    pthread_cond_init(&queue->notEmpty, NULL) ;
+    pthread_cond_init(&queue->notFull, NULL) ;
+    return queue ;
+}
+
+void queue_push (BoundedQueue * queue, void * item)
+{
+    pthread_mutex_lock(&queue->lock) ;
+    if (queue->count == queue->capacity) {
+        TRACE_START(waiting) ;
+        while (queue->count == queue->capacity) {
+            pthread_cond_wait(&queue->notFull, &queue->lock) ;
+        }
+        TRACE_WAIT(waiting, "queue full") ;
+    }
+    queue->items[(queue->head + queue->count) % queue->capacity] = item ;
+    queue->count += 1 ;
+    pthread_cond_signal(&queue->notEmpty) ;
+    pthread_mutex_unlock(&queue->lock) ;
+}
+
+void * queue_pop (BoundedQueue * queue)
+{
+    pthread_mutex_lock(&queue->lock) ;
+    if (queue->count == 0 && queue->producers > 0) {
+        TRACE_START(waiting) ;
+        while (queue->count == 0 && queue->producers > 0) {
+            pthread_cond_wait(&queue->notEmpty, &queue->lock) ;
+        }
+        TRACE_WAIT(waiting, "queue empty") ;
+    }
+    void * item = NULL ;
+    if (queue->count > 0) {
+        item = queue->items[queue->head] ;
+        queue->head = (queue->head + 1) % queue->capacity ;
+        queue->count -= 1 ;
+        pthread_cond_signal(&queue->notFull) ;
+    }
+    pthread_mutex_unlock(&queue->lock) ;
+    return item ;
+}
+
+void queue_done (BoundedQueue * queue)
+{
+    pthread_mutex_lock(&queue->lock) ;
+    queue->producers -= 1 ;
+    if (queue->producers == 0) {
+        pthread_cond_broadcast(&queue->notEmpty) ; // Wake every consumer waiting on an empty queue, to see it is finished
+    }
+    pthread_mutex_unlock(&queue->lock) ;
+}
+
+void queue_free (BoundedQueue * queue)
+{
+    if (!queue) return ;
+    pthread_mutex_destroy(&queue->lock) ;
+    pthread_cond_destroy(&queue->notEmpty) ;
+    pthread_cond_destroy(&queue->notFull) ;
+    free(queue->items) ;
+    free(queue) ;
+}
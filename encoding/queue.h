@@ -0,0 +1,26 @@
+#pragma once
+
+/*
+A bounded queue of pointers between the threads of two pipeline stages (see
+Experimental/pipeline.c). A push waits while the queue is full, so a stage that gets ahead of the
+one after it is held back rather than piling up work in memory, and a pop waits while it is empty.
+
+The queue knows how many threads push to it. Each says when it is done, and once the last one has
+and the queue has been emptied, every pop returns NULL, so the stage after it knows to finish.
+*/
+
+typedef struct BoundedQueue BoundedQueue ;
+
+// Allocate a queue holding at most capacity items, pushed to by producers threads. Returns: BoundedQueue*
+BoundedQueue * queue_new (int capacity, int producers) ;
+
+// Add item (not NULL) to the queue, waiting for room
+void queue_push (BoundedQueue * queue, void * item) ;
+
+// Take the oldest item, waiting for one. Returns: the item, or NULL once every producer is done and the queue is empty
+void * queue_pop (BoundedQueue * queue) ;
+
+// Say one of the producers has pushed its last item
+void queue_done (BoundedQueue * queue) ;
+
+void queue_free (BoundedQueue * queue) ;
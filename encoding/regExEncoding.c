@@ -2,762 +2,804 @@
 #include <stdlib.h>
 #include <stdbool.h>
 #include <string.h>
-#include <math.h>
+#include <limits.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <stdatomic.h>
 
 #include "mtwister.h"
-#include "buf.h"
-
-#define N 40 // The size of the board
-
-typedef struct descriptionNode descriptionNode ;
-typedef struct nfa nfa ;
-
+#include "sink.h"
+#include "nonogram.h"
+#include "archive.h"
+#include "arena.h"
+#include "linecache.h"
+#include "linesolve.h"
+#include "cardinality.h"
+#include "linehistory.h"
+#include "stream.h"
+#include "checkpoint.h"
+#include "stats.h"
+#include "trace.h"
+
+#define DEFAULT_SIZE 40 // The size of the board when none is given with -n
+#define BOARDS 500 // The number of boards generated at each density
+#define SEED 32 // Seed of the sweep (the single stream, or the root of the per-board streams)
+#define SCRATCH_SIZE (1 << 16) // Initial size of each thread's scratch arena, which grows to fit the largest board
+#define CACHE_LITERALS (1 << 22) // Template literals each thread's line cache holds before it is emptied
+#define CHECKPOINT_FORMULAE 100 // Roughly how many formulae are written between checkpoints (with -k)
+#define STATS_FILE "regExEncodingStats.json" // Where a build with -DSTATS writes its counters (see stats.h)
+#define TRACE_FILE "regExEncodingTrace.json" // Where a build with -DTRACE writes its timeline (see trace.h)
+
+typedef struct sweep sweep ;
 
 /*
-Descriptions are implemented as a linked list. To allow for constant time appending, each node
-tracks the tail, as well as the length. Each field:
-    
-    val --> the integer value of the description
-    next --> the next description element
-    tail --> the final description element (NULL if not set)
-    length --> the length of the description
+The sweep struct is the state of a sweep, shared by the workers when it is multithreaded. Jobs are
+the (density, board) pairs numbered density-major, and each worker claims the next unclaimed job
+until all of them are gone. Formulae going into an archive are added strictly in job order, so the
+archive is the same whatever order the workers finish in. Each field:
+
+    size --> the size of the board
+    densities --> the filled cell densities of the sweep
+    densityTotal --> the number of densities
+    nextJob --> the index of the next job to be claimed
+    archivePath --> the archive to write (NULL writes one file per board). A path containing %d
+                    gets one archive per density, with the density index substituted
+    archive --> the archive currently being written
+    archiveDensity --> the density index of the archive being written (0 for a whole sweep archive)
+    nextCommit --> the job whose formula is the next to go into the archive
+    commitLock, committed --> guard nextCommit and signal when it moves on
+    binary --> whether formulae are written in the binary format of bincnf.h rather than DIMACS text
+    encoding --> how each line is encoded (see lineEncoding in nonogram.h)
+    presolve --> whether the lines are solved first, writing the cells they settle as singleton clauses
+    cardinality --> the implied cardinality constraints added to each formula (CARDINALITY_LINES and/or CARDINALITY_BOARD)
+    coupled --> whether the boards of each board index are nested across the densities (see fieldBoard), in
+                which case the jobs are the board indices, each encoding its board at every density in turn
+    stream --> whether each formula is streamed straight to its file with 64-bit counts (see stream.h)
+               rather than built in memory first
+    rng --> the single random stream the boards are drawn from, when the sweep is not multithreaded
+            (NULL when every board has its own stream)
+    checkpointPath --> where checkpoints are written (NULL takes none, see checkpoint.h)
+    checkpointKey --> the options of the sweep, which a checkpoint has to have been taken with to be resumed
+    checkpointEvery --> the units finished in order between checkpoints
+    units --> the number of units of the sweep: the jobs, or the board indices of a coupled sweep
+    finished --> which units have all of their formulae written
+    finishedCount --> how many units are finished in order (the position of a checkpoint)
 */
-struct descriptionNode{
-    int val ;
-    descriptionNode * next ;
-    descriptionNode * tail ;
-    int length ;
+struct sweep {
+    int size ;
+    float * densities ;
+    int densityTotal ;
+    atomic_int nextJob ;
+    const char * archivePath ;
+    ArchiveWriter * archive ;
+    int archiveDensity ;
+    int nextCommit ;
+    pthread_mutex_t commitLock ;
+    pthread_cond_t committed ;
+    bool binary ;
+    const lineEncoding * encoding ;
+    bool presolve ;
+    int cardinality ;
+    bool coupled ;
+    bool stream ;
+    MTRand * rng ;
+    const char * checkpointPath ;
+    const char * checkpointKey ;
+    int checkpointEvery ;
+    int units ;
+    bool * finished ;
+    int finishedCount ;
 } ;
 
 /*
-The nfa struct is used to implement the automata version of the regular expression that 
-encodes the description. Due to the unique structure of the automata (Σ = {0,1}), the
-only possible transition arrows are from a zero or a one. Additionally, there will only
-ever be a transition from the previous state (s_{i} to s_{i+1}) so you can capture all
-of the necessary information to create the CNF formula with the three binary vectors
-inOnes,inZeros, and selfZeros. Each field:
-
-    states --> the number of states in the automata
-    inOnes --> inOnes[i] == 1 iff state i of the automata has an incoming one transition
-    inZeros --> inZeros[i] == 1 iff state i of the automata has an incoming zero transition
-    selfZeros --> selfZeros[i] == 1 iff state i of the automata has an incoming zero
-                    transition and that transition originates from state i (and not i-1)
+encodeBoard: uint64_t * x int x bool x int x ClauseSink * x Arena * x LineCache * x LineHistory * -> void
+encodeBoard(B,N,pre,card,out,a,c,h) writes the CNF formula encoding the bit packed N*N board B to out, with
+all of its scratch memory taken from a (which the caller resets between boards), and each line written
+from its template in the line cache c (so encoded by the encoding c was made for). If pre is set,
+the rows and columns are first solved to a fixpoint (see linesolve.h): the cells they settle are written
+as singleton clauses ahead of the lines, settled lines are left out, and every other line only encodes
+the part left between its settled ends. Then come the cardinality constraints card asks for (see
+cardinality.h): that each line has as many of its cells left unsettled filled as its description leaves
+over, and that the board has as many of its unsettled cells filled as all the row descriptions leave over.
+If h is not NULL, it holds the lines of the board encoded before (see linehistory.h), and every line that
+is the same as it was there is written from its clauses in h rather than from the cache.
 */
-struct nfa {
-    int states ;
-    int * inOnes ;
-    int * inZeros ;
-    int * selfZeros ;
-} ;
-
-/*
-appendDescription: descriptionNode * x int -> void
-appendDescription([r_1,r_2,...,r_i],r) = [r_1,r_2,...,r_i,r]
-*/
-void appendDescription(descriptionNode * d, int runLength) ;
-
-void printDescription(descriptionNode * d) ;
-
-//descriptionNode * generateDescription(double p,MTRand seed) ;
+void encodeBoard(const uint64_t * board, int N, bool presolve, int cardinality, ClauseSink * out, Arena * scratch, LineCache * cache, LineHistory * history) ;
 
 /*
-stateCount: descriptionNode * -> int
-stateCount(d) = s, the number of states in the automata representing d (as defined in section 2.3)
+streamBoard: sweep * x uint64_t * x int x int x Arena * x LineCache * -> void
+streamBoard(s,B,d,b,a,c) writes the formula of the bit packed board B, board b of density index d of
+the sweep s, straight to its own file with stream_board (see stream.h), a line at a time.
 */
-int stateCount(descriptionNode * d) ;
-
-//int * transitions(descriptionNode * d) ;
+void streamBoard(sweep * s, const uint64_t * board, int densityIndex, int b, Arena * scratch, LineCache * cache) ;
 
 /*
-buildNFA: descriptionNode * -> nfa *
-buildNFA(d) = n, the automata representing d (as defined in section 2.3). Strings will be accepted by
-n if they fit the description d (for any size line).
+writeBoard: sweep * x uint64_t * x int x int x ClauseSink * x Arena * x LineCache * x LineHistory * -> void
+writeBoard(s,B,d,b,out,a,c,h) writes the formula of the bit packed board B as board b of density index d
+of the sweep s: streamed if the sweep streams, and otherwise built in out with encodeBoard (with the
+line history h, which may be NULL) and then committed.
 */
-nfa * buildNFA(descriptionNode * d) ;
-void printNFA(nfa * n) ;
+void writeBoard(sweep * s, const uint64_t * board, int densityIndex, int b, ClauseSink * out, Arena * scratch, LineCache * cache, LineHistory * history) ;
 
 /*
-buildConstraint: nfa * x int x int x descriptionNode * -> Buf
-buildConstraint(n,stringVariables,variableIndex,d) = Ψ, where Ψ is satisfiable when there is a string input
-to n that can be accepted. 
-
-The parameter stringVariables is an array of the variables that correspond to the cells in the board that d 
-is constraining (row 0 in an NxN board would be [x_0,...,x_{N-1}]). The parameter variableIndex is the minimum
- index of a fresh variable in Ψ.
+boardPath: sweep * x int x int x char * x size_t -> char *
+boardPath(s,d,b,path,n) = path, holding the path (at most n bytes) of the file for board b of density
+index d of the sweep s
 */
-Buf buildConstraint(nfa * n, int * stringVars, int * varIndex, descriptionNode * d) ;
+char * boardPath(sweep * s, int densityIndex, int b, char * path, size_t size) ;
 
 /*
-clauseCount: descriptionNode * -> int
-clauseCount(d) = c, the number of clauses in the CNF formula encoding the description d (as defined in section 2.3)
+commitBoard: sweep * x int x int x ClauseSink * -> void
+commitBoard(s,d,b,out) writes the formula buffered in out as board b of density index d, either to
+its own file or into the sweep's archive
 */
-int clauseCount(descriptionNode * d) ;
+void commitBoard(sweep * s, int densityIndex, int b, ClauseSink * out) ;
 
 /*
-formulaVarCount: descriptionNode * -> int
-formulaVarCount(d) = v, the total number of variables in the CNF formula encoding the 
-description d (as defined in section 2.3)
+newBoardSink: sweep * -> ClauseSink *
+newBoardSink(s) allocates the in-memory sink a formula of the sweep s is built in
 */
-int formulaVarCount(descriptionNode * d) ;
+ClauseSink * newBoardSink(sweep * s) ;
 
 /*
-uniqueVarCount: descriptionNode * -> int
-uniqueVarCount(d) = v, the number of distinct variables in the CNF formula encoding the 
-description d (as defined in section 2.3)
+initSweep: sweep * x int x float * x int x const char * x bool x lineEncoding * x bool x int x bool x bool -> void
+initSweep(s,N,ds,t,path,bin,e,pre,card,cpl,str) sets up s for a sweep over the t densities ds, with lines
+encoded by e (after presolving if pre is set) and the cardinality constraints card, written to the archive at
+path (or to one file per board if path is NULL), in the binary format if bin is set, with nested boards if cpl
+is set, and streamed if str is set. finishSweep(s) closes any open archive.
 */
-int uniqueVarCount(descriptionNode * d) ;
+void initSweep(sweep * s, int N, float * densities, int densityTotal, const char * archivePath, bool binary, const lineEncoding * encoding, bool presolve, int cardinality, bool coupled, bool stream) ;
+void finishSweep(sweep * s) ;
 
 /*
-digits: int -> int
-digits(i) = d, the number of digits in the base-10 representation of i
+finishUnit: sweep * x int -> void
+finishUnit(s,u) records that unit u of the sweep s (a job, or a board index of a coupled sweep) has all of
+its formulae written to their own files. Formulae going into an archive are recorded by commitBoard as
+they are added instead, since they are added in order.
+
+unitsFinished: sweep * x int -> void
+unitsFinished(s,u) marks unit u of s finished and moves the count of units finished in order on, taking a
+checkpoint each time it gets to another multiple of the checkpoint interval (or the end of the sweep).
+The caller holds the commit lock, so the archive and the count are in step for the checkpoint.
 */
-int digits(int number) ;
+void finishUnit(sweep * s, int unit) ;
+void unitsFinished(sweep * s, int unit) ;
 
 /*
-randomFilled: float x MTRand -> int *
-randomFilled(p,seed) = B, an N*N-element binary vector representing a Nonogram board
+takeCheckpoint: sweep * -> void
+takeCheckpoint(s) writes the checkpoint of s: its units finished in order, its random stream (if it has a
+single one) and the archive being written (if any). A checkpoint that cannot be written is reported and
+the sweep goes on.
+
+resumeSweep: sweep * -> int
+resumeSweep(s) restores s from its checkpoint, so the sweep goes on from the first unit not finished in
+order, with its random stream and archive as they were then. Returns that unit, or -1 if there is no
+checkpoint of this sweep to resume.
 */
-int * randomFilled(float p, MTRand r) ;
+void takeCheckpoint(sweep * s) ;
+int resumeSweep(sweep * s) ;
 
 /*
-transpose: int * -> int *
-transpose(xs) = ys, where entry xs[i,j] == ys[j,i]
+runSweepPool: sweep * x int -> int
+runSweepPool(s,k) encodes BOARDS boards at each density of the sweep s with k worker threads
 */
-int * transpose(int * matrixList) ;
+int runSweepPool(sweep * s, int threads) ;
+void * sweepWorker(void * arg) ;
 
 /*
-descriptionsFromBoard: int * -> descriptionNode **
-descriptionsFromBoard(B) = Ds, an array of Nonogram line descriptions,
-represented as descriptionNode linked lists
+coupledWorker: sweep * x uint64_t * x ClauseSink * x Arena * x LineCache * -> void
+coupledWorker(s,B,out,a,c) is the loop of a worker of the coupled sweep s: it claims board indices, draws
+the field of each, and encodes its board at every density in turn, with the lines that did not change
+since the density before written from a line history. B, out, a and c are the worker's own.
 */
-descriptionNode ** descriptionsFromBoard(int * board) ;
-void freeDescription(descriptionNode * d) ;
-Buf emptyLine(int * stringVars) ;
-
-
-int main(void){
-    MTRand seed = seedRand(32) ;
-    int densityCount = 1 ;
-    for (float d = 0.03 ; d < 1.0; d = d + 0.03){ // Specify the start, stop, and step for board densities
-        printf("%.2f\n",d) ;
-        for (int b = 0 ; b < 500 ; b++){ // b is the number of boards
-            // Fill the board
-            int board[N*N] ;
-            for (int i = 0 ; i < N*N ; i++){
-                if (genRand(&seed) < d){
-                    board[i] = 1 ;
-                } else {
-                    board[i] = 0 ;
-                }
-            } 
-            
-            // Calculate the number of variables and clauses that will be in the resulting formula
-            int rowVars = 0 ; 
-            int rowClauses = 0 ;
-                // Generate Row Descriptions
-            descriptionNode ** rowDescriptions = descriptionsFromBoard(board) ;
-            for (int i = 0 ; i < N ; i++){
-                if (rowDescriptions[i]->length != 0){ // If you don't have an empty line
-                    //printDescription(rowDescriptions[i]) ;
-                    int rowVars_i = uniqueVarCount(rowDescriptions[i]) ;
-                    int rowClauses_i = clauseCount(rowDescriptions[i]) ;
-                    //printf("Unique Variables: %d\t Clauses: %d\n",rowVars_i,rowClauses_i) ;
-                    rowVars += rowVars_i ;
-                    rowClauses += rowClauses_i ;
-                } else { // Otherwise you just have a singleton clause for each variable in the line
-                    rowClauses += N ;
-                    //printf("<>\n") ;
-                }  
-            }
-            int columnVars = 0 ; 
-            int columnClauses = 0 ;
-                // Generate Column Descriptions
-            descriptionNode ** columnDescriptions = descriptionsFromBoard(transpose(board)) ;
-            for (int i = 0 ; i < N ; i++){
-                if (columnDescriptions[i]->length != 0){// If you don't have an empty line
-                    //printDescription(columnDescriptions[i]) ;
-                    int columnVars_i = uniqueVarCount(columnDescriptions[i]) ;
-                    int columnClauses_i = clauseCount(columnDescriptions[i]) ;
-                    //printf("Unique Variables: %d\t Clauses: %d\n",columnVars_i,columnClauses_i) ;
-                    columnVars += columnVars_i ;
-                    columnClauses += columnClauses_i ;
-                } else { // Otherwise you just have a singleton clause for each variable in the line
-                    columnClauses += N ;
-                    //printf("<>\n") ;
-                }
-            }
-            //printf("Total Clauses: %d\tTotal Variables: %d\n",rowClauses + columnClauses,N*N + rowVars + columnVars) ;
-            //printf("\n") ;
-            // file path to which the formula of the current iteration will be saved
-            FILE * fp ; 
-            char index[100] ;
-            sprintf(index,"../Senior-Spring/Clause-Size-Check/%d %d.cnf",densityCount,b) ; 
-            fp = fopen(index,"w") ;
-            // Header for DIMACS format (https://jix.github.io/varisat/manual/0.2.0/formats/dimacs.html)
-            fprintf(fp,"p cnf %d %d\n",N*N + rowVars + columnVars,rowClauses + columnClauses) ;
-
-
-                // Let's actually write to file now for each description!
-            int * varIndex = malloc(sizeof(int)) ;
-            *varIndex = N*N+1 ;
-                // Do the Rows First
-            for (int i = 0 ; i < N ; i++){
-                int stringVars[N] ;
-                for (int j = 0 ; j < N ; j++){ // Get the string variables for the row being encoded
-                    stringVars[j] = i*N + j + 1 ; 
-                }
-                if (rowDescriptions[i]->length != 0){ // If you don't have an empty row
-                    // Construct the NFA
-                    nfa * n = buildNFA(rowDescriptions[i]) ; 
-                    // Construct the CNF formula for the NFA, storing it in a buffer
-                    Buf constraint = buildConstraint(n,stringVars,varIndex,rowDescriptions[i]) ;
-                    // Dump the buffer into the file
-                    fprintf(fp,"%s",buf_data(constraint)) ;
-
-                    // clean up after yourself...
-                    free(n->inOnes) ;
-                    free(n->inZeros) ;
-                    free(n->selfZeros) ;
-                    free(n) ;
-                    free(constraint) ;
-                } else { // If you do have an empty row
-                    Buf constraint = emptyLine(stringVars) ;
-                    fprintf(fp,"%s",buf_data(constraint)) ;
-                    free(constraint) ;
-                }  
-            }
-                // Then the Columns
-            for (int i = 0 ; i < N ; i++){
-                int stringVars[N] ;
-                for (int j = 0 ; j < N ; j++){ // Get the string variables for the column being encoded
-                    stringVars[j] = j*N + i + 1 ;
-                }
-                if (columnDescriptions[i]->length != 0){ // If you don't have an empty column
-                    // Construct the NFA
-                    nfa * n = buildNFA(columnDescriptions[i]) ;
-                    // Construct the CNF formula for the NFA, storing it in a buffer
-                    Buf constraint = buildConstraint(n,stringVars,varIndex,columnDescriptions[i]) ;
-                    // Dump the buffer into the file
-                    fprintf(fp,"%s",buf_data(constraint)) ;
-
-                    // clean up after yourself...
-                    free(n->inOnes) ;
-                    free(n->inZeros) ;
-                    free(n->selfZeros) ;
-                    free(n) ;
-                    free(constraint) ;
-                } else { // If you do have an empty row
-                    Buf constraint = emptyLine(stringVars) ;
-                    fprintf(fp,"%s",buf_data(constraint)) ;
-                    free(constraint) ;
-                }  
-            }
-            // Clean Up Time!
-            for (int i = 0 ; i < N ; i++){
-                freeDescription(rowDescriptions[i]) ;
-                freeDescription(columnDescriptions[i]) ;
-            }
-            free(rowDescriptions) ;
-            free(columnDescriptions) ;
-            fclose(fp) ;
+void coupledWorker(sweep * s, uint64_t * board, ClauseSink * out, Arena * scratch, LineCache * cache) ;
+
+
+int main(int argc, char ** argv){
+    int N = DEFAULT_SIZE ; // The size of the board
+    int threads = 0 ; // Zero runs the original single stream sweep
+    const char * archivePath = NULL ; // NULL writes one file per board
+    bool binary = false ; // DIMACS text unless -b is given
+    bool pruned = false ; // The encoding of section 2.3 unless -p is given
+    bool eliminate = false ; // Transition variables are kept unless -e is given
+    bool positional = false ; // Variables are numbered in blocks unless -l is given
+    bool presolve = false ; // Every line is encoded in full unless -s is given
+    int cardinality = 0 ; // No cardinality constraints unless -c (per line) or -C (per board) is given
+    bool coupled = false ; // Every board is drawn on its own unless -u is given
+    bool stream = false ; // Each formula is built in memory before it is written unless -S is given
+    const char * checkpointPath = NULL ; // No checkpoints unless -k is given
+    bool resume = false ; // The sweep starts from the beginning unless -r is given
+    int option ;
+    while ((option = getopt(argc,argv,"n:t:a:bpelscCuSk:r")) != -1){
+        switch (option){
+            case 'n':
+                N = atoi(optarg) ;
+                break ;
+            case 't':
+                threads = atoi(optarg) ;
+                break ;
+            case 'a':
+                archivePath = optarg ;
+                break ;
+            case 'b':
+                binary = true ;
+                break ;
+            case 'p':
+                pruned = true ;
+                break ;
+            case 'e':
+                eliminate = true ;
+                break ;
+            case 'l':
+                positional = true ;
+                break ;
+            case 's':
+                presolve = true ;
+                break ;
+            case 'c':
+                cardinality |= CARDINALITY_LINES ;
+                break ;
+            case 'C':
+                cardinality |= CARDINALITY_BOARD ;
+                break ;
+            case 'u':
+                coupled = true ;
+                break ;
+            case 'S':
+                stream = true ;
+                break ;
+            case 'k':
+                checkpointPath = optarg ;
+                break ;
+            case 'r':
+                resume = true ;
+                break ;
+            default:
+                fprintf(stderr,"usage: %s [-n size] [-t threads] [-a archive] [-b] [-p] [-e] [-l] [-s] [-c] [-C] [-u] [-S] [-k checkpoint [-r]]\n",argv[0]) ;
+                return 1 ;
         }
-        densityCount += 1 ;
     }
+    if (N < 1){
+        fprintf(stderr,"The board size must be positive\n") ;
+        return 1 ;
+    }
+    if (coupled && archivePath != NULL && strstr(archivePath,"%d") != NULL){
+        fprintf(stderr,"A coupled sweep goes board by board, so it writes one archive rather than one for each density\n") ;
+        return 1 ;
+    }
+    if (stream && archivePath != NULL){
+        fprintf(stderr,"A streamed formula goes straight to its own file, so it cannot go into an archive\n") ;
+        return 1 ;
+    }
+    if (resume && checkpointPath == NULL){
+        fprintf(stderr,"-r resumes from the checkpoint given with -k\n") ;
+        return 1 ;
+    }
+    lineEncoding layout = *(eliminate ? (pruned ? &prunedEliminatedEncoding : &eliminatedEncoding)
+                                      : (pruned ? &prunedEncoding : &automatonEncoding)) ;
+    layout.positional = positional ;
+    const lineEncoding * encoding = &layout ;
+    TRACE_OPEN(TRACE_FILE) ; // Written when the sweep exits
+    TRACE_THREAD("main") ;
+
+    // Specify the start, stop, and step for board densities
+    float densities[64] ;
+    int densityTotal = 0 ;
+    for (float d = 0.03 ; d < 1.0; d = d + 0.03){
+        densities[densityTotal] = d ;
+        densityTotal += 1 ;
+    }
+
+    sweep s ;
+    initSweep(&s,N,densities,densityTotal,archivePath,binary,encoding,presolve,cardinality,coupled,stream) ;
+    MTRand seed = seedRand(SEED) ;
+    bool pool = threads > 0 || coupled ; // A coupled sweep always runs in the pool, with one thread unless -t is given
+    s.rng = pool ? NULL : &seed ;
+
+    // The options that decide the formulae and where they go, so a checkpoint is only resumed by the same sweep (any thread count)
+    char checkpointKey[CHECKPOINT_KEY] ;
+    snprintf(checkpointKey,sizeof(checkpointKey),"regExEncoding -n %d, %d boards, %s sweep,%s%s%s%s%s%s%s%s archive %s",N,BOARDS,
+             coupled ? "coupled" : (pool ? "multithreaded" : "single stream"),binary ? " -b" : "",pruned ? " -p" : "",
+             eliminate ? " -e" : "",positional ? " -l" : "",presolve ? " -s" : "",(cardinality & CARDINALITY_LINES) ? " -c" : "",
+             (cardinality & CARDINALITY_BOARD) ? " -C" : "",stream ? " -S" : "",archivePath != NULL ? archivePath : "(none)") ;
+    s.checkpointPath = checkpointPath ;
+    s.checkpointKey = checkpointKey ;
+    int start = 0 ;
+    if (resume){
+        start = resumeSweep(&s) ;
+        if (start < 0){
+            return 1 ;
+        }
+    }
+
+    if (pool){
+        int status = runSweepPool(&s,threads > 0 ? threads : 1) ;
+        finishSweep(&s) ;
+        STATS_MERGE() ;
+        STATS_WRITE(STATS_FILE) ;
+        return status ;
+    }
+
+    ClauseSink * out = newBoardSink(&s) ; // Each formula is built in memory and then written out whole
+    Arena * scratch = arena_new(SCRATCH_SIZE) ;
+    LineCache * cache = linecache_new(encoding,CACHE_LITERALS) ;
+    uint64_t * board = malloc(N*boardWords(N)*sizeof(uint64_t)) ;
+    for (int job = start ; job < densityTotal*BOARDS ; job++){ // From the first board not written if resuming
+        int densityIndex = job / BOARDS ;
+        int b = job % BOARDS ; // b is the number of boards
+        float d = densities[densityIndex] ;
+        if (b == 0 || job == start){
+            printf("%.2f\n",d) ;
+        }
+        // Fill the board
+        STATS_START(filling) ;
+        fillBoard(board,N,d,&seed) ;
+        STATS_STOP(filling,STAGE_GENERATE) ;
+        writeBoard(&s,board,densityIndex,b,out,scratch,cache,NULL) ;
+        finishUnit(&s,job) ;
+    }
+    STATS_COUNTER("linecache hits",linecache_hits(cache)) ;
+    STATS_COUNTER("linecache misses",linecache_misses(cache)) ;
+    free(board) ;
+    linecache_free(cache) ;
+    arena_free(scratch) ;
+    sink_free(out) ;
+    finishSweep(&s) ;
     printf("\n") ;
+    STATS_MERGE() ;
+    STATS_WRITE(STATS_FILE) ;
 
     return 0 ;
     
 }
 
-void appendDescription(descriptionNode * d,int runLength){
-    if (d->tail == NULL){
-        d->val = runLength ;
-        d->tail = d ;
-    } else {
-        descriptionNode * newRun = malloc(sizeof(descriptionNode)) ;
-        newRun->val = runLength ;
-        d->tail->next = newRun ;
-        d->tail = d->tail->next ;
-    }
-    d->length += 1 ;
-    return ;
-}
-
-void printDescription(descriptionNode * d){
-    if (d->tail == NULL){
-        return ;
+void encodeBoard(const uint64_t * board, int N, bool presolve, int cardinality, ClauseSink * out, Arena * scratch, LineCache * cache, LineHistory * history){
+        // Generate Row and Column Descriptions
+    STATS_START(describing) ;
+    description * rowDescriptions = descriptionsFromBits(board,N,scratch) ;
+    uint64_t * columns = arena_alloc(scratch,N*boardWords(N)*sizeof(uint64_t)) ;
+    description * columnDescriptions = descriptionsFromBits(transposeBits(board,columns,N),N,scratch) ;
+    STATS_STOP(describing,STAGE_DESCRIBE) ;
+
+    // Settle what the line solver can (if presolving), which is written as singleton clauses
+    signed char * cells = arena_alloc(scratch,N*N) ;
+    memset(cells,CELL_UNKNOWN,N*N) ;
+    int settled = 0 ;
+    if (presolve){
+        STATS_START(presolving) ;
+        settled = linesolve_board(rowDescriptions,columnDescriptions,N,N,cells,scratch) ;
+        STATS_STOP(presolving,STAGE_PRESOLVE) ;
+        if (settled < 0){ // Cannot happen for the descriptions of a real board, but leave the lines whole if it does
+            memset(cells,CELL_UNKNOWN,N*N) ;
+            settled = 0 ;
+        }
     }
-    descriptionNode * temp = d ;
-    printf("< ") ;
-    while (temp != NULL){
-        printf("%d ",temp->val) ;
-        temp = temp->next ;
+    // Each line then only encodes what is left once its settled ends are off (the whole line without presolving)
+    lineSegment * segments = arena_alloc(scratch,2*N*sizeof(lineSegment)) ;
+    for (int i = 0 ; i < N ; i++){
+        segments[i] = linesolve_segment(&rowDescriptions[i],cells + i*N,1,N) ;
+        segments[N + i] = linesolve_segment(&columnDescriptions[i],cells + i,N,N) ;
     }
-    printf(">\n") ;
-    return ;
-}
 
-/* NOT USED ---- (you need to generate an entire board, can't do it one line at a time)
-descriptionNode * generateDescription(double p,MTRand seed){
-    descriptionNode * head = malloc(sizeof(descriptionNode)) ;
-    head->length = 0 ;
-    int currentRun = 0 ;
-    bool currentlyRunning = false ;
-
-    for (int i = 0 ; i < N ; i++){
-        if (genRand(&seed) < p){
-            currentRun += 1 ;
-            currentlyRunning = true ;
-        } else {
-            if (currentlyRunning){
-                appendDescription(head,currentRun) ;
-                currentlyRunning = false ;
-                currentRun = 0 ;
+    // Calculate the number of variables and clauses that will be in the resulting formula
+    int64_t lineVars = 0 ; // 64-bit, as a board cardinality constraint can have more clauses than an int holds
+    int64_t clauses = settled ;
+    for (int i = 0 ; i < 2*N ; i++){
+        const lineSegment * g = &segments[i] ;
+        if (g->length == 0){ // A settled line has nothing left to encode
+            continue ;
+        }
+        if (g->rest.length != 0){ // If you don't have an empty line
+            //printDescription(&g->rest) ;
+            int vars_i ;
+            int clauses_i ;
+            if (history != NULL && linehistory_same(history,i,g,&clauses_i,&vars_i)){ // The same as on the board before
+                clauses += clauses_i ;
+            } else {
+                clauses += linecache_counts(cache,&g->rest,g->length,&vars_i,scratch) ;
             }
+            lineVars += vars_i ;
+        } else { // Otherwise you just have a singleton clause for each variable in the line
+            clauses += g->length ;
+        }
+        if ((cardinality & CARDINALITY_LINES) && g->rest.length != 0){
+            int64_t vars_i ;
+            clauses += cardinality_counts(g->length,g->rest.total,&vars_i) ;
+            lineVars += vars_i ;
         }
     }
-
-    if (currentlyRunning){
-        appendDescription(head,currentRun) ;
-    }
-    if (head->tail == NULL){
-        free(head) ;
-        return NULL ;
-    } else {
-        return head ;
-    }
-} */
-
-int stateCount(descriptionNode * d){
-    /*
-    Traverses the linked list, summing the number of links along with the val field of the links
-    */
-    int count = 0 ;
-    descriptionNode * temp = d ;
-    while (temp != NULL){
-        count += temp->val ;
-        count += 1 ;
-        temp = temp->next ;
-    }
-    return count ;
-}
-
-/* NOT USED --- (incorporated into buildNFA)
-int * transitions(descriptionNode * d){
-    int states = stateCount(d) ; // Number of states in the NFA
-    int * mat = malloc(states * states * sizeof(int)) ; // Malloc the transition set
-    for (int i = 0 ; i < states * states ; i++){ // Initialize values to -1 to prevent errors when filling in with real values
-        mat[i] = -1 ;
-    }
-
-    int l_LEQ_j = 0 ;
-
-    mat[0] = 0 ; // Self-loop on zero from the first state back to the first state
-
-    for (int k = 0 ; k < d->val ; k++){ // Transitions for the first run (j=0)
-        mat[k*states + k + 1] = 1;
+    // The board's unsettled cells, and how many of them are filled
+    int * open = arena_ints(scratch,N*N) ;
+    int openCount = 0 ;
+    int openFilled = 0 ;
+    if (cardinality & CARDINALITY_BOARD){
+        for (int k = 0 ; k < N*N ; k++){
+            if (cells[k] == CELL_UNKNOWN){
+                open[openCount++] = k + 1 ;
+            }
+        }
+        for (int i = 0 ; i < N ; i++){
+            openFilled += rowDescriptions[i].total ;
+            for (int j = 0 ; j < N ; j++){
+                openFilled -= cells[i*N + j] == CELL_FILLED ;
+            }
+        }
+        int64_t vars_b ;
+        clauses += cardinality_counts(openCount,openFilled,&vars_b) ;
+        lineVars += vars_b ;
+    }
+    if (N*N + lineVars > INT_MAX){ // The literals written here are ints (-S numbers them with 64 bits)
+        fprintf(stderr,"The formula of a %dx%d board has too many variables for an int, use -S\n",N,N) ;
+        exit(1) ;
+    }
+    //printf("Total Clauses: %d\tTotal Variables: %d\n",clauses,N*N + lineVars) ;
+    // Header for DIMACS format (https://jix.github.io/varisat/manual/0.2.0/formats/dimacs.html)
+    sink_header(out,N*N + lineVars,clauses) ;
+    STATS_ADD(STAGE_BOARD,clauses,clauses) ;
+    STATS_ADD(STAGE_BOARD,variables,N*N + lineVars) ;
+
+        // The settled cells come first
+    for (int k = 0 ; k < N*N ; k++){
+        if (cells[k] != CELL_UNKNOWN){
+            sink_unit(out,cells[k] == CELL_FILLED ? k + 1 : -(k + 1)) ;
+        }
     }
 
-    l_LEQ_j += d->val ;
-    descriptionNode * temp = d->next ;
-    for (int j = 1 ; j < d->length ; j++){
-        int index1 = l_LEQ_j + j + (l_LEQ_j + j) * states ; // Set 1 for the transition set
-        if (mat[index1] == -1){
-            mat[index1] = 0 ;
-        } else {
-            mat[index1] = 2 ;
+        // Let's actually write to file now for each description!
+    int varIndex = N*N+1 ;
+    int * stringVars = arena_ints(scratch,N) ;
+    for (int i = 0 ; i < 2*N ; i++){ // The rows first, then the columns
+        const lineSegment * g = &segments[i] ;
+        if (g->length == 0){
+            continue ;
         }
-
-        for (int k = 0 ; k < temp->val ; k++){ // Set 2 for the transition set
-            int index2 = l_LEQ_j + j + (l_LEQ_j + j)*states + k*states + k + 1 ;
-            if (mat[index2] == -1){
-                mat[index2] = 1 ;
+        TRACE_START(writing) ;
+        for (int j = 0 ; j < N ; j++){ // Get the string variables for the line being encoded
+            stringVars[j] = i < N ? i*N + j + 1 : j*N + (i - N) + 1 ;
+        }
+        if (g->rest.length != 0){ // If you don't have an empty line
+            // Write the CNF formula for the description, relabelling its cached template (or reusing its last clauses)
+            if (history != NULL){
+                linehistory_encode(history,i,g,cache,stringVars + g->start,&varIndex,out,scratch) ;
             } else {
-                mat[index2] = 2 ;
+                linecache_encode(cache,stringVars + g->start,&varIndex,&g->rest,g->length,out,scratch) ;
             }
+        } else { // If you do have an empty line
+            emptyLine(stringVars + g->start,g->length,out) ;
         }
-        
-        int index3 = l_LEQ_j + j + (l_LEQ_j + j-1)*(states) ; // Set 3 for the transition set
-        if (mat[index3] == -1){
-            mat[index3] = 0 ;
-        }  else {
-            mat[index3] = 2 ;
-        }
-        l_LEQ_j += temp->val ;
-        temp = temp->next ;
+        TRACE_LINE(writing,i) ;
     }
-    mat[states*states - 1] = 0 ; // Set 3 for j=t
 
-    return mat ;
-}
-*/
-nfa * buildNFA(descriptionNode * d){
-    nfa * NFA = malloc(sizeof(nfa)) ;
-
-    NFA->states = stateCount(d) ; // Get the number of states
-
-    // Get ready to build the automata
-    int * selfLoops = malloc(NFA->states * sizeof(int)) ;
-    int * incomingOnes = malloc(NFA->states * sizeof(int)) ;
-    int * incomingZeros = malloc(NFA->states * sizeof(int)) ;
-
-    for (int i = 0 ; i < NFA->states ; i++){ // Initialize to Zero (no transition)
-        selfLoops[i] = 0 ;
-        incomingOnes[i] = 0 ;
-        incomingZeros[i] = 0 ;
+        // The cardinality constraints go after all of the lines
+    if (cardinality & CARDINALITY_LINES){
+        for (int i = 0 ; i < 2*N ; i++){
+            const lineSegment * g = &segments[i] ;
+            if (g->length == 0 || g->rest.length == 0){ // An empty line is already all singleton clauses
+                continue ;
+            }
+            for (int j = 0 ; j < g->length ; j++){
+                const int k = g->start + j ;
+                stringVars[j] = i < N ? i*N + k + 1 : k*N + (i - N) + 1 ;
+            }
+            cardinality_exactly(stringVars,g->length,g->rest.total,&varIndex,out,scratch) ;
+        }
     }
-
-    // Assign to the NFA
-    NFA->selfZeros = selfLoops ;
-    NFA->inOnes = incomingOnes ;
-    NFA->inZeros = incomingZeros ;
-
-    // sets 1,2,3 are labelled in section 2.3
-    NFA->selfZeros[0] = 1 ; // State zero always has a self-loop (set 1 for j = 0)
-    for (int k = 0 ; k < d->val ; k++){ // set 2 for j = 0
-        NFA->inOnes[k+1] = 1 ;
+    if (cardinality & CARDINALITY_BOARD){
+        cardinality_exactly(open,openCount,openFilled,&varIndex,out,scratch) ;
     }
-    NFA->selfZeros[NFA->states - 1] = 1 ; // set 3 for j=t
-
-    int l_LEQ_j = d->val ;
-    descriptionNode * temp = d->next ;
-
-    for (int j = 1 ; j < d->length ; j++){
-        NFA->selfZeros[l_LEQ_j + j] = 1 ; // set 1
+    return ;
+}
 
-        for (int k = 0 ; k < temp->val ; k++){ // set 2
-            NFA->inOnes[l_LEQ_j + j + k + 1] = 1 ;
+void streamBoard(sweep * s, const uint64_t * board, int densityIndex, int b, Arena * scratch, LineCache * cache){
+    const int N = s->size ;
+    arena_reset(scratch) ;
+    STATS_START(describing) ;
+    description * rowDescriptions = descriptionsFromBits(board,N,scratch) ;
+    uint64_t * columns = arena_alloc(scratch,N*boardWords(N)*sizeof(uint64_t)) ;
+    description * columnDescriptions = descriptionsFromBits(transposeBits(board,columns,N),N,scratch) ;
+    STATS_STOP(describing,STAGE_DESCRIBE) ;
+    signed char * cells = NULL ;
+    if (s->presolve){
+        STATS_START(presolving) ;
+        cells = arena_alloc(scratch,(size_t) N*N) ;
+        memset(cells,CELL_UNKNOWN,(size_t) N*N) ;
+        if (linesolve_board(rowDescriptions,columnDescriptions,N,N,cells,scratch) < 0){
+            memset(cells,CELL_UNKNOWN,(size_t) N*N) ;
         }
-
-        NFA->inZeros[l_LEQ_j + j] = 1 ; // set 3
-
-        l_LEQ_j += temp->val ;
-        temp = temp->next ;
-    }
-
-    return NFA ;
+        STATS_STOP(presolving,STAGE_PRESOLVE) ;
+    }
+
+    char index[100] ;
+    FILE * fp = fopen(boardPath(s,densityIndex,b,index,sizeof(index)),"w") ;
+    if (fp == NULL){
+        perror(index) ;
+        exit(1) ;
+    }
+    ClauseSink * out = s->binary ? sink_bincnf(fp) : sink_dimacs(fp) ; // Flushed to the file whenever its buffer fills
+    int64_t clauses ;
+    int64_t variables = stream_board(rowDescriptions,columnDescriptions,N,N,cells,s->cardinality,cache,out,&clauses,scratch) ;
+    STATS_ADD(STAGE_BOARD,clauses,clauses) ;
+    STATS_ADD(STAGE_BOARD,variables,variables) ;
+    sink_free(out) ;
+    fclose(fp) ;
+    return ;
 }
 
-void printNFA(nfa * n ){
-    printf("States: %d\n",n->states) ;
-    
-    if (n->selfZeros[0] == 1){
-        printf("(0,0,0)\n") ;
-    } else {
-        printf("SOMETHING IS WRONG!\n") ;
+void writeBoard(sweep * s, const uint64_t * board, int densityIndex, int b, ClauseSink * out, Arena * scratch, LineCache * cache, LineHistory * history){
+    TRACE_BOARD(densityIndex,b) ;
+    STATS_START(encoding) ;
+    if (s->stream){
+        streamBoard(s,board,densityIndex,b,scratch,cache) ;
+        STATS_STOP(encoding,STAGE_BOARD) ;
         return ;
     }
-
-    for (int i = 1 ; i <= n->states ; i++){
-        if (n->selfZeros[i] == 1){
-            printf("(%d,0,%d)\n",i,i) ;
-        }
-        if (n->inOnes[i] == 1){
-            printf("(%d,1,%d)\n",i-1,i) ;
-        }
-        if (n->inZeros[i] == 1){
-            printf("(%d,0,%d)\n",i-1,i) ;
-        }
-    }
+    sink_reset(out) ;
+    arena_reset(scratch) ;
+    encodeBoard(board,s->size,s->presolve,s->cardinality,out,scratch,cache,history) ;
+    STATS_ADD(STAGE_BOARD,bytes,sink_size(out)) ;
+    commitBoard(s,densityIndex,b,out) ;
+    STATS_STOP(encoding,STAGE_BOARD) ;
     return ;
 }
 
-Buf buildConstraint(nfa * n, int * stringVars, int * varIndex, descriptionNode * d){
-    // First we build up the variables that will be sampled from when building the formula
-
-    int stateVars[(N+1) * n->states] ;
-    for (int i = 0 ; i < (N+1)*n->states ; i++){
-        stateVars[i] = *varIndex ;
-        *varIndex = *varIndex + 1 ;
-    }
-
-    int transitionVars[2 * N * n->states] ;
+char * boardPath(sweep * s, int densityIndex, int b, char * path, size_t size){
+    snprintf(path,size,"../Senior-Spring/Clause-Size-Check/%d %d.%s",densityIndex + 1,b,s->binary ? "cnfb" : "cnf") ;
+    return path ;
+}
 
-    for (int i = 0 ; i < n->states ; i++){ // Fill in for k = 1 (the first, which is zero indexed)
-        if (n->inZeros[i] == 1 || n->selfZeros[i] == 1){
-            transitionVars[i] = *varIndex ;
-            *varIndex = *varIndex + 1 ;
-        } else {
-            transitionVars[i] = 0 ;
-        }
-        if (n->inOnes[i] == 1){
-            transitionVars[n->states + i] = *varIndex ;
-            *varIndex = *varIndex + 1 ;
-        } else {
-            transitionVars[n->states + i] = 0 ;
+void commitBoard(sweep * s, int densityIndex, int b, ClauseSink * out){
+    if (s->archivePath == NULL){
+        // file path to which the formula of the current iteration will be saved
+        FILE * fp ; 
+        char index[100] ;
+        fp = fopen(boardPath(s,densityIndex,b,index,sizeof(index)),"w") ;
+        if (fp == NULL){
+            perror(index) ;
+            exit(1) ;
         }
+        STATS_START(writing) ;
+        fwrite(sink_data(out),1,sink_size(out),fp) ;
+        fclose(fp) ;
+        STATS_STOP(writing,STAGE_WRITE) ;
+        STATS_ADD(STAGE_WRITE,bytes,sink_size(out)) ;
+        return ;
     }
 
-    for (int k = 1 ; k < N ; k++){ // You can then copy over from k=1, incrementing the variable counter each time
-        for (int i = 0 ; i < n->states ; i++){
-            if (transitionVars[i] != 0){
-                transitionVars[2*k*n->states + i] = *varIndex ;
-                *varIndex = *varIndex + 1 ;
-            } else {
-                transitionVars[2*k*n->states + i] = 0 ;
-            }
-            if (transitionVars[n->states + i] != 0){
-                transitionVars[2*k*n->states + n->states + i] = *varIndex ;
-                *varIndex = *varIndex + 1 ;
-            } else {
-                transitionVars[2*k*n->states + n->states + i] = 0 ;
-            }
+    // Wait for every earlier board to be added, so the archive does not depend on the thread count
+    int job = s->coupled ? b*s->densityTotal + densityIndex : densityIndex*BOARDS + b ;
+    pthread_mutex_lock(&s->commitLock) ;
+    if (s->nextCommit != job){
+        TRACE_START(waiting) ;
+        while (s->nextCommit != job){
+            pthread_cond_wait(&s->committed,&s->commitLock) ;
         }
+        TRACE_SPAN(waiting,"commit wait") ;
     }
 
-    // Now let's print out each to see if it's being developed properly
-    /*
-    printf("String Variables:\n") ;
-    for (int i = 0 ; i < N ; i++){
-        printf("%d ",stringVars[i]) ;
-    }
-    printf("\nState Variables:\n") ;
-    for (int i = 0 ; i < (N+1)*n->states ; i++){
-        printf("%d ",stateVars[i]) ;
-    }
-    printf("\nTransition Variables:\n") ;
-    for (int i = 0 ; i < 2*N*n->states ; i++){
-        printf("%d ",transitionVars[i]) ;
-    }
-    printf("\n") ; */
-
-    // Set Up the Buffer
-    int bufferSize = 4*clauseCount(d) + (digits(*varIndex) + 2)*formulaVarCount(d) ;
-    Buf dimacs = buf_new(bufferSize) ;
-
-    // Build Up the Buffer!
-    for (int k = 0 ; k < N ; k++){
-        // First Constraint
-        
-        for (int i = 0 ; i < n->states ; i++){
-            if (transitionVars[2*k*n->states + i] != 0){
-                //printf("(-%d -%d) (-%d %d) ",transitionVars[2*k*n->states + i],stringVars[k],transitionVars[2*k*n->states + i],stateVars[(k+1)*n->states + i]) ;
-                buf_append(dimacs,"-%d -%d 0\n-%d %d 0\n",transitionVars[2*k*n->states + i],stringVars[k],transitionVars[2*k*n->states + i],stateVars[(k+1)*n->states + i]) ;
-            }
-            if (transitionVars[(2*k+1)*n->states + i] != 0){
-                //printf("(-%d %d) (-%d %d) ",transitionVars[(2*k+1)*n->states + i],stringVars[k],transitionVars[(2*k+1)*n->states + i],stateVars[(k+1)*n->states + i]) ;
-                buf_append(dimacs,"-%d %d 0\n-%d %d 0\n",transitionVars[(2*k+1)*n->states + i],stringVars[k],transitionVars[(2*k+1)*n->states + i],stateVars[(k+1)*n->states + i]) ;
-            }
-        }
-        //printf("\n") ;
-        // Second Constraint
-        for (int i = 0 ; i < n->states ; i++){
-            //printf("(-%d",stateVars[k*n->states + i]) ;
-            buf_append(dimacs,"-%d",stateVars[k*n->states + i]) ;
-            if (n->selfZeros[i] != 0){ // zero self-loop transition
-                buf_append(dimacs," %d",transitionVars[2*k*n->states + i]) ;
-            }
-            if (i != n->states - 1){
-                if (n->inOnes[i+1] != 0){
-                    buf_append(dimacs," %d",transitionVars[(2*k+1)*n->states + i + 1]) ;
-                }
-                if (n->inZeros[i+1] != 0){
-                    buf_append(dimacs," %d",transitionVars[2*k*n->states + i + 1]) ;
-                }
-            }
-            /*
-            if (transitionVars[2*k*n->states + i] != 0){
-                //printf(" %d",transitionVars[2*k*n->states + i]) ;
-                buf_append(dimacs," %d",transitionVars[2*k*n->states + i]) ;
-            }
-            if (i != n->states - 1 && transitionVars[(2*k+1)*n->states + i+1] != 0){
-                //printf(" %d",transitionVars[(2*k+1)*n->states + i+1]) ;
-                buf_append(dimacs," %d",transitionVars[(2*k+1)*n->states + i+1]) ;
-            } */
-            //printf(") ") ;
-            buf_append(dimacs," 0\n") ;
-        }
-        //printf("\n") ;
-        // Third Constraint
-        for (int i = 0 ; i < n->states ; i++){
-            //printf("(-%d",stateVars[(k+1)*n->states + i]) ;
-            buf_append(dimacs,"-%d",stateVars[(k+1)*n->states + i]) ;
-            if (transitionVars[2*k*n->states + i] != 0){
-                //printf(" %d",transitionVars[2*k*n->states + i]) ;
-                buf_append(dimacs," %d",transitionVars[2*k*n->states + i]) ;
-            }
-            if (transitionVars[(2*k+1)*n->states + i] != 0){
-                //printf(" %d",transitionVars[(2*k+1)*n->states + i]) ;
-                buf_append(dimacs," %d",transitionVars[(2*k+1)*n->states + i]) ;
-            }
-            //printf(")") ;
-            buf_append(dimacs," 0\n") ;
-        }
-        
-        // Fourth Constraint
-        //printf("(%d",stringVars[k]) ;
-        buf_append(dimacs,"%d",stringVars[k]) ;
-        for (int i = 0 ; i < n->states ; i++){
-            if (transitionVars[2*k*n->states + i] != 0){
-                //printf(" %d",transitionVars[2*k*n->states + i]) ;
-                buf_append(dimacs," %d",transitionVars[2*k*n->states + i]) ;
-            }
-        }
-        //printf(") ") ;
-        buf_append(dimacs," 0\n") ;
-        //printf("(-%d",stringVars[k]) ;
-        buf_append(dimacs,"-%d",stringVars[k]) ;
-        for (int i = 0 ; i < n->states ; i++){
-            if (transitionVars[(2*k+1)*n->states + i] != 0){
-                //printf(" %d",transitionVars[(2*k+1)*n->states + i]) ;
-                buf_append(dimacs," %d",transitionVars[(2*k+1)*n->states + i]) ;
-            } 
-        }
-        //printf(")\n") ;
-        buf_append(dimacs," 0\n") ;
-        //printf("\n") ;
-        
-        // Fifth Constraint
-        for (int i = 0 ; i < n->states ; i++){
-            if (transitionVars[2*k*n->states + i] != 0){
-                //printf("(-%d",transitionVars[2*k*n->states + i]) ;
-                buf_append(dimacs,"-%d",transitionVars[2*k*n->states + i]) ;
-                if (n->inZeros[i] != 0){
-                    //printf(" %d",stateVars[k*n->states + i - 1]) ;
-                    buf_append(dimacs," %d",stateVars[k*n->states + i - 1]) ;
-                }
-                if (n->selfZeros[i] != 0){
-                    //printf(" %d",stateVars[k*n->states + i]) ;
-                    buf_append(dimacs," %d",stateVars[k*n->states + i]) ;
-                }
-                //printf(") ") ;
-                buf_append(dimacs," 0\n") ;
-            }
-            if (transitionVars[(2*k+1)*n->states + i] != 0){
-                //printf("(-%d %d)",transitionVars[(2*k+1)*n->states + i],stateVars[k*n->states + i - 1]) ;
-                buf_append(dimacs, "-%d %d 0\n",transitionVars[(2*k+1)*n->states + i],stateVars[k*n->states + i - 1]) ;
-            }
-            
+    bool perDensity = strstr(s->archivePath,"%d") != NULL ;
+    if (s->archive == NULL || (perDensity && s->archiveDensity != densityIndex + 1)){
+        archive_finish(s->archive) ;
+        char path[1024] ;
+        snprintf(path,sizeof(path),s->archivePath,densityIndex + 1) ;
+        s->archive = archive_create(path) ;
+        if (s->archive == NULL){
+            exit(1) ;
         }
-        //printf("\n") ;
+        s->archiveDensity = perDensity ? densityIndex + 1 : 0 ;
     }
-    // Sixth Constraint
-    for (int i = 1 ; i < n->states ; i++){
-        //printf("(-%d) ",stateVars[i]) ;
-        buf_append(dimacs, "-%d 0\n",stateVars[i]) ;
-    }
-    //printf("\n") ;
-    for (int i = n->states * N ; i < n->states * (N+1) - 1 ; i++){
-        //printf("(-%d) ",stateVars[i]) ;
-        buf_append(dimacs, "-%d 0\n",stateVars[i]) ;
+    STATS_START(writing) ;
+    archive_add(s->archive,densityIndex + 1,b,sink_data(out),sink_size(out)) ;
+    STATS_STOP(writing,STAGE_WRITE) ;
+    STATS_ADD(STAGE_WRITE,bytes,sink_size(out)) ;
+
+    s->nextCommit += 1 ;
+    if (!s->coupled || s->nextCommit % s->densityTotal == 0){ // A coupled unit is a board at every density
+        unitsFinished(s,s->coupled ? b : job) ;
     }
-    //printf("\n\n") ;
-    //printf("BUFFER:\n%s",buf_data(dimacs)) ;
-    return dimacs;
-    
+    pthread_cond_broadcast(&s->committed) ;
+    pthread_mutex_unlock(&s->commitLock) ;
+    return ;
 }
 
-int clauseCount(descriptionNode * d){
-    int t = 0 ; 
-    int s = 0 ;
-    descriptionNode * temp = d ;
-    // Traverse the description linked list, counting the number of runs and the total length of the runs
-    while (temp != NULL){
-        s += temp->val ;
-        t += 1 ;
-        temp = temp->next ;
-    }
-    return (5*N+2)*(t+1+s) - 4 ; // return the recurrence (section 2.4)
+ClauseSink * newBoardSink(sweep * s){
+    return s->binary ? sink_bincnf(NULL) : sink_dimacs(NULL) ;
 }
-int formulaVarCount(descriptionNode * d){
-    int t = 0 ; 
-    int s = 0 ;
-    descriptionNode * temp = d ;
-    // Traverse the description linked list, counting the number of runs and the total length of the runs
-    while (temp != NULL){
-        s += temp->val ;
-        t += 1 ;
-        temp = temp->next ;
-    }
-    return (14*N+2)*t+8*N-2+(11*N+2)*s ; // return the recurrence (section 2.4)
+
+void initSweep(sweep * s, int N, float * densities, int densityTotal, const char * archivePath, bool binary, const lineEncoding * encoding, bool presolve, int cardinality, bool coupled, bool stream){
+    s->size = N ;
+    s->densities = densities ;
+    s->densityTotal = densityTotal ;
+    atomic_init(&s->nextJob,0) ;
+    s->archivePath = archivePath ;
+    s->archive = NULL ;
+    s->archiveDensity = 0 ;
+    s->nextCommit = 0 ;
+    pthread_mutex_init(&s->commitLock,NULL) ;
+    pthread_cond_init(&s->committed,NULL) ;
+    s->binary = binary ;
+    s->encoding = encoding ;
+    s->presolve = presolve ;
+    s->cardinality = cardinality ;
+    s->coupled = coupled ;
+    s->stream = stream ;
+    s->rng = NULL ;
+    s->checkpointPath = NULL ;
+    s->checkpointKey = NULL ;
+    s->units = coupled ? BOARDS : densityTotal*BOARDS ;
+    s->checkpointEvery = coupled ? (CHECKPOINT_FORMULAE + densityTotal - 1)/densityTotal : CHECKPOINT_FORMULAE ;
+    s->finished = calloc(s->units,sizeof(bool)) ;
+    s->finishedCount = 0 ;
+    return ;
 }
-int uniqueVarCount(descriptionNode * d){
-    int t = 0 ; 
-    int s = 0 ;
-    descriptionNode * temp = d ;
-    // Traverse the description linked list, counting the number of runs and the total length of the runs
-    while (temp != NULL){
-        s += temp->val ;
-        t += 1 ;
-        temp = temp->next ;
-    }
-    return (2*N+1)*(t+s) + N ; // return the recurrence (section 2.4)
+
+void finishSweep(sweep * s){
+    archive_finish(s->archive) ;
+    s->archive = NULL ;
+    pthread_mutex_destroy(&s->commitLock) ;
+    pthread_cond_destroy(&s->committed) ;
+    free(s->finished) ;
+    return ;
 }
-int digits(int number){
-    int copy = number ;
-    return (int) log10(copy) + 1 ;
+
+void finishUnit(sweep * s, int unit){
+    if (s->archivePath != NULL){ // commitBoard has done it
+        return ;
+    }
+    pthread_mutex_lock(&s->commitLock) ;
+    unitsFinished(s,unit) ;
+    pthread_mutex_unlock(&s->commitLock) ;
+    return ;
 }
 
-int * randomFilled(float p, MTRand seed){
-    int * tiles = malloc(sizeof(int)*N*N) ;
-    for (int i = 0 ; i < N*N ; i++){
-        if (genRand(&seed) < p){
-            tiles[i] = 1 ;
-        } else {
-            tiles[i] = 0 ;
-        }
+void unitsFinished(sweep * s, int unit){
+    s->finished[unit] = true ;
+    int before = s->finishedCount ;
+    while (s->finishedCount < s->units && s->finished[s->finishedCount]){
+        s->finishedCount += 1 ;
     }
-    return tiles ;
+    if (s->checkpointPath != NULL && s->finishedCount != before &&
+        (s->finishedCount/s->checkpointEvery != before/s->checkpointEvery || s->finishedCount == s->units)){
+        takeCheckpoint(s) ;
+    }
+    return ;
 }
 
-int * transpose(int * matrixList){
-    for (int i = 0 ; i < N ; i++){
-        for (int j = (N+1)*i + 1 ; j < (i+1)*N ; j++){
-            int t = matrixList[j] ;
-            matrixList[j] = matrixList[(j%N)*N + i] ;
-            matrixList[(j%N)*N + i] = t ;
+void takeCheckpoint(sweep * s){
+    Checkpoint c ;
+    memset(&c,0,sizeof(c)) ;
+    snprintf(c.key,sizeof(c.key),"%s",s->checkpointKey) ;
+    c.position = s->finishedCount ;
+    c.hasRng = s->rng != NULL ;
+    if (c.hasRng){
+        c.rng = *s->rng ;
+    }
+    c.hasArchive = s->archive != NULL ;
+    if (c.hasArchive){
+        size_t count ;
+        c.entries = (ArchiveEntry *) archive_progress(s->archive,&count,&c.archiveOffset) ;
+        c.entryCount = count ;
+        c.archiveDensity = s->archiveDensity ;
+    }
+    checkpoint_write(s->checkpointPath,&c) ; // Reported if it fails, and the sweep goes on to the next one
+    return ;
+}
+
+int resumeSweep(sweep * s){
+    Checkpoint c ;
+    if (!checkpoint_read(s->checkpointPath,s->checkpointKey,&c)){
+        return -1 ;
+    }
+    if (c.position < 0 || c.position > s->units || c.hasRng != (s->rng != NULL)){
+        fprintf(stderr,"%s does not fit this sweep\n",s->checkpointPath) ;
+        checkpoint_release(&c) ;
+        return -1 ;
+    }
+    s->finishedCount = c.position ;
+    for (int u = 0 ; u < c.position ; u++){
+        s->finished[u] = true ;
+    }
+    atomic_store(&s->nextJob,c.position) ;
+    s->nextCommit = s->coupled ? c.position*s->densityTotal : c.position ;
+    if (c.hasRng){
+        *s->rng = c.rng ;
+    }
+    if (c.hasArchive){
+        char path[1024] ;
+        snprintf(path,sizeof(path),s->archivePath,c.archiveDensity) ;
+        s->archive = archive_resume(path,c.entries,c.entryCount,c.archiveOffset) ;
+        if (s->archive == NULL){
+            checkpoint_release(&c) ;
+            return -1 ;
         }
+        s->archiveDensity = c.archiveDensity ;
     }
-    return matrixList ;
+    checkpoint_release(&c) ;
+    printf("Resuming after %d of %d %s\n",s->finishedCount,s->units,s->coupled ? "board indices" : "boards") ;
+    return s->finishedCount ;
 }
 
-descriptionNode ** descriptionsFromBoard(int * board){
-    descriptionNode ** descriptions = malloc(N*sizeof(descriptionNode)) ;
-    // There are N rows or N columns to get descriptions for
-    for (int i = 0 ; i < N ; i++){
-        descriptionNode * head = malloc(sizeof(descriptionNode)) ;
-        head->length = 0 ; // start off with no description elements
-        descriptions[i] = head ;
-        int currentRun = 0 ; // zero-length run to start
-        bool currentlyRunning = false ; // not in a run to start
-
-        for (int j = i*N ; j < (i+1)*N ; j++){
-            if (board[j] == 1){ // If you see a filled cell
-                currentRun += 1 ;
-                currentlyRunning = true ;
-            } else {
-                // If you had been seeing filled cells, you've reached the end of a run and can add it to the description
-                if (currentlyRunning){ 
-                    appendDescription(descriptions[i],currentRun) ;
-                    currentlyRunning = false ;
-                    currentRun = 0 ;
-                }
+void * sweepWorker(void * arg){
+    sweep * s = arg ;
+    uint64_t * board = malloc(s->size*boardWords(s->size)*sizeof(uint64_t)) ;
+    ClauseSink * out = newBoardSink(s) ;
+    Arena * scratch = arena_new(SCRATCH_SIZE) ;
+    LineCache * cache = linecache_new(s->encoding,CACHE_LITERALS) ;
+    TRACE_THREAD("worker") ;
+    if (s->coupled){
+        coupledWorker(s,board,out,scratch,cache) ;
+    } else {
+        while (true){
+            int job = atomic_fetch_add(&s->nextJob,1) ;
+            if (job >= s->densityTotal*BOARDS){
+                break ;
             }
-        }
-        // If you end and are running, add that to the description as well
-        if (currentlyRunning){
-            appendDescription(descriptions[i],currentRun) ;
+            int densityIndex = job / BOARDS ;
+            int b = job % BOARDS ;
+            if (b == 0){
+                printf("%.2f\n",s->densities[densityIndex]) ;
+            }
+            MTRand seed = seedRand(boardSeed(SEED,densityIndex,b)) ;
+            STATS_START(filling) ;
+            fillBoard(board,s->size,s->densities[densityIndex],&seed) ;
+            STATS_STOP(filling,STAGE_GENERATE) ;
+            writeBoard(s,board,densityIndex,b,out,scratch,cache,NULL) ;
+            finishUnit(s,job) ;
         }
     }
-    return descriptions ;
+    STATS_COUNTER("linecache hits",linecache_hits(cache)) ;
+    STATS_COUNTER("linecache misses",linecache_misses(cache)) ;
+    STATS_MERGE() ; // Into the totals before the thread's counters go with it
+    linecache_free(cache) ;
+    arena_free(scratch) ;
+    sink_free(out) ;
+    free(board) ;
+    return NULL ;
 }
 
-void freeDescription(descriptionNode * d){
-    descriptionNode * temp = d ;
-    descriptionNode * tempNext = NULL ;
-    while (temp != NULL){
-        tempNext = temp->next ;
-        free(temp) ;
-        temp = tempNext ;
+void coupledWorker(sweep * s, uint64_t * board, ClauseSink * out, Arena * scratch, LineCache * cache){
+    const int N = s->size ;
+    double * field = malloc(N*N*sizeof(double)) ;
+    LineHistory * history = linehistory_new(2*N,N*N) ;
+    while (true){
+        int b = atomic_fetch_add(&s->nextJob,1) ;
+        if (b >= BOARDS){
+            break ;
+        }
+        if (b % 50 == 0){
+            printf("Board: %d\n",b) ;
+        }
+        MTRand seed = seedRand(boardSeed(SEED,-1,b)) ; // The density index -1 sets the field apart from the streams of the other sweep
+        STATS_START(filling) ;
+        fillField(field,N,&seed) ;
+        STATS_STOP(filling,STAGE_GENERATE) ;
+        linehistory_clear(history) ;
+        for (int densityIndex = 0 ; densityIndex < s->densityTotal ; densityIndex++){
+            STATS_START(thresholding) ;
+            fieldBoard(board,N,field,s->densities[densityIndex]) ;
+            STATS_STOP(thresholding,STAGE_GENERATE) ;
+            writeBoard(s,board,densityIndex,b,out,scratch,cache,history) ;
+        }
+        finishUnit(s,b) ;
     }
+    STATS_COUNTER("linehistory reused",linehistory_reused(history)) ;
+    STATS_COUNTER("linehistory rewritten",linehistory_rewritten(history)) ;
+    linehistory_free(history) ;
+    free(field) ;
     return ;
 }
 
-Buf emptyLine(int * stringVars){
-    Buf dimacs = buf_new(N*(digits(stringVars[N-1]) + 5)) ;
-    for (int i = 0 ; i < N ; i++){
-        buf_append(dimacs,"-%d 0\n",stringVars[i]) ;
+int runSweepPool(sweep * s, int threads){
+    pthread_t * workers = malloc(threads*sizeof(pthread_t)) ;
+    for (int i = 0 ; i < threads ; i++){
+        if (pthread_create(&workers[i],NULL,sweepWorker,s) != 0){
+            perror("pthread_create") ;
+            exit(1) ;
+        }
     }
-    return dimacs ;
-    
-}
\ No newline at end of file
+    for (int i = 0 ; i < threads ; i++){
+        pthread_join(workers[i],NULL) ;
+    }
+    free(workers) ;
+    printf("\n") ;
+    return 0 ;
+}
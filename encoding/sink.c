@@ -0,0 +1,505 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+
+#include "sink.h"
+#include "bincnf.h"
+#include "stats.h"
+
+#define SINK_OUT_CAP (1 << 20)  // bytes buffered before a flush to file
+#define SINK_LIT_CAP 64         // initial literal capacity of a clause
+#define SINK_LIT_BYTES 12       // enough for "-2147483648 " (or a varint literal)
+#define SINK_WIDE_BYTES 24      // the same for a 64-bit literal, which writeWide may run 21 bytes past
+
+/*
+Two ASCII digits for every value below 100, so integers are written two digits per division.
+*/
+static const char digitPairs[201] =
+    "00010203040506070809"
+    "10111213141516171819"
+    "20212223242526272829"
+    "30313233343536373839"
+    "40414243444546474849"
+    "50515253545556575859"
+    "60616263646566676869"
+    "70717273747576777879"
+    "80818283848586878889"
+    "90919293949596979899" ;
+
+/*
+    Write the decimal representation of v at p. The digits are copied as a fixed 10 bytes (a
+    length known at compile time, rather than a call to memcpy), so up to 11 bytes past p may be
+    overwritten; SINK_LIT_BYTES leaves room for that.
+    Returns: the position just past the last character written.
+*/
+static inline char * writeInt (char * p, int v)
+{
+    unsigned int u = v ;
+    if (v < 0) {
+        *p++ = '-' ;
+        u = -u ;
+    }
+
+    char tmp[20] ;
+    char * t = tmp + 10 ;
+    while (u >= 100) {
+        const unsigned int q = u / 100 ;
+        t -= 2 ;
+        memcpy(t, digitPairs + 2*(u - 100*q), 2) ;
+        u = q ;
+    }
+    if (u >= 10) {
+        t -= 2 ;
+        memcpy(t, digitPairs + 2*u, 2) ;
+    } else {
+        *--t = '0' + u ;
+    }
+
+    const size_t n = tmp + 10 - t ;
+    memcpy(p, t, 10) ;
+    return p + n ;
+}
+
+/*
+    writeInt for 64-bit values, copying a fixed 20 bytes of digits (so up to 21 bytes past p may be
+    overwritten; SINK_WIDE_BYTES leaves room for that).
+    Returns: the position just past the last character written.
+*/
+static inline char * writeWide (char * p, int64_t v)
+{
+    uint64_t u = v ;
+    if (v < 0) {
+        *p++ = '-' ;
+        u = -u ;
+    }
+
+    char tmp[40] ;
+    char * t = tmp + 20 ;
+    while (u >= 100) {
+        const uint64_t q = u / 100 ;
+        t -= 2 ;
+        memcpy(t, digitPairs + 2*(u - 100*q), 2) ;
+        u = q ;
+    }
+    if (u >= 10) {
+        t -= 2 ;
+        memcpy(t, digitPairs + 2*u, 2) ;
+    } else {
+        *--t = '0' + u ;
+    }
+
+    const size_t n = tmp + 20 - t ;
+    memcpy(p, t, 20) ;
+    return p + n ;
+}
+
+void sink_reserve (ClauseSink * sink, size_t extra)
+{
+    if (sink->outLen + extra <= sink->outCap) return ;
+
+    if (sink->fp) {
+        sink_flush(sink) ;
+        if (extra <= sink->outCap) return ;
+    }
+
+    size_t cap = sink->outCap ;
+    while (sink->outLen + extra > cap) cap *= 2 ;
+    char * out = realloc(sink->out, cap) ;
+    if (!out) {
+        fprintf(stderr, "sink_reserve failed\n") ;
+        exit(1) ;
+    }
+    sink->out = out ;
+    sink->outCap = cap ;
+}
+
+void sink_growClause (ClauseSink * sink)
+{
+    int * lits = realloc(sink->lits, 2*sink->cap*sizeof(int)) ;
+    if (!lits) {
+        fprintf(stderr, "sink_growClause failed\n") ;
+        exit(1) ;
+    }
+    sink->lits = lits ;
+    sink->cap *= 2 ;
+}
+
+/*
+    DIMACS text: "p cnf V C" and then each clause as its literals followed by a terminating 0.
+*/
+static void dimacsHeader (ClauseSink * sink, int64_t vars, int64_t clauses)
+{
+    sink_reserve(sink, 8 + 2*SINK_WIDE_BYTES) ;
+    char * p = sink->out + sink->outLen ;
+    memcpy(p, "p cnf ", 6) ;
+    p = writeWide(p + 6, vars) ;
+    *p++ = ' ' ;
+    p = writeWide(p, clauses) ;
+    *p++ = '\n' ;
+    sink->outLen = p - sink->out ;
+}
+
+static void dimacsClause (ClauseSink * sink, const int * lits, int len)
+{
+    sink_reserve(sink, (size_t) len*SINK_LIT_BYTES + SINK_LIT_BYTES) ;
+    char * p = sink->out + sink->outLen ;
+    for (int i = 0 ; i < len ; i++) {
+        p = writeInt(p, lits[i]) ;
+        *p++ = ' ' ;
+    }
+    *p++ = '0' ;
+    *p++ = '\n' ;
+    sink->outLen = p - sink->out ;
+}
+
+static void dimacsClauses (ClauseSink * sink, const int * packed, size_t size)
+{
+    // Every int of the packed clauses takes at most SINK_LIT_BYTES, the lengths included (as "0\n")
+    sink_reserve(sink, (size + 1)*SINK_LIT_BYTES) ;
+    char * p = sink->out + sink->outLen ;
+    const int * end = packed + size ;
+    while (packed < end) {
+        const int len = *packed++ ;
+        for (int i = 0 ; i < len ; i++) {
+            p = writeInt(p, packed[i]) ;
+            *p++ = ' ' ;
+        }
+        *p++ = '0' ;
+        *p++ = '\n' ;
+        packed += len ;
+    }
+    sink->outLen = p - sink->out ;
+}
+
+static void dimacsLabelled (ClauseSink * sink, const int * packed, size_t size, const int64_t * label)
+{
+    sink_reserve(sink, (size + 1)*SINK_WIDE_BYTES) ;
+    char * p = sink->out + sink->outLen ;
+    const int * end = packed + size ;
+    while (packed < end) {
+        const int len = *packed++ ;
+        for (int i = 0 ; i < len ; i++) {
+            p = writeWide(p, packed[i] < 0 ? -label[-packed[i]] : label[packed[i]]) ;
+            *p++ = ' ' ;
+        }
+        *p++ = '0' ;
+        *p++ = '\n' ;
+        packed += len ;
+    }
+    sink->outLen = p - sink->out ;
+}
+
+static void bufferFlush (ClauseSink * sink)
+{
+    if (!sink->fp || !sink->outLen) return ;
+    STATS_START(writeStart) ;
+    if (fwrite(sink->out, 1, sink->outLen, sink->fp) != sink->outLen) {
+        perror("sink_flush") ;
+    }
+    STATS_STOP(writeStart, STAGE_WRITE) ;
+    STATS_ADD(STAGE_WRITE, bytes, sink->outLen) ;
+    sink->outLen = 0 ;
+}
+
+/*
+    Binary: the magic and version, the counts, and then each clause as its length and delta coded
+    literals (see bincnf.h).
+*/
+static void bincnfHeader (ClauseSink * sink, int64_t vars, int64_t clauses)
+{
+    const uint32_t version = BINCNF_VERSION ;
+    sink_reserve(sink, 8 + 2*SINK_WIDE_BYTES) ;
+    unsigned char * p = (unsigned char *) sink->out + sink->outLen ;
+    memcpy(p, BINCNF_MAGIC, 4) ;
+    memcpy(p + 4, &version, sizeof version) ;
+    p = bincnf_putVarint(p + 8, vars) ;
+    p = bincnf_putVarint(p, clauses) ;
+    sink->outLen = (char *) p - sink->out ;
+    sink->prev = 0 ;
+}
+
+static inline unsigned char * bincnfPut (unsigned char * p, const int * lits, int len, int64_t * prev)
+{
+    p = bincnf_putVarint(p, len) ;
+    for (int i = 0 ; i < len ; i++) {
+        p = bincnf_putVarint(p, bincnf_code(lits[i], *prev)) ;
+        *prev = lits[i] < 0 ? -lits[i] : lits[i] ;
+    }
+    return p ;
+}
+
+static void bincnfClause (ClauseSink * sink, const int * lits, int len)
+{
+    sink_reserve(sink, (size_t) (len + 1)*SINK_LIT_BYTES) ;
+    unsigned char * p = (unsigned char *) sink->out + sink->outLen ;
+    p = bincnfPut(p, lits, len, &sink->prev) ;
+    sink->outLen = (char *) p - sink->out ;
+}
+
+static void bincnfClauses (ClauseSink * sink, const int * packed, size_t size)
+{
+    sink_reserve(sink, size*SINK_LIT_BYTES) ;
+    unsigned char * p = (unsigned char *) sink->out + sink->outLen ;
+    const int * end = packed + size ;
+    while (packed < end) {
+        const int len = *packed++ ;
+        p = bincnfPut(p, packed, len, &sink->prev) ;
+        packed += len ;
+    }
+    sink->outLen = (char *) p - sink->out ;
+}
+
+static void bincnfLabelled (ClauseSink * sink, const int * packed, size_t size, const int64_t * label)
+{
+    sink_reserve(sink, size*SINK_WIDE_BYTES) ;
+    unsigned char * p = (unsigned char *) sink->out + sink->outLen ;
+    const int * end = packed + size ;
+    while (packed < end) {
+        const int len = *packed++ ;
+        p = bincnf_putVarint(p, len) ;
+        for (int i = 0 ; i < len ; i++) {
+            const int64_t var = label[packed[i] < 0 ? -packed[i] : packed[i]] ;
+            p = bincnf_putVarint(p, bincnf_code(packed[i] < 0 ? -var : var, sink->prev)) ;
+            sink->prev = var ;
+        }
+        packed += len ;
+    }
+    sink->outLen = (char *) p - sink->out ;
+}
+
+/*
+    Record: no header, and each clause as an int length followed by its int literals.
+*/
+static void recordHeader (ClauseSink * sink, int64_t vars, int64_t clauses)
+{
+    (void) sink ;
+    (void) vars ;
+    (void) clauses ;
+}
+
+static void recordClause (ClauseSink * sink, const int * lits, int len)
+{
+    sink_reserve(sink, (size_t) (len + 1)*sizeof(int)) ;
+    int * p = (int *) (sink->out + sink->outLen) ;
+    *p++ = len ;
+    memcpy(p, lits, len*sizeof(int)) ;
+    sink->outLen += (size_t) (len + 1)*sizeof(int) ;
+}
+
+static void recordClauses (ClauseSink * sink, const int * packed, size_t size)
+{
+    sink_reserve(sink, size*sizeof(int)) ;
+    memcpy(sink->out + sink->outLen, packed, size*sizeof(int)) ;
+    sink->outLen += size*sizeof(int) ;
+}
+
+static void recordLabelled (ClauseSink * sink, const int * packed, size_t size, const int64_t * label)
+{
+    (void) sink ;
+    (void) packed ;
+    (void) size ;
+    (void) label ;
+    fprintf(stderr, "The recording sink cannot hold labelled clauses\n") ;
+    exit(1) ;
+}
+
+/*
+    Relabelling: recorded as for the record sink, and handed on to the target sink as labelled
+    clauses whenever the buffer is full, so it never grows past SINK_OUT_CAP (but for a clause that
+    is larger on its own).
+*/
+static void relabelFlush (ClauseSink * sink)
+{
+    if (!sink->outLen) return ;
+    sink_labelled(sink->target, (const int *) sink->out, sink->outLen/sizeof(int), sink->label) ;
+    sink->outLen = 0 ;
+}
+
+static void relabelClause (ClauseSink * sink, const int * lits, int len)
+{
+    if (sink->outLen + (size_t) (len + 1)*sizeof(int) > sink->outCap) relabelFlush(sink) ;
+    recordClause(sink, lits, len) ;
+}
+
+static void relabelClauses (ClauseSink * sink, const int * packed, size_t size)
+{
+    const int * end = packed + size ;
+    while (packed < end) {
+        const int len = *packed++ ;
+        relabelClause(sink, packed, len) ;
+        packed += len ;
+    }
+}
+
+/*
+    CSR: each clause's literals one after another in the caller's array, and where each clause
+    ends in the caller's offsets. A clause is only written if it and every clause before it fit,
+    so what is written is always a whole formula; past that, clauses are only counted.
+*/
+static void csrHeader (ClauseSink * sink, int64_t vars, int64_t clauses)
+{
+    (void) sink ;
+    (void) vars ;
+    (void) clauses ;
+}
+
+// Room for the clause of len literals that starts at literal at, counting it either way
+static inline bool csrFits (ClauseSink * sink, size_t at, int len)
+{
+    sink->outLen += (size_t) len*sizeof(int) ;
+    const bool fits = sink->clauseCount < sink->clauseCap && sink->outLen <= sink->outCap ;
+    sink->clauseCount += 1 ;
+    if (fits) sink->offsets[sink->clauseCount] = at + len ;
+    return fits ;
+}
+
+static void csrClause (ClauseSink * sink, const int * lits, int len)
+{
+    const size_t at = sink->outLen/sizeof(int) ;
+    if (csrFits(sink, at, len)) memcpy((int *) sink->out + at, lits, len*sizeof(int)) ;
+}
+
+static void csrClauses (ClauseSink * sink, const int * packed, size_t size)
+{
+    const int * end = packed + size ;
+    while (packed < end) {
+        const int len = *packed++ ;
+        csrClause(sink, packed, len) ;
+        packed += len ;
+    }
+}
+
+static void csrLabelled (ClauseSink * sink, const int * packed, size_t size, const int64_t * label)
+{
+    const int * end = packed + size ;
+    while (packed < end) {
+        const int len = *packed++ ;
+        const size_t at = sink->outLen/sizeof(int) ;
+        if (csrFits(sink, at, len)) {
+            int * p = (int *) sink->out + at ;
+            for (int j = 0 ; j < len ; j++) {
+                const int lit = packed[j] ;
+                p[j] = lit > 0 ? (int) label[lit] : (int) -label[-lit] ;
+            }
+        }
+        packed += len ;
+    }
+}
+
+static const SinkOps dimacsOps = {dimacsHeader, dimacsClause, dimacsClauses, dimacsLabelled, bufferFlush} ;
+static const SinkOps bincnfOps = {bincnfHeader, bincnfClause, bincnfClauses, bincnfLabelled, bufferFlush} ;
+static const SinkOps recordOps = {recordHeader, recordClause, recordClauses, recordLabelled, bufferFlush} ;
+static const SinkOps relabelOps = {recordHeader, relabelClause, relabelClauses, recordLabelled, relabelFlush} ;
+static const SinkOps csrOps = {csrHeader, csrClause, csrClauses, csrLabelled, bufferFlush} ;
+
+static ClauseSink * newSink (const SinkOps * ops, FILE * fp)
+{
+    ClauseSink * sink = malloc(sizeof(ClauseSink)) ;
+    sink->ops = ops ;
+    sink->lits = malloc(SINK_LIT_CAP*sizeof(int)) ;
+    sink->len = 0 ;
+    sink->cap = SINK_LIT_CAP ;
+    sink->out = malloc(SINK_OUT_CAP) ;
+    sink->outLen = 0 ;
+    sink->outCap = SINK_OUT_CAP ;
+    sink->fp = fp ;
+    sink->prev = 0 ;
+    sink->offsets = NULL ;
+    sink->clauseCap = 0 ;
+    sink->clauseCount = 0 ;
+    sink->target = NULL ;
+    sink->label = NULL ;
+    if (!sink->lits || !sink->out) {
+        fprintf(stderr, "newSink failed\n") ;
+        exit(1) ;
+    }
+    return sink ;
+}
+
+/*
+    Allocate a text DIMACS sink writing to fp (in memory if fp is NULL).
+    Returns: ClauseSink*
+*/
+ClauseSink * sink_dimacs (FILE * fp)
+{
+    return newSink(&dimacsOps, fp) ;
+}
+
+/*
+    Allocate a binary CNF sink writing to fp (in memory if fp is NULL).
+    Returns: ClauseSink*
+*/
+ClauseSink * sink_bincnf (FILE * fp)
+{
+    return newSink(&bincnfOps, fp) ;
+}
+
+/*
+    Allocate an in-memory sink recording the clauses as ints.
+    Returns: ClauseSink*
+*/
+ClauseSink * sink_record (void)
+{
+    return newSink(&recordOps, NULL) ;
+}
+
+/*
+    Allocate a sink handing its clauses on to target, relabelled with label.
+    Returns: ClauseSink*
+*/
+ClauseSink * sink_relabel (ClauseSink * target, const int64_t * label)
+{
+    ClauseSink * sink = newSink(&relabelOps, NULL) ;
+    sink->target = target ;
+    sink->label = label ;
+    return sink ;
+}
+
+/*
+    Allocate a sink writing into the caller's arrays in CSR form: lits, of litCap ints, and offsets,
+    of clauseCap + 1 entries (NULL if clauseCap is 0).
+    Returns: ClauseSink*
+*/
+ClauseSink * sink_csr (int * lits, size_t litCap, size_t * offsets, size_t clauseCap)
+{
+    ClauseSink * sink = newSink(&csrOps, NULL) ;
+    free(sink->out) ;
+    sink->out = (char *) lits ;
+    sink->outCap = litCap*sizeof(int) ;
+    sink->offsets = offsets ;
+    sink->clauseCap = clauseCap ;
+    if (offsets) offsets[0] = 0 ;
+    return sink ;
+}
+
+void sink_free (ClauseSink * sink)
+{
+    if (!sink) return ;
+    sink_flush(sink) ;
+    free(sink->lits) ;
+    if (sink->ops != &csrOps) free(sink->out) ; // the CSR sink's arrays are the caller's
+    free(sink) ;
+}
+
+void sink_header (ClauseSink * sink, int64_t vars, int64_t clauses)
+{
+    sink->ops->header(sink, vars, clauses) ;
+}
+
+void sink_flush (ClauseSink * sink)
+{
+    sink->ops->flush(sink) ;
+}
+
+void sink_reset (ClauseSink * sink)
+{
+    sink->len = 0 ;
+    sink->outLen = 0 ;
+    sink->prev = 0 ;
+    sink->clauseCount = 0 ;
+}
+
+/* Accessors */
+const char * sink_data (const ClauseSink * sink) { return sink->out ; }
+size_t sink_size (const ClauseSink * sink) { return sink->outLen ; }
@@ -0,0 +1,143 @@
+#pragma once
+
+#include <stdio.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+A clause sink is where an encoder sends its CNF formula. The encoder hands over integer literals
+one at a time (sink_lit) and closes each clause with sink_end, and the sink decides what the
+formula turns into. The literals of the clause being built are collected in the sink, so each
+kind of sink only sees whole clauses through its clause operation.
+
+The DIMACS sink formats clauses as text straight into a large output buffer, which is flushed to
+a file when it fills up (or kept in memory if there is no file). The binary sink works the same
+way but writes the compact varint format described in bincnf.h. The recording sink keeps the
+clauses as plain ints in memory (each clause as its length and then its literals), for code that
+works on the clauses themselves rather than writing them out. The CSR sink writes the clauses
+into arrays the caller provides (see formula.h), for code that wants the formula in memory without
+going through DIMACS text. The relabelling sink records clauses the same way as the recording
+sink, but hands them on to another sink with their variables relabelled (see sink_labelled) each
+time its buffer fills, so a constraint built over its own small numbering can be written with its
+64-bit variables without being held in memory whole.
+
+The counts in the header and the literals of labelled clauses (sink_labelled) are 64-bit, so the
+text and binary sinks can write formulae with more variables than an int holds. Every other
+literal is an int.
+*/
+
+typedef struct ClauseSink ClauseSink ;
+
+typedef struct SinkOps {
+    void (*header)(ClauseSink * sink, int64_t vars, int64_t clauses) ; // the "p cnf" line
+    void (*clause)(ClauseSink * sink, const int * lits, int len) ; // one whole clause
+    void (*clauses)(ClauseSink * sink, const int * packed, size_t size) ; // many clauses, each as its length then its literals
+    void (*labelled)(ClauseSink * sink, const int * packed, size_t size, const int64_t * label) ; // the same, with variable v written as label[v]
+    void (*flush)(ClauseSink * sink) ; // push buffered output to the file
+} SinkOps ;
+
+struct ClauseSink {
+    const SinkOps * ops ;
+    int * lits ;        // literals of the clause being built
+    int len ;           // number of literals in the clause being built
+    int cap ;           // capacity of lits
+    char * out ;        // output buffer
+    size_t outLen ;     // bytes in the output buffer
+    size_t outCap ;     // capacity of the output buffer
+    FILE * fp ;         // file the output buffer is flushed to (NULL keeps everything in memory)
+    int64_t prev ;      // variable of the last literal written (binary format)
+    size_t * offsets ;  // where each clause ends in out, in ints (CSR format)
+    size_t clauseCap ;  // clauses offsets has room for (CSR format)
+    size_t clauseCount ; // clauses written or counted (CSR format)
+    ClauseSink * target ; // sink the clauses are handed on to (relabelling)
+    const int64_t * label ; // 64-bit variable of each variable (relabelling)
+} ;
+
+// Text DIMACS sink flushing to fp (or kept in memory when fp is NULL)
+ClauseSink * sink_dimacs (FILE * fp) ;
+
+// Binary CNF sink (see bincnf.h) flushing to fp (or kept in memory when fp is NULL)
+ClauseSink * sink_bincnf (FILE * fp) ;
+
+// In-memory sink recording each clause as its length followed by its literals (the header is dropped)
+ClauseSink * sink_record (void) ;
+
+// Sink handing its clauses on to target with each variable v written as label[v], in batches of
+// the buffer's size (the last when flushed or freed). The label array is not freed with the sink.
+ClauseSink * sink_relabel (ClauseSink * target, const int64_t * label) ;
+
+/*
+In-memory sink writing into the caller's arrays, as for formula.h: the literals of clause i are
+lits[offsets[i]] up to lits[offsets[i + 1]], with litCap ints in lits and clauseCap + 1 entries in
+offsets. Clauses that do not fit are counted (sink_size is the bytes of every literal) but not
+written, so a sink with no room sizes a formula. The arrays are not freed with the sink.
+*/
+ClauseSink * sink_csr (int * lits, size_t litCap, size_t * offsets, size_t clauseCap) ;
+
+// Flush any buffered output and free the sink. Does not close the file.
+void sink_free (ClauseSink * sink) ;
+
+// Write the header of a formula with `vars` variables and `clauses` clauses.
+void sink_header (ClauseSink * sink, int64_t vars, int64_t clauses) ;
+
+// Push buffered output to the file (no-op for in-memory sinks).
+void sink_flush (ClauseSink * sink) ;
+
+// Drop everything buffered so far (for reusing an in-memory sink).
+void sink_reset (ClauseSink * sink) ;
+
+// Accessors for the bytes buffered in the sink
+const char * sink_data (const ClauseSink * sink) ;
+size_t sink_size (const ClauseSink * sink) ;
+
+// Make room for `extra` more bytes in the output buffer, flushing or growing it.
+void sink_reserve (ClauseSink * sink, size_t extra) ;
+
+// Grow the clause under construction (used by sink_lit).
+void sink_growClause (ClauseSink * sink) ;
+
+// Add a literal to the clause being built.
+static inline void sink_lit (ClauseSink * sink, int lit)
+{
+    if (sink->len == sink->cap) sink_growClause(sink) ;
+    sink->lits[sink->len++] = lit ;
+}
+
+// Close the clause being built and hand it to the sink.
+static inline void sink_end (ClauseSink * sink)
+{
+    sink->ops->clause(sink, sink->lits, sink->len) ;
+    sink->len = 0 ;
+}
+
+// Emit a whole clause at once.
+static inline void sink_clause (ClauseSink * sink, const int * lits, int len)
+{
+    sink->ops->clause(sink, lits, len) ;
+}
+
+// Emit a run of clauses packed as length, literals, length, literals, ... (`size` ints in all),
+// the same form the recording sink keeps them in.
+static inline void sink_clauses (ClauseSink * sink, const int * packed, size_t size)
+{
+    sink->ops->clauses(sink, packed, size) ;
+}
+
+// Emit packed clauses (as for sink_clauses) with each literal l written as label[|l|], with the sign of l.
+// Not supported by the recording and relabelling sinks, which only hold int literals.
+static inline void sink_labelled (ClauseSink * sink, const int * packed, size_t size, const int64_t * label)
+{
+    sink->ops->labelled(sink, packed, size, label) ;
+}
+
+// Shorthands for the unit and binary clauses that make up most of the encodings
+static inline void sink_unit (ClauseSink * sink, int a)
+{
+    sink->ops->clause(sink, &a, 1) ;
+}
+
+static inline void sink_binary (ClauseSink * sink, int a, int b)
+{
+    const int lits[2] = {a, b} ;
+    sink->ops->clause(sink, lits, 2) ;
+}
@@ -0,0 +1,602 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+
+#include "solver.h"
+
+#define CLAUSE_HEADER 2         // each clause in the pool is its size, its LBD (0 for an original clause), then its literals
+#define VAR_DECAY 0.95          // how quickly the activity of variables left out of conflicts fades
+#define RESTART_UNIT 100        // conflicts in the shortest run between restarts (the runs follow the Luby sequence)
+#define MIN_LEARNTS 2000        // learnt clauses kept before the first thinning out, at the least
+#define LEARNT_GROWTH 1.1       // how much that grows each time
+
+typedef struct watcher {
+    int cref ;      // the clause
+    int blocker ;   // one of its literals, and if it is true the clause need not be looked at
+} watcher ;
+
+typedef struct watchList {
+    watcher * items ;
+    int count ;
+    int cap ;
+} watchList ;
+
+struct Solver {
+    int vars ;
+    int * pool ;            // every clause, originals first
+    size_t poolLen ;
+    size_t poolCap ;
+    size_t originalEnd ;    // where the learnt clauses start in the pool
+    int * learnts ;         // where each learnt clause is in the pool
+    int learntCount ;
+    int learntCap ;
+    int maxLearnts ;
+    watchList * watches ;   // for each literal, the clauses watching it
+    signed char * assigns ; // for each variable, 1 (true), -1 (false), or 0
+    signed char * phase ;   // the value each variable last had
+    int * level ;
+    int * reason ;          // the clause that implied each variable, or -1
+    char * seen ;
+    double * activity ;
+    double varInc ;
+    int * heap ;            // the unassigned variables (and some assigned ones), by activity
+    int * heapIndex ;       // where each variable is in the heap, or -1
+    int heapSize ;
+    int * trail ;
+    int trailLen ;
+    int qhead ;             // trail literals before this are propagated
+    int * trailLim ;        // where each decision level starts in the trail
+    int levels ;
+    int * learnt ;          // the clause being learnt
+    int * toClear ;         // its literals before minimizing, whose seen flags have to be cleared
+    int * levelStamp ;      // for counting the decision levels of a clause
+    int stamp ;
+    int levelCap ;          // levels trailLim and levelStamp have room for
+    bool unsat ;            // the formula has no solution at all
+    long propagations ;
+    long conflicts ;
+} ;
+
+static inline int litIndex (int lit) { return 2*abs(lit) + (lit < 0) ; }
+static inline int * clauseLits (const Solver * s, int cref) { return s->pool + cref + CLAUSE_HEADER ; }
+static inline int clauseSize (const Solver * s, int cref) { return s->pool[cref] ; }
+
+static inline int value (const Solver * s, int lit)
+{
+    const int v = s->assigns[abs(lit)] ;
+    return lit > 0 ? v : -v ;
+}
+
+static void * grow (void * items, int * cap, size_t itemSize)
+{
+    *cap = *cap ? 2*(*cap) : 4 ;
+    items = realloc(items, (size_t) *cap*itemSize) ;
+    if (!items) {
+        fprintf(stderr, "solver out of memory\n") ;
+        exit(1) ;
+    }
+    return items ;
+}
+
+static inline void watch (Solver * s, int lit, int cref, int blocker)
+{
+    watchList * w = &s->watches[litIndex(lit)] ;
+    if (w->count == w->cap) w->items = grow(w->items, &w->cap, sizeof(watcher)) ;
+    w->items[w->count++] = (watcher) {cref, blocker} ;
+}
+
+static void attach (Solver * s, int cref)
+{
+    const int * c = clauseLits(s, cref) ;
+    watch(s, c[0], cref, c[1]) ;
+    watch(s, c[1], cref, c[0]) ;
+}
+
+// Add a clause of at least two literals to the pool. Returns: where it is
+static int addClause (Solver * s, const int * lits, int size, int lbd)
+{
+    const size_t needed = s->poolLen + CLAUSE_HEADER + size ;
+    if (needed > INT_MAX) {
+        fprintf(stderr, "solver clause pool full\n") ;
+        exit(1) ;
+    }
+    if (needed > s->poolCap) {
+        while (needed > s->poolCap) s->poolCap = s->poolCap ? 2*s->poolCap : 1024 ;
+        s->pool = realloc(s->pool, s->poolCap*sizeof(int)) ;
+        if (!s->pool) {
+            fprintf(stderr, "solver out of memory\n") ;
+            exit(1) ;
+        }
+    }
+    const int cref = s->poolLen ;
+    s->pool[cref] = size ;
+    s->pool[cref + 1] = lbd ;
+    memcpy(s->pool + cref + CLAUSE_HEADER, lits, size*sizeof(int)) ;
+    s->poolLen = needed ;
+    attach(s, cref) ;
+    return cref ;
+}
+
+/* The heap of variables by activity */
+
+static void heapUp (Solver * s, int i)
+{
+    const int v = s->heap[i] ;
+    while (i > 0) {
+        const int parent = (i - 1)/2 ;
+        if (s->activity[s->heap[parent]] >= s->activity[v]) break ;
+        s->heap[i] = s->heap[parent] ;
+        s->heapIndex[s->heap[i]] = i ;
+        i = parent ;
+    }
+    s->heap[i] = v ;
+    s->heapIndex[v] = i ;
+}
+
+static void heapDown (Solver * s, int i)
+{
+    const int v = s->heap[i] ;
+    while (2*i + 1 < s->heapSize) {
+        int child = 2*i + 1 ;
+        if (child + 1 < s->heapSize && s->activity[s->heap[child + 1]] > s->activity[s->heap[child]]) child += 1 ;
+        if (s->activity[s->heap[child]] <= s->activity[v]) break ;
+        s->heap[i] = s->heap[child] ;
+        s->heapIndex[s->heap[i]] = i ;
+        i = child ;
+    }
+    s->heap[i] = v ;
+    s->heapIndex[v] = i ;
+}
+
+static void heapInsert (Solver * s, int v)
+{
+    if (s->heapIndex[v] >= 0) return ;
+    s->heap[s->heapSize] = v ;
+    s->heapIndex[v] = s->heapSize ;
+    s->heapSize += 1 ;
+    heapUp(s, s->heapSize - 1) ;
+}
+
+static int heapPop (Solver * s)
+{
+    const int v = s->heap[0] ;
+    s->heapIndex[v] = -1 ;
+    s->heapSize -= 1 ;
+    if (s->heapSize > 0) {
+        s->heap[0] = s->heap[s->heapSize] ;
+        heapDown(s, 0) ;
+    }
+    return v ;
+}
+
+static void bump (Solver * s, int v)
+{
+    s->activity[v] += s->varInc ;
+    if (s->activity[v] > 1e100) {
+        for (int u = 1 ; u <= s->vars ; u++) s->activity[u] *= 1e-100 ;
+        s->varInc *= 1e-100 ;
+    }
+    if (s->heapIndex[v] >= 0) heapUp(s, s->heapIndex[v]) ;
+}
+
+/* Assignment */
+
+static inline void enqueue (Solver * s, int lit, int from)
+{
+    const int v = abs(lit) ;
+    s->assigns[v] = lit > 0 ? 1 : -1 ;
+    s->level[v] = s->levels ;
+    s->reason[v] = from ;
+    s->trail[s->trailLen++] = lit ;
+}
+
+static inline void newLevel (Solver * s)
+{
+    s->trailLim[s->levels++] = s->trailLen ;
+}
+
+static void backtrack (Solver * s, int level)
+{
+    if (s->levels <= level) return ;
+    for (int i = s->trailLen - 1 ; i >= s->trailLim[level] ; i--) {
+        const int v = abs(s->trail[i]) ;
+        s->phase[v] = s->assigns[v] ;
+        s->assigns[v] = 0 ;
+        s->reason[v] = -1 ;
+        heapInsert(s, v) ;
+    }
+    s->trailLen = s->trailLim[level] ;
+    s->qhead = s->trailLen ;
+    s->levels = level ;
+}
+
+/*
+    Propagate every literal on the trail not propagated yet.
+    Returns: the clause found false, or -1
+*/
+static int propagate (Solver * s)
+{
+    while (s->qhead < s->trailLen) {
+        const int falseLit = -s->trail[s->qhead++] ;
+        s->propagations += 1 ;
+        watchList * w = &s->watches[litIndex(falseLit)] ;
+        watcher * items = w->items ;
+        int i = 0 ;
+        int j = 0 ;
+        while (i < w->count) {
+            const watcher x = items[i++] ;
+            if (value(s, x.blocker) == 1) {
+                items[j++] = x ;
+                continue ;
+            }
+            int * c = clauseLits(s, x.cref) ;
+            const int size = clauseSize(s, x.cref) ;
+            if (c[0] == falseLit) { // The false literal goes second
+                c[0] = c[1] ;
+                c[1] = falseLit ;
+            }
+            const int first = c[0] ;
+            if (first != x.blocker && value(s, first) == 1) {
+                items[j++] = (watcher) {x.cref, first} ;
+                continue ;
+            }
+
+            bool moved = false ;
+            for (int k = 2 ; k < size ; k++) {
+                if (value(s, c[k]) != -1) {
+                    c[1] = c[k] ;
+                    c[k] = falseLit ;
+                    watch(s, c[1], x.cref, first) ;
+                    moved = true ;
+                    break ;
+                }
+            }
+            if (moved) continue ;
+
+            items[j++] = (watcher) {x.cref, first} ;
+            if (value(s, first) == -1) {
+                while (i < w->count) items[j++] = items[i++] ;
+                w->count = j ;
+                s->qhead = s->trailLen ;
+                return x.cref ;
+            }
+            enqueue(s, first, x.cref) ;
+        }
+        w->count = j ;
+    }
+    return -1 ;
+}
+
+/*
+    First UIP learning from the false clause confl, into s->learnt with the asserting literal first
+    and a literal of the level to go back to second.
+    Returns: the clause's size, with the level to go back to in *back and its LBD in *lbd
+*/
+static int analyze (Solver * s, int confl, int * back, int * lbd)
+{
+    int size = 1 ;
+    int pathCount = 0 ;
+    int p = 0 ;
+    int index = s->trailLen - 1 ;
+    do {
+        const int * c = clauseLits(s, confl) ;
+        const int csize = clauseSize(s, confl) ;
+        for (int k = p == 0 ? 0 : 1 ; k < csize ; k++) {
+            const int q = c[k] ;
+            const int v = abs(q) ;
+            if (!s->seen[v] && s->level[v] > 0) {
+                bump(s, v) ;
+                s->seen[v] = 1 ;
+                if (s->level[v] >= s->levels) pathCount += 1 ;
+                else s->learnt[size++] = q ;
+            }
+        }
+        while (!s->seen[abs(s->trail[index--])]) ;
+        p = s->trail[index + 1] ;
+        confl = s->reason[abs(p)] ;
+        s->seen[abs(p)] = 0 ;
+        pathCount -= 1 ;
+    } while (pathCount > 0) ;
+    s->learnt[0] = -p ;
+
+    // Leave out every literal whose reason is made of the others
+    memcpy(s->toClear, s->learnt, size*sizeof(int)) ;
+    const int before = size ;
+    int j = 1 ;
+    for (int i = 1 ; i < size ; i++) {
+        const int v = abs(s->learnt[i]) ;
+        const int r = s->reason[v] ;
+        bool keep = r < 0 ;
+        if (!keep) {
+            const int * c = clauseLits(s, r) ;
+            const int csize = clauseSize(s, r) ;
+            for (int k = 1 ; k < csize && !keep ; k++) {
+                const int u = abs(c[k]) ;
+                keep = !s->seen[u] && s->level[u] > 0 ;
+            }
+        }
+        if (keep) s->learnt[j++] = s->learnt[i] ;
+    }
+    size = j ;
+    for (int i = 0 ; i < before ; i++) s->seen[abs(s->toClear[i])] = 0 ;
+
+    *back = 0 ;
+    if (size > 1) {
+        int best = 1 ;
+        for (int i = 2 ; i < size ; i++) {
+            if (s->level[abs(s->learnt[i])] > s->level[abs(s->learnt[best])]) best = i ;
+        }
+        const int t = s->learnt[1] ;
+        s->learnt[1] = s->learnt[best] ;
+        s->learnt[best] = t ;
+        *back = s->level[abs(s->learnt[1])] ;
+    }
+
+    s->stamp += 1 ;
+    *lbd = 0 ;
+    for (int i = 0 ; i < size ; i++) {
+        const int l = s->level[abs(s->learnt[i])] ;
+        if (s->levelStamp[l] != s->stamp) {
+            s->levelStamp[l] = s->stamp ;
+            *lbd += 1 ;
+        }
+    }
+    return size ;
+}
+
+// The i-th term (from 0) of the Luby sequence 1, 1, 2, 1, 1, 2, 4, ...
+static double luby (int i)
+{
+    int size = 1 ;
+    int seq = 0 ;
+    while (size < i + 1) {
+        seq += 1 ;
+        size = 2*size + 1 ;
+    }
+    while (size - 1 != i) {
+        size = (size - 1)/2 ;
+        seq -= 1 ;
+        i = i % size ;
+    }
+    double x = 1 ;
+    for (int k = 0 ; k < seq ; k++) x *= 2 ;
+    return x ;
+}
+
+// A learnt clause's place in the pool, with what it is judged by
+typedef struct learntKey {
+    int lbd ;
+    int size ;
+    int cref ;
+} learntKey ;
+
+static int compareKeys (const void * a, const void * b)
+{
+    const learntKey * x = a ;
+    const learntKey * y = b ;
+    if (x->lbd != y->lbd) return x->lbd < y->lbd ? -1 : 1 ;
+    if (x->size != y->size) return x->size < y->size ? -1 : 1 ;
+    return x->cref < y->cref ? -1 : x->cref > y->cref ;
+}
+
+static int compareRefs (const void * a, const void * b)
+{
+    const int x = *(const int *) a ;
+    const int y = *(const int *) b ;
+    return x < y ? -1 : x > y ;
+}
+
+/*
+    Keep the better half of the learnt clauses by LBD (and every one spanning two levels or fewer),
+    compacting the pool and watching every clause again. Only done at level 0, where no reason is
+    ever looked at, and the level 0 literals are propagated again to put the watches right.
+*/
+static void thinLearnts (Solver * s)
+{
+    // Choose the clauses to keep by LBD, then move them down the pool in pool order so none is overwritten
+    learntKey * keys = malloc((size_t) (s->learntCount + 1)*sizeof(learntKey)) ;
+    int * order = malloc((size_t) (s->learntCount + 1)*sizeof(int)) ;
+    if (!keys || !order) {
+        fprintf(stderr, "solver out of memory\n") ;
+        exit(1) ;
+    }
+    for (int i = 0 ; i < s->learntCount ; i++) {
+        const int cref = s->learnts[i] ;
+        keys[i] = (learntKey) {s->pool[cref + 1], s->pool[cref], cref} ;
+    }
+    qsort(keys, s->learntCount, sizeof(learntKey), compareKeys) ;
+    int kept = 0 ;
+    for (int i = 0 ; i < s->learntCount ; i++) {
+        if (i < s->learntCount/2 || keys[i].lbd <= 2) order[kept++] = keys[i].cref ;
+    }
+    free(keys) ;
+    qsort(order, kept, sizeof(int), compareRefs) ;
+    size_t at = s->originalEnd ;
+    for (int i = 0 ; i < kept ; i++) {
+        const size_t size = CLAUSE_HEADER + s->pool[order[i]] ;
+        memmove(s->pool + at, s->pool + order[i], size*sizeof(int)) ;
+        s->learnts[i] = at ;
+        at += size ;
+    }
+    free(order) ;
+    s->learntCount = kept ;
+    s->poolLen = at ;
+
+    for (int l = 2 ; l <= 2*s->vars + 1 ; l++) s->watches[l].count = 0 ;
+    for (size_t cref = 0 ; cref < s->poolLen ; cref += CLAUSE_HEADER + s->pool[cref]) attach(s, cref) ;
+    for (int i = 0 ; i < s->trailLen ; i++) s->reason[abs(s->trail[i])] = -1 ;
+    s->qhead = 0 ;
+    s->maxLearnts = s->maxLearnts*LEARNT_GROWTH ;
+}
+
+Solver * solver_new (const cnfFormula * f)
+{
+    Solver * s = calloc(1, sizeof(Solver)) ;
+    const int n = f->vars ;
+    s->vars = n ;
+    s->watches = calloc(2*n + 2, sizeof(watchList)) ;
+    s->assigns = calloc(n + 1, 1) ;
+    s->phase = malloc(n + 1) ;
+    s->level = calloc(n + 1, sizeof(int)) ;
+    s->reason = malloc((n + 1)*sizeof(int)) ;
+    s->seen = calloc(n + 1, 1) ;
+    s->activity = calloc(n + 1, sizeof(double)) ;
+    s->heap = malloc((n + 1)*sizeof(int)) ;
+    s->heapIndex = malloc((n + 1)*sizeof(int)) ;
+    s->trail = malloc((n + 1)*sizeof(int)) ;
+    s->trailLim = malloc((n + 1)*sizeof(int)) ;
+    s->learnt = malloc((n + 1)*sizeof(int)) ;
+    s->toClear = malloc((n + 1)*sizeof(int)) ;
+    s->levelStamp = calloc(n + 1, sizeof(int)) ;
+    s->levelCap = n + 1 ;
+    if (!s->watches || !s->assigns || !s->phase || !s->level || !s->reason || !s->seen || !s->activity || !s->heap
+        || !s->heapIndex || !s->trail || !s->trailLim || !s->learnt || !s->toClear || !s->levelStamp) {
+        fprintf(stderr, "solver_new failed\n") ;
+        exit(1) ;
+    }
+    s->varInc = 1 ;
+    for (int v = 0 ; v <= n ; v++) {
+        s->phase[v] = -1 ;
+        s->reason[v] = -1 ;
+        s->heapIndex[v] = -1 ;
+    }
+    for (int v = 1 ; v <= n ; v++) heapInsert(s, v) ;
+
+    // Each clause without repeated literals, and leaving out tautologies
+    signed char * mark = calloc(n + 1, 1) ;
+    int * lits = malloc((n + 1)*sizeof(int)) ;
+    for (int i = 0 ; i < f->clauses && !s->unsat ; i++) {
+        int size = 0 ;
+        bool tautology = false ;
+        for (size_t k = f->offsets[i] ; k < f->offsets[i + 1] ; k++) {
+            const int lit = f->lits[k] ;
+            const signed char sign = lit > 0 ? 1 : -1 ;
+            if (mark[abs(lit)] == -sign) tautology = true ;
+            if (mark[abs(lit)] == 0) {
+                mark[abs(lit)] = sign ;
+                lits[size++] = lit ;
+            }
+        }
+        for (int k = 0 ; k < size ; k++) mark[abs(lits[k])] = 0 ;
+        if (tautology) continue ;
+        if (size == 0) {
+            s->unsat = true ;
+        } else if (size == 1) {
+            if (value(s, lits[0]) == -1) s->unsat = true ;
+            else if (value(s, lits[0]) == 0) enqueue(s, lits[0], -1) ;
+        } else {
+            addClause(s, lits, size, 0) ;
+        }
+    }
+    free(mark) ;
+    free(lits) ;
+    s->originalEnd = s->poolLen ;
+    s->maxLearnts = f->clauses/3 > MIN_LEARNTS ? f->clauses/3 : MIN_LEARNTS ;
+    if (!s->unsat && propagate(s) >= 0) s->unsat = true ;
+    return s ;
+}
+
+bool solver_solve (Solver * s, const int * assumptions, int count)
+{
+    if (s->unsat) return false ;
+    backtrack(s, 0) ;
+    if (s->vars + count + 1 > s->levelCap) { // An assumption that is already true still takes a level
+        const int cap = s->vars + count + 1 ;
+        s->trailLim = realloc(s->trailLim, cap*sizeof(int)) ;
+        s->levelStamp = realloc(s->levelStamp, cap*sizeof(int)) ;
+        if (!s->trailLim || !s->levelStamp) {
+            fprintf(stderr, "solver out of memory\n") ;
+            exit(1) ;
+        }
+        memset(s->levelStamp + s->levelCap, 0, (cap - s->levelCap)*sizeof(int)) ;
+        s->levelCap = cap ;
+    }
+    int restarts = 0 ;
+    long limit = RESTART_UNIT*luby(restarts) ;
+    long sinceRestart = 0 ;
+    while (true) {
+        const int confl = propagate(s) ;
+        if (confl >= 0) {
+            s->conflicts += 1 ;
+            sinceRestart += 1 ;
+            if (s->levels == 0) {
+                s->unsat = true ;
+                return false ;
+            }
+            int back ;
+            int lbd ;
+            const int size = analyze(s, confl, &back, &lbd) ;
+            backtrack(s, back) ;
+            if (size == 1) {
+                enqueue(s, s->learnt[0], -1) ;
+            } else {
+                const int cref = addClause(s, s->learnt, size, lbd) ;
+                if (s->learntCount == s->learntCap) s->learnts = grow(s->learnts, &s->learntCap, sizeof(int)) ;
+                s->learnts[s->learntCount++] = cref ;
+                enqueue(s, s->learnt[0], cref) ;
+            }
+            s->varInc /= VAR_DECAY ;
+            continue ;
+        }
+
+        if (sinceRestart >= limit) {
+            backtrack(s, 0) ;
+            restarts += 1 ;
+            limit = RESTART_UNIT*luby(restarts) ;
+            sinceRestart = 0 ;
+            if (s->learntCount >= s->maxLearnts) thinLearnts(s) ;
+            continue ;
+        }
+
+        if (s->levels < count) { // The assumptions are the first decisions
+            const int p = assumptions[s->levels] ;
+            if (value(s, p) == -1) {
+                backtrack(s, 0) ;
+                return false ;
+            }
+            newLevel(s) ;
+            if (value(s, p) == 0) enqueue(s, p, -1) ;
+            continue ;
+        }
+
+        int v = 0 ;
+        while (s->heapSize > 0 && v == 0) {
+            const int u = heapPop(s) ;
+            if (s->assigns[u] == 0) v = u ;
+        }
+        if (v == 0) {
+            backtrack(s, 0) ;
+            return true ;
+        }
+        newLevel(s) ;
+        enqueue(s, s->phase[v] > 0 ? v : -v, -1) ;
+    }
+}
+
+/* Accessors */
+long solver_propagations (const Solver * solver) { return solver->propagations ; }
+long solver_conflicts (const Solver * solver) { return solver->conflicts ; }
+
+void solver_free (Solver * s)
+{
+    if (!s) return ;
+    for (int l = 0 ; l <= 2*s->vars + 1 ; l++) free(s->watches[l].items) ;
+    free(s->watches) ;
+    free(s->pool) ;
+    free(s->learnts) ;
+    free(s->assigns) ;
+    free(s->phase) ;
+    free(s->level) ;
+    free(s->reason) ;
+    free(s->seen) ;
+    free(s->activity) ;
+    free(s->heap) ;
+    free(s->heapIndex) ;
+    free(s->trail) ;
+    free(s->trailLim) ;
+    free(s->learnt) ;
+    free(s->toClear) ;
+    free(s->levelStamp) ;
+    free(s) ;
+}
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <stdbool.h>
+
+#include "formula.h"
+
+/*
+A small CDCL SAT solver, for answering the inference questions of the phase transition analysis
+(see Experimental/phaseTransition.py) in process, on formulae from formula.h. It is the usual
+design of MiniSat and its descendants: two watched literals for propagation, first UIP learning
+with the clause minimized against the reasons of its literals, VSIDS branching with saved phases,
+Luby restarts, and the learnt clauses thinned out by their LBD (the number of decision levels they
+span, as in Glucose) when there get to be too many.
+
+A solver is loaded with a formula once and then asked any number of questions under assumptions,
+keeping what it learns from one to the next, the same way phaseTransition.py uses Glucose: a cell
+of a board is inferred when the formula with the cell assumed empty has no solution.
+*/
+
+typedef struct Solver Solver ;
+
+// Load the formula f (which the solver copies, so f can go once this returns). Returns: Solver*
+Solver * solver_new (const cnfFormula * f) ;
+
+/*
+    Decide the formula with the count literals assumptions assumed true.
+    Returns: whether it has a solution that makes them all true
+*/
+bool solver_solve (Solver * solver, const int * assumptions, int count) ;
+
+// Literals propagated and conflicts met over every call so far (Glucose's accum_stats)
+long solver_propagations (const Solver * solver) ;
+long solver_conflicts (const Solver * solver) ;
+
+void solver_free (Solver * solver) ;
@@ -0,0 +1,100 @@
+#include "stats.h"
+#include "trace.h"
+
+#if defined(STATS) || defined(TRACE)
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+
+#define STATS_COUNTERS 32
+
+static const char * stageNames[STAGE_COUNT] = {
+    "generate", "describe", "presolve", "automaton", "constraint", "format", "write", "board"
+} ;
+
+uint64_t stats_now (void)
+{
+    struct timespec t ;
+    clock_gettime(CLOCK_MONOTONIC, &t) ;
+    return (uint64_t) t.tv_sec*1000000000u + t.tv_nsec ;
+}
+
+#ifdef STATS
+_Thread_local StageStats stats_local[STAGE_COUNT] ;
+#endif
+
+void stats_stop (uint64_t start, stage s)
+{
+#ifdef STATS
+    stats_local[s].calls += 1 ;
+    stats_local[s].nanoseconds += stats_now() - start ;
+#endif
+#ifdef TRACE
+    trace_span(stageNames[s], start, -1) ;
+#endif
+}
+
+#endif
+
+#ifdef STATS
+
+static StageStats totals[STAGE_COUNT] ;
+static const char * counterNames[STATS_COUNTERS] ;
+static long counterValues[STATS_COUNTERS] ;
+static int counterCount = 0 ;
+static pthread_mutex_t lock = PTHREAD_MUTEX_INITIALIZER ;
+
+void stats_merge (void)
+{
+    pthread_mutex_lock(&lock) ;
+    for (int s = 0 ; s < STAGE_COUNT ; s++) {
+        totals[s].calls += stats_local[s].calls ;
+        totals[s].nanoseconds += stats_local[s].nanoseconds ;
+        totals[s].bytes += stats_local[s].bytes ;
+        totals[s].clauses += stats_local[s].clauses ;
+        totals[s].variables += stats_local[s].variables ;
+    }
+    memset(stats_local, 0, sizeof stats_local) ;
+    pthread_mutex_unlock(&lock) ;
+}
+
+void stats_counter (const char * name, long value)
+{
+    pthread_mutex_lock(&lock) ;
+    int i = 0 ;
+    while (i < counterCount && strcmp(counterNames[i], name) != 0) i++ ;
+    if (i == counterCount && counterCount < STATS_COUNTERS) {
+        counterNames[counterCount] = name ;
+        counterValues[counterCount++] = 0 ;
+    }
+    if (i < counterCount) counterValues[i] += value ;
+    pthread_mutex_unlock(&lock) ;
+}
+
+int stats_write (const char * path)
+{
+    FILE * fp = fopen(path, "w") ;
+    if (!fp) {
+        perror(path) ;
+        return 1 ;
+    }
+    pthread_mutex_lock(&lock) ;
+    fprintf(fp, "{\n  \"stages\": {\n") ;
+    for (int s = 0 ; s < STAGE_COUNT ; s++) {
+        fprintf(fp, "    \"%s\": {\"calls\": %llu, \"nanoseconds\": %llu, \"bytes\": %llu, \"clauses\": %llu, \"variables\": %llu}%s\n",
+                stageNames[s], (unsigned long long) totals[s].calls, (unsigned long long) totals[s].nanoseconds,
+                (unsigned long long) totals[s].bytes, (unsigned long long) totals[s].clauses,
+                (unsigned long long) totals[s].variables, s + 1 < STAGE_COUNT ? "," : "") ;
+    }
+    fprintf(fp, "  },\n  \"counters\": {") ;
+    for (int i = 0 ; i < counterCount ; i++) {
+        fprintf(fp, "%s\n    \"%s\": %ld", i > 0 ? "," : "", counterNames[i], counterValues[i]) ;
+    }
+    fprintf(fp, "%s}\n}\n", counterCount > 0 ? "\n  " : "") ;
+    pthread_mutex_unlock(&lock) ;
+    return fclose(fp) != 0 ;
+}
+
+#endif
@@ -0,0 +1,104 @@
+#pragma once
+
+#include <stdint.h>
+
+/*
+Counters and timers for the stages of encoding a board, for seeing where a sweep's time goes.
+They are only compiled in when the programs are built with -DSTATS. Otherwise every macro below
+is empty and stats.c compiles to nothing, so an ordinary build pays nothing for them.
+
+Each stage has its calls, the nanoseconds spent in them, and the bytes, clauses and variables they
+produced (whichever apply). The stages are:
+
+    generate --> filling a board at random (or reading a scraped puzzle)
+    describe --> working out the row and column descriptions of a board (or parsing a scraped puzzle's)
+    presolve --> solving the lines of a board before encoding it (see linesolve.h)
+    automaton --> building the automaton of a line (or the DNF fillings of dnfToCNF.c)
+    constraint --> building a line formula from its automaton (or converting the fillings to CNF)
+    format --> writing the clauses of a line from a template (see linecache.h), or the lines already
+               encoded of dnfToCNF.c, into a sink's buffer
+    write --> writing formulae to their files or archive
+    board --> encoding a whole board, which includes the stages above other than generate, with the
+              clauses and variables of its formula
+
+Each thread adds to its own counters, which go into the run's totals when it calls stats_merge
+(every worker as it finishes, and the main thread before stats_write), so counting is never
+contended. The totals, and any named counters (such as the line cache's hits), are written as JSON.
+
+Built with -DTRACE, each stage timed is also a span of the timeline of trace.h, whether or not
+STATS is defined.
+*/
+
+typedef enum stage {
+    STAGE_GENERATE,
+    STAGE_DESCRIBE,
+    STAGE_PRESOLVE,
+    STAGE_AUTOMATON,
+    STAGE_CONSTRAINT,
+    STAGE_FORMAT,
+    STAGE_WRITE,
+    STAGE_BOARD,
+    STAGE_COUNT
+} stage ;
+
+typedef struct StageStats {
+    uint64_t calls ;
+    uint64_t nanoseconds ;
+    uint64_t bytes ;
+    uint64_t clauses ;
+    uint64_t variables ;
+} StageStats ;
+
+#if defined(STATS) || defined(TRACE)
+
+// The monotonic clock in nanoseconds
+uint64_t stats_now (void) ;
+
+// Count a call of stage s that started at start, and record it as a span if tracing
+void stats_stop (uint64_t start, stage s) ;
+
+#define STATS_START(t) const uint64_t t = stats_now()
+#define STATS_STOP(t, s) stats_stop(t, s)
+
+#else
+
+#define STATS_START(t)
+#define STATS_STOP(t, s) ((void) 0)
+
+#endif
+
+#ifdef STATS
+
+extern _Thread_local StageStats stats_local[STAGE_COUNT] ;
+
+// Add the calling thread's counters to the totals, and zero them
+void stats_merge (void) ;
+
+// Add value to the named counter (the name must outlive the run, e.g. a string literal)
+void stats_counter (const char * name, long value) ;
+
+// Write the totals and named counters to path as JSON. Returns: 0, or 1 if the file could not be written
+int stats_write (const char * path) ;
+
+/*
+    STATS_START(t) starts the timer t, and STATS_STOP(t,s) counts a call of stage s taking the time
+    since. STATS_ADD(s,field,n) adds n to a counter of stage s, and STATS_LET(name,value) keeps a
+    value (such as a count before a stage) for one. Each is a statement, and none of them is
+    evaluated unless STATS is defined.
+*/
+
+#define STATS_LET(name, value) const int64_t name = (value)
+#define STATS_ADD(s, field, n) (stats_local[s].field += (uint64_t) (n))
+#define STATS_COUNTER(name, value) stats_counter(name, value)
+#define STATS_MERGE() stats_merge()
+#define STATS_WRITE(path) stats_write(path)
+
+#else
+
+#define STATS_LET(name, value) const int64_t name = 0 ; (void) name
+#define STATS_ADD(s, field, n) ((void) sizeof (n)) // Not evaluated, but whatever n uses is not left unused
+#define STATS_COUNTER(name, value) ((void) 0)
+#define STATS_MERGE() ((void) 0)
+#define STATS_WRITE(path) ((void) 0)
+
+#endif
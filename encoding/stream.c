@@ -0,0 +1,179 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <limits.h>
+
+#include "stream.h"
+#include "linesolve.h"
+#include "cardinality.h"
+#include "stats.h"
+#include "trace.h"
+
+/*
+    Write the packed clauses t (over the l cells of line i from cell `start` on, numbered 1..l, and
+    the fresh variables l+1..l+fresh) with their 64-bit variables: the cells their board variables,
+    and the fresh variables base, base+1, ...
+*/
+static void writeLine (const int * t, size_t size, int i, int start, int length, int fresh, int64_t base, int height, int width, ClauseSink * out, Arena * scratch)
+{
+    STATS_START(formatStart) ;
+    ArenaMark mark = arena_mark(scratch) ;
+    int64_t * label = arena_alloc(scratch, (length + fresh + 1)*sizeof(int64_t)) ;
+    for (int j = 0 ; j < length ; j++) {
+        const int64_t k = start + j ;
+        label[j + 1] = i < height ? (int64_t) i*width + k + 1 : k*width + (i - height) + 1 ;
+    }
+    for (int k = 1 ; k <= fresh ; k++) {
+        label[length + k] = base + k - 1 ;
+    }
+    sink_labelled(out, t, size, label) ;
+    STATS_STOP(formatStart, STAGE_FORMAT) ;
+    arena_release(scratch, mark) ;
+}
+
+int64_t stream_board (const description * rows, const description * columns, int height, int width, const signed char * cells, int cardinality, LineCache * cache, ClauseSink * out, int64_t * clauses, Arena * scratch)
+{
+    const int64_t cellCount = (int64_t) height*width ;
+    const int lines = height + width ;
+    lineSegment * segments = arena_alloc(scratch, lines*sizeof(lineSegment)) ;
+    for (int i = 0 ; i < lines ; i++) {
+        const description * d = i < height ? &rows[i] : &columns[i - height] ;
+        const int length = i < height ? width : height ;
+        if (cells == NULL) {
+            segments[i] = (lineSegment) {0, length, *d} ;
+        } else {
+            segments[i] = i < height ? linesolve_segment(d, cells + (int64_t) i*width, 1, length)
+                                     : linesolve_segment(d, cells + (i - height), width, length) ;
+        }
+    }
+
+    // The counts, so the header can go first
+    int64_t vars = cellCount ;
+    int64_t total = 0 ;
+    int64_t open = cellCount ; // cells left unsettled, and how many of them are filled
+    int64_t filled = 0 ;
+    for (int i = 0 ; i < height ; i++) {
+        filled += rows[i].total ;
+    }
+    if (cells != NULL) {
+        for (int64_t k = 0 ; k < cellCount ; k++) {
+            if (cells[k] != CELL_UNKNOWN) {
+                total += 1 ;
+                open -= 1 ;
+                filled -= cells[k] == CELL_FILLED ;
+            }
+        }
+    }
+    for (int i = 0 ; i < lines ; i++) {
+        const lineSegment * g = &segments[i] ;
+        if (g->length == 0) continue ;
+        if (g->rest.length == 0) {
+            total += g->length ;
+            continue ;
+        }
+        int fresh ;
+        total += linecache_counts(cache, &g->rest, g->length, &fresh, scratch) ;
+        vars += fresh ;
+        if (cardinality & CARDINALITY_LINES) {
+            int64_t cardinalityFresh ;
+            total += cardinality_counts(g->length, g->rest.total, &cardinalityFresh) ;
+            vars += cardinalityFresh ;
+        }
+    }
+    int64_t boardFresh = 0 ;
+    if (cardinality & CARDINALITY_BOARD) {
+        // The board constraint is built over its own int numbering, the open cells and then its outputs
+        if (open >= INT_MAX) {
+            fprintf(stderr, "stream_board: %lld open cells are too many for a board cardinality constraint\n", (long long) open) ;
+            exit(1) ;
+        }
+        total += cardinality_counts((int) open, (int) filled, &boardFresh) ;
+        vars += boardFresh ;
+        if (open + boardFresh >= INT_MAX) {
+            fprintf(stderr, "stream_board: the board cardinality constraint of %lld cells has too many variables\n", (long long) open) ;
+            exit(1) ;
+        }
+    }
+    sink_header(out, vars, total) ;
+
+    // The settled cells come first
+    const int unit[2] = {1, 1} ;
+    const int negated[2] = {1, -1} ;
+    if (cells != NULL) {
+        for (int64_t k = 0 ; k < cellCount ; k++) {
+            if (cells[k] == CELL_UNKNOWN) continue ;
+            const int64_t label[2] = {0, k + 1} ;
+            sink_labelled(out, cells[k] == CELL_FILLED ? unit : negated, 2, label) ;
+        }
+    }
+
+    // Then each line, from its template
+    int64_t base = cellCount + 1 ;
+    for (int i = 0 ; i < lines ; i++) {
+        const lineSegment * g = &segments[i] ;
+        if (g->length == 0) continue ;
+        TRACE_START(writing) ;
+        if (g->rest.length == 0) { // An empty line is a singleton clause for each cell
+            ArenaMark mark = arena_mark(scratch) ;
+            int * t = arena_ints(scratch, 2*g->length) ;
+            for (int j = 0 ; j < g->length ; j++) {
+                t[2*j] = 1 ;
+                t[2*j + 1] = -(j + 1) ;
+            }
+            writeLine(t, 2*g->length, i, g->start, g->length, 0, base, height, width, out, scratch) ;
+            arena_release(scratch, mark) ;
+            TRACE_LINE(writing, i) ;
+            continue ;
+        }
+        size_t size ;
+        int lineClauses, fresh ;
+        const int * t = linecache_template(cache, &g->rest, g->length, &size, &lineClauses, &fresh, scratch) ;
+        writeLine(t, size, i, g->start, g->length, fresh, base, height, width, out, scratch) ;
+        base += fresh ;
+        TRACE_LINE(writing, i) ;
+    }
+
+    // And the cardinality constraints, each built over its own numbering and relabelled the same way
+    if (cardinality & CARDINALITY_LINES) {
+        ClauseSink * record = sink_record() ;
+        ArenaMark mark = arena_mark(scratch) ;
+        for (int i = 0 ; i < lines ; i++) {
+            const lineSegment * g = &segments[i] ;
+            if (g->length == 0 || g->rest.length == 0) continue ;
+            int * lits = arena_ints(scratch, g->length) ;
+            for (int j = 0 ; j < g->length ; j++) lits[j] = j + 1 ;
+            int next = g->length + 1 ;
+            sink_reset(record) ;
+            cardinality_exactly(lits, g->length, g->rest.total, &next, record, scratch) ;
+            const int fresh = next - g->length - 1 ;
+            writeLine((const int *) sink_data(record), sink_size(record)/sizeof(int), i, g->start, g->length, fresh, base, height, width, out, scratch) ;
+            base += fresh ;
+            arena_release(scratch, mark) ;
+        }
+        sink_free(record) ;
+    }
+
+    // The board constraint has O(open*filled) clauses, so they are relabelled a buffer at a time as
+    // the totalizer writes them rather than recorded whole (its fresh variables are known from the counts)
+    if ((cardinality & CARDINALITY_BOARD) && open > 0) {
+        ArenaMark mark = arena_mark(scratch) ;
+        int * lits = arena_ints(scratch, open) ;
+        int64_t * label = arena_alloc(scratch, (open + boardFresh + 1)*sizeof(int64_t)) ;
+        int n = 0 ;
+        for (int64_t k = 0 ; k < cellCount ; k++) {
+            if (cells == NULL || cells[k] == CELL_UNKNOWN) {
+                lits[n] = n + 1 ;
+                label[++n] = k + 1 ;
+            }
+        }
+        for (int64_t k = 1 ; k <= boardFresh ; k++) label[n + k] = base + k - 1 ;
+        ClauseSink * relabel = sink_relabel(out, label) ;
+        int next = n + 1 ;
+        cardinality_exactly(lits, n, filled, &next, relabel, scratch) ;
+        sink_free(relabel) ;
+        base += boardFresh ;
+        arena_release(scratch, mark) ;
+    }
+
+    *clauses = total ;
+    return vars ;
+}
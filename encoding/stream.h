@@ -0,0 +1,35 @@
+#pragma once
+
+#include <stdint.h>
+
+#include "nonogram.h"
+#include "linecache.h"
+#include "sink.h"
+
+/*
+Streaming encodes a board with 64-bit variable and clause counts, for boards too large for the
+int counts of the in-memory encoders (the variables of a 1000x1000 board already overflow them).
+The counts are worked out first, from the line encodings' own counts or the line cache, so the
+header can be written before any clause. Each line is then written from its template in the line
+cache (see linecache.h), with the template's variables relabelled to their 64-bit numbers as the
+clauses are formatted, so there is never more than one line formula in memory. With a sink that
+flushes to a file, the formula goes to the file a line at a time, and the memory used beyond the
+board's descriptions is that of its largest line. A board cardinality constraint counts every
+cell at once, so it adds a 64-bit label for each of its variables, but its clauses (of which
+there can be more than an int holds) are relabelled and written a buffer at a time as they are
+built (see sink_relabel).
+
+The formula is exactly the one regExEncoding writes for the same board and options, clause for
+clause, whenever that one fits in an int.
+*/
+
+/*
+    Write the formula of the board with the height row descriptions rows and the width column
+    descriptions columns to out, with each line written from cache. If cells is not NULL, it is the
+    board's cells as settled by linesolve_board (row-major): the settled cells are written first as
+    singleton clauses, and each line only encodes what is left between its settled ends. Then come
+    the cardinality constraints asked for (CARDINALITY_LINES and/or CARDINALITY_BOARD, see
+    cardinality.h). All scratch memory is taken from (and given back to) scratch.
+    Returns: the number of variables, with the number of clauses in *clauses
+*/
+int64_t stream_board (const description * rows, const description * columns, int height, int width, const signed char * cells, int cardinality, LineCache * cache, ClauseSink * out, int64_t * clauses, Arena * scratch) ;
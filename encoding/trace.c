@@ -0,0 +1,198 @@
+#include "trace.h"
+
+#ifdef TRACE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include <time.h>
+
+typedef struct TraceEvent {
+    const char * name ;
+    uint64_t start ;
+    uint64_t end ;
+    int32_t density ;   // -1 for none, as are board and line
+    int32_t board ;
+    int32_t line ;
+} TraceEvent ;
+
+// One thread's spans not yet written. Only its thread writes to it, and the exit handler reads what is left once the threads are done
+typedef struct TraceBuffer {
+    TraceEvent events[TRACE_EVENTS] ;
+    atomic_uint_fast64_t count ;        // the spans in events
+    int tid ;
+    const char * name ;
+    int density ;                       // the board the thread is on
+    int board ;
+    struct TraceBuffer * next ;         // in the list of every thread's buffer
+} TraceBuffer ;
+
+static _Atomic(TraceBuffer *) buffers = NULL ;
+static atomic_int nextTid = 1 ;
+static _Thread_local TraceBuffer * local = NULL ;
+static const char * tracePath = NULL ;
+static FILE * traceFile = NULL ;        // open from trace_open until the exit handler
+static const char * separator = "" ;    // before the next event written to traceFile
+static uint64_t dropped = 0 ;           // spans of full buffers with no file to go to
+static pthread_mutex_t lock = PTHREAD_MUTEX_INITIALIZER ; // for traceFile, separator and dropped
+static uint64_t origin = 0 ;
+
+uint64_t trace_now (void)
+{
+    struct timespec t ;
+    clock_gettime(CLOCK_MONOTONIC, &t) ;
+    return (uint64_t) t.tv_sec*1000000000u + t.tv_nsec ;
+}
+
+// The calling thread's buffer, made the first time it records anything and kept until exit
+static TraceBuffer * localBuffer (void)
+{
+    if (local) return local ;
+    TraceBuffer * b = malloc(sizeof(TraceBuffer)) ;
+    if (!b) {
+        fprintf(stderr, "trace buffer allocation failed\n") ;
+        exit(1) ;
+    }
+    atomic_init(&b->count, 0) ;
+    b->tid = atomic_fetch_add(&nextTid, 1) ;
+    b->name = NULL ;
+    b->density = -1 ;
+    b->board = -1 ;
+    b->next = atomic_load(&buffers) ;
+    while (!atomic_compare_exchange_weak(&buffers, &b->next, b)) ;
+    local = b ;
+    return b ;
+}
+
+// Microseconds since the trace was opened, which is what the format's timestamps are in
+static double micros (uint64_t t)
+{
+    return t > origin ? (t - origin)/1000.0 : 0.0 ;
+}
+
+// Write the count spans of b to the file (with the lock held)
+static void writeEvents (const TraceBuffer * b, uint64_t count)
+{
+    for (uint64_t i = 0 ; i < count ; i++) {
+        const TraceEvent * e = &b->events[i] ;
+        fprintf(traceFile, "%s\n{\"name\": \"%s\", \"ph\": \"X\", \"pid\": 1, \"tid\": %d, \"ts\": %.3f, \"dur\": %.3f, \"args\": {",
+                separator, e->name, b->tid, micros(e->start), (e->end - e->start)/1000.0) ;
+        const char * comma = "" ;
+        if (e->density >= 0) {
+            fprintf(traceFile, "\"density\": %d", e->density) ;
+            comma = ", " ;
+        }
+        if (e->board >= 0) {
+            fprintf(traceFile, "%s\"board\": %d", comma, e->board) ;
+            comma = ", " ;
+        }
+        if (e->line >= 0) {
+            fprintf(traceFile, "%s\"line\": %d", comma, e->line) ;
+        }
+        fprintf(traceFile, "}}") ;
+        separator = "," ;
+    }
+}
+
+/*
+    Empty the full buffer b into the file, which is the only time a thread waits on another while
+    tracing (once every TRACE_EVENTS spans). The time it takes is recorded as a span of its own.
+*/
+static void flushBuffer (TraceBuffer * b)
+{
+    const uint64_t start = trace_now() ;
+    pthread_mutex_lock(&lock) ;
+    if (traceFile) {
+        writeEvents(b, TRACE_EVENTS) ;
+    } else {
+        dropped += TRACE_EVENTS ;
+    }
+    pthread_mutex_unlock(&lock) ;
+    TraceEvent * e = &b->events[0] ;
+    e->name = "trace flush" ;
+    e->start = start ;
+    e->end = trace_now() ;
+    e->density = -1 ;
+    e->board = -1 ;
+    e->line = -1 ;
+    atomic_store_explicit(&b->count, 1, memory_order_release) ;
+}
+
+static void record (const char * name, uint64_t start, int density, int board, int line)
+{
+    TraceBuffer * b = localBuffer() ;
+    const uint64_t count = atomic_load_explicit(&b->count, memory_order_relaxed) ;
+    TraceEvent * e = &b->events[count] ;
+    e->name = name ;
+    e->start = start ;
+    e->end = trace_now() ;
+    e->density = density ;
+    e->board = board ;
+    e->line = line ;
+    atomic_store_explicit(&b->count, count + 1, memory_order_release) ;
+    if (count + 1 == TRACE_EVENTS) flushBuffer(b) ;
+}
+
+void trace_thread (const char * name)
+{
+    localBuffer()->name = name ;
+}
+
+void trace_board (int density, int board)
+{
+    TraceBuffer * b = localBuffer() ;
+    b->density = density ;
+    b->board = board ;
+}
+
+void trace_span (const char * name, uint64_t start, int line)
+{
+    TraceBuffer * b = localBuffer() ;
+    record(name, start, b->density, b->board, line) ;
+}
+
+void trace_wait (const char * name, uint64_t start)
+{
+    record(name, start, -1, -1, -1) ;
+}
+
+// At exit: what is left in every buffer, the threads' names, and the end of the JSON
+static void traceFinish (void)
+{
+    pthread_mutex_lock(&lock) ;
+    if (traceFile) {
+        for (TraceBuffer * b = atomic_load(&buffers) ; b ; b = b->next) {
+            if (b->name) {
+                fprintf(traceFile, "%s\n{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": %d, \"args\": {\"name\": \"%s\"}}",
+                        separator, b->tid, b->name) ;
+                separator = "," ;
+            }
+            writeEvents(b, atomic_load_explicit(&b->count, memory_order_acquire)) ;
+        }
+        fprintf(traceFile, "\n], \"displayTimeUnit\": \"ms\", \"otherData\": {\"dropped\": %llu}}\n", (unsigned long long) dropped) ;
+        if (fclose(traceFile) != 0) {
+            perror(tracePath) ;
+        }
+        traceFile = NULL ;
+    }
+    if (dropped > 0) {
+        fprintf(stderr, "trace: %llu spans were dropped\n", (unsigned long long) dropped) ;
+    }
+    pthread_mutex_unlock(&lock) ;
+}
+
+void trace_open (const char * path)
+{
+    tracePath = path ;
+    origin = trace_now() ;
+    traceFile = fopen(path, "w") ;
+    if (!traceFile) {
+        perror(path) ; // The spans are still recorded, but a full buffer's are dropped
+    } else {
+        fprintf(traceFile, "{\"traceEvents\": [") ;
+    }
+    atexit(traceFinish) ;
+}
+
+#endif
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <stdint.h>
+
+/*
+A timeline of a run in the Chrome trace event format, which chrome://tracing and Perfetto
+(ui.perfetto.dev) open, for finding what the totals of stats.h hide: a board that takes far longer
+than the rest, a thread left idle, or a stage waiting on a queue. It is only compiled in when the
+programs are built with -DTRACE, and otherwise every macro below is empty.
+
+Each thread records spans, a name with the times it started and ended, into its own buffer, so
+recording takes no lock and only waits on another thread when the buffer is full and written out.
+The spans are:
+
+    the stages of stats.h (generate, describe, ..., board), wherever they are timed, so building
+    with -DTRACE alone traces them without counting them
+    line --> writing one line of a board's formula, with the line's index (the rows, then the
+             columns)
+    commit wait --> a worker waiting for the boards before its own to go into the archive
+    queue full, queue empty --> a pipeline stage waiting to push to or pop from a queue (see queue.h)
+    generate, encode, solve --> the stages of Experimental/pipeline.c
+    trace flush --> a thread writing its full buffer to the file
+
+Every span but the queue waits carries the density index and board the thread last said it was on
+(TRACE_BOARD). trace_open opens the file, and a buffer of TRACE_EVENTS spans that fills up is
+written to it as JSON (under a lock, as the threads share the file) and emptied, so no span is
+lost however long the run. What is left in the buffers is written when the program exits, by a
+handler trace_open registers. Only if the file cannot be opened are the spans of full buffers
+dropped, and then their number is written to stderr at exit.
+*/
+
+#ifndef TRACE_EVENTS
+#define TRACE_EVENTS (1 << 16)
+#endif
+
+#ifdef TRACE
+
+// The monotonic clock in nanoseconds (the same one as stats_now)
+uint64_t trace_now (void) ;
+
+// Start the timeline, which is written to path when the program exits
+void trace_open (const char * path) ;
+
+// Name the calling thread in the timeline (the name must outlive the run, e.g. a string literal)
+void trace_thread (const char * name) ;
+
+// Say which board the calling thread is on, for the spans it records after (-1 for none)
+void trace_board (int density, int board) ;
+
+// Record a span of the calling thread from start until now, on line (or -1 if it is not a line's)
+void trace_span (const char * name, uint64_t start, int line) ;
+
+// Record a span of the calling thread waiting from start until now, which is not for any board
+void trace_wait (const char * name, uint64_t start) ;
+
+/*
+    TRACE_START(t) starts the timer t, and TRACE_SPAN(t,name), TRACE_LINE(t,line) and
+    TRACE_WAIT(t,name) record a span, a line's span and a wait since it. Each is a statement.
+*/
+
+#define TRACE_OPEN(path) trace_open(path)
+#define TRACE_THREAD(name) trace_thread(name)
+#define TRACE_BOARD(density, board) trace_board(density, board)
+#define TRACE_START(t) const uint64_t t = trace_now()
+#define TRACE_SPAN(t, name) trace_span(name, t, -1)
+#define TRACE_LINE(t, line) trace_span("line", t, line)
+#define TRACE_WAIT(t, name) trace_wait(name, t)
+
+#else
+
+#define TRACE_OPEN(path) ((void) 0)
+#define TRACE_THREAD(name) ((void) 0)
+#define TRACE_BOARD(density, board) ((void) 0)
+#define TRACE_START(t)
+#define TRACE_SPAN(t, name) ((void) 0)
+#define TRACE_LINE(t, line) ((void) 0)
+#define TRACE_WAIT(t, name) ((void) 0)
+
+#endif